@@ -13,6 +13,7 @@
 
 #include <ecs/Component.h>
 #include <ecs/ComponentStore.h>
+#include <ecs/EventBus.h>
 #include <ecs/Manager.h>
 
 #include <iostream>
@@ -54,7 +55,7 @@ struct Collidable : public ecs::Component {
     }
 };
 
-// Component to detect restrict the play area
+// Resource to restrict the play area
 struct Area : public ecs::Component {
     static const ecs::ComponentType _mType;
 
@@ -69,11 +70,28 @@ struct Area : public ecs::Component {
     }
 };
 
+// Event emitted on collisions
+struct CollisionEvent : public ecs::Event {
+    static const ecs::EventType _mType;
+
+    ecs::Entity entity; // colliding Entity
+    const char* side;   // side of the Area (static string)
+    float       x;      // x coordinates of the collision
+    float       y;      // y coordinates of the collision
+
+    // Initialize collision
+    CollisionEvent(ecs::Entity aEntity, const char* aSide, float aX, float aY) :
+        entity(aEntity), side(aSide), x(aX), y(aY) {
+    }
+};
+
 const ecs::ComponentType Position::_mType   = 1;
 const ecs::ComponentType Speed::_mType      = 2;
 const ecs::ComponentType Collidable::_mType = 3;
 const ecs::ComponentType Area::_mType       = 4;
 
+const ecs::EventType CollisionEvent::_mType = 1;
+
 
 // A System to update Position with Speed data
 class SystemMove : public ecs::System {
@@ -88,7 +106,7 @@ public:
 
     // Update Position with Speed data and elapsed time
     virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) {
-        const Speed& speed = mManager.getComponentStore<Speed>().get(aEntity);
+        const Speed& speed = mManager.getComponentStore<Speed>().read(aEntity);
         Position& position = mManager.getComponentStore<Position>().get(aEntity);
 
         position.x += (speed.vx) * aElapsedTime;
@@ -100,7 +118,9 @@ public:
 class SystemCollide : public ecs::System {
 public:
     SystemCollide(ecs::Manager& aManager) :
-        ecs::System(aManager) {
+        ecs::System(aManager),
+        mArea(aManager.getResource<Area>()),
+        mCollisions(aManager.getEventBus().getChannel<CollisionEvent>()) {
         ecs::ComponentTypeSet requiredComponents;
         requiredComponents.insert(Position::_mType);
         requiredComponents.insert(Speed::_mType);
@@ -112,31 +132,35 @@ public:
     virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) {
         Speed& speed = mManager.getComponentStore<Speed>().get(aEntity);
         Position& position = mManager.getComponentStore<Position>().get(aEntity);
-        const Collidable& collidable = mManager.getComponentStore<Collidable>().get(aEntity);
+        const Collidable& collidable = mManager.getComponentStore<Collidable>().read(aEntity);
 
         // Detect collisions with limits of the Area
-        const Area& area = mManager.getComponentStore<Area>().getComponents().begin()->second;
+        const Area& area = mArea;
         if (position.x >= area.right) {
             position.x -= (position.x - area.right);
             speed.vx = -speed.vx;
-            std::cout << "Entity #" << aEntity << " Collision(right): (" << position.x << ", " << position.y << ")\n";
+            mCollisions.emit(CollisionEvent(aEntity, "right", position.x, position.y));
         } else if (position.x <= area.left) {
             position.x += (area.left - position.x);
             speed.vx = -speed.vx;
-            std::cout << "Entity #" << aEntity << " Collision(left): (" << position.x << ", " << position.y << ")\n";
+            mCollisions.emit(CollisionEvent(aEntity, "left", position.x, position.y));
         }
         if (position.y >= area.top) {
             position.y -= (position.y - area.top);
             speed.vy = -speed.vy;
-            std::cout << "Entity #" << aEntity << " Collision(top): (" << position.x << ", " << position.y << ")\n";
+            mCollisions.emit(CollisionEvent(aEntity, "top", position.x, position.y));
         } else if (position.y <= area.bottom) {
             position.y += (area.bottom - position.y);
             speed.vy = -speed.vy;
-            std::cout << "Entity #" << aEntity << " Collision(bottom): (" << position.x << ", " << position.y << ")\n";
+            mCollisions.emit(CollisionEvent(aEntity, "bottom", position.x, position.y));
         }
 
         // TODO Detect collision with other entities
     }
+
+private:
+    const Area&                         mArea;          // Area Resource, cached at construction
+    ecs::EventChannel<CollisionEvent>&  mCollisions;    // Channel of collision Events, cached at construction
 };
 
 // A System to "draw" (print) the Entity
@@ -151,7 +175,7 @@ public:
 
     // "Draw" (print) the Entity
     virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) {
-        const Position& position = mManager.getComponentStore<Position>().get(aEntity);
+        const Position& position = mManager.getComponentStore<Position>().read(aEntity);
         std::cout << "Entity #" << aEntity << " (" << position.x << ", " << position.y << ")\n";
     }
 };
@@ -171,27 +195,26 @@ int main() {
     std::cout << "sizeof(Collidable)=" << sizeof(Collidable) << std::endl;
     std::cout << "sizeof(Area)=" << sizeof(Area) << std::endl;
 
+    // Create all EventChannel, before the Systems using them
+    bRet &= manager.getEventBus().createChannel<CollisionEvent>();
+
     // Create all ComponentStore
     bRet &= manager.createComponentStore<Position>();
     bRet &= manager.createComponentStore<Speed>();
     bRet &= manager.createComponentStore<Collidable>();
-    bRet &= manager.createComponentStore<Area>();
 
     std::cout << "sizeof(storePosition)=" << sizeof(manager.getComponentStore<Position>()) << std::endl;
     std::cout << "sizeof(storeSpeed)=" << sizeof(manager.getComponentStore<Speed>()) << std::endl;
     std::cout << "sizeof(storeCollidable)=" << sizeof(manager.getComponentStore<Collidable>()) << std::endl;
-    std::cout << "sizeof(storeArea)=" << sizeof(manager.getComponentStore<Area>()) << std::endl;
+
+    // Set the Area Resource, before the Systems using it
+    bRet &= manager.setResource(Area(-1.0f, 1.0f, 1.0f, -1.0f));
 
     // Create the Systems
     manager.addSystem(ecs::System::Ptr(new SystemMove(manager)));
     manager.addSystem(ecs::System::Ptr(new SystemCollide(manager)));
     manager.addSystem(ecs::System::Ptr(new SystemDraw(manager)));
 
-    // Create an Area Entity
-    ecs::Entity area = manager.createEntity();
-    bRet &= manager.addComponent(area, Area(-1.0f, 1.0f, 1.0f, -1.0f));
-    manager.registerEntity(area);
-
     // Create a few Entities
     size_t nbRegistered = 0;
     for (size_t i = 0; i < 2; ++i) {
@@ -208,7 +231,13 @@ int main() {
     // Update them a few time, emulating a 30fps update
     size_t nbUpdated = 0;
     for (size_t i = 0; i < 20; ++i) {
-        nbUpdated += manager.updateEntities(0.032f); // 32ms (30fps)
+        nbUpdated += manager.updateFrame(0.032f); // 32ms (30fps)
+
+        // Print collisions Events of the frame
+        manager.getEventBus().getChannel<CollisionEvent>().forEach([](const CollisionEvent& aCollision) {
+            std::cout << "Entity #" << aCollision.entity << " Collision(" << aCollision.side << "): ("
+                      << aCollision.x << ", " << aCollision.y << ")\n";
+        });
     }
     std::cout << "Updated them " << nbUpdated << " time\n";
 
@@ -0,0 +1,375 @@
+/**
+ * @file    stress.cpp
+ * @ingroup ecs_stress_example
+ * @brief   Headless stress scenario of the Entity-Component-System manager.
+ *
+ * Bouncing balls, spawned and despawned continuously, simulated by a World of Manager shards,
+ * reporting frame time percentiles, Entities updated per second, and peak memory usage.
+ *
+ * Usage: ecs_example_stress [--entities N] [--threads T] [--frames F] [--churn C] [--systems move,collide,age]
+ * - entities: number of balls, spread over all shards (default 10000, up to millions)
+ * - threads:  number of Manager shards, each run on its own thread (default 1)
+ * - frames:   number of simulated frames (default 100)
+ * - churn:    fraction of the balls despawned, and respawned, each frame, on average (default 0.01)
+ * - systems:  comma separated list of Systems to run (default move,collide,age, "age" driving the churn)
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Component.h>
+#include <ecs/ComponentStore.h>
+#include <ecs/Manager.h>
+#include <ecs/World.h>
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <cstdlib> // atof, atol
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/resource.h>
+#endif
+
+// Component to store a 2d position
+struct Position : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float x;    // x coordinates in meters
+    float y;    // y coordinates in meters
+
+    // Initialize coordinates
+    Position(float aX, float aY) : x(aX), y(aY) {
+    }
+};
+
+// Component to store a 2d speed
+struct Speed : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float vx;   // speed along x coordinates in m/s
+    float vy;   // speed along y coordinates in m/s
+
+    // Initialize speed coordinates
+    Speed(float aX, float aY) : vx(aX), vy(aY) {
+    }
+};
+
+// Component to detect collisions
+struct Collidable : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float radius;
+
+    // Initialize radius
+    explicit Collidable(float aRadius) : radius(aRadius) {
+    }
+};
+
+// Component to despawn the Entity after some time
+struct Lifetime : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float remaining;    // remaining time to live, in seconds
+
+    // Initialize remaining time
+    explicit Lifetime(float aRemaining) : remaining(aRemaining) {
+    }
+};
+
+// Resource to restrict the play area
+struct Area : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float left;
+    float right;
+    float top;
+    float bottom;
+
+    // Initialize area
+    Area(float aLeft, float aRight, float aTop, float aDown) :
+        left(aLeft), right(aRight), top(aTop), bottom(aDown) {
+    }
+};
+
+const ecs::ComponentType Position::_mType   = 1;
+const ecs::ComponentType Speed::_mType      = 2;
+const ecs::ComponentType Collidable::_mType = 3;
+const ecs::ComponentType Lifetime::_mType   = 4;
+const ecs::ComponentType Area::_mType       = 5;
+
+// Simulated time of each frame, in seconds (60fps)
+static const float _frameTime = 1.0f / 60;
+
+
+// A System to update Position with Speed data
+class SystemMove : public ecs::System {
+public:
+    explicit SystemMove(ecs::Manager& aManager) :
+        ecs::System(aManager) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(Position::_mType);
+        requiredComponents.insert(Speed::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update Position with Speed data and elapsed time
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) {
+        const Speed& speed = mManager.getComponentStore<Speed>().read(aEntity);
+        Position& position = mManager.getComponentStore<Position>().get(aEntity);
+
+        position.x += (speed.vx) * aElapsedTime;
+        position.y += (speed.vy) * aElapsedTime;
+    }
+};
+
+// A System bouncing balls on the limits of the Area
+class SystemCollide : public ecs::System {
+public:
+    explicit SystemCollide(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mArea(aManager.getResource<Area>()) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(Position::_mType);
+        requiredComponents.insert(Speed::_mType);
+        requiredComponents.insert(Collidable::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update Speed and Position with collision detection
+    virtual void updateEntity(float, ecs::Entity aEntity) {
+        Speed& speed = mManager.getComponentStore<Speed>().get(aEntity);
+        Position& position = mManager.getComponentStore<Position>().get(aEntity);
+        const float radius = mManager.getComponentStore<Collidable>().read(aEntity).radius;
+
+        if ((position.x + radius) >= mArea.right) {
+            position.x = mArea.right - radius;
+            speed.vx = -speed.vx;
+        } else if ((position.x - radius) <= mArea.left) {
+            position.x = mArea.left + radius;
+            speed.vx = -speed.vx;
+        }
+        if ((position.y + radius) >= mArea.top) {
+            position.y = mArea.top - radius;
+            speed.vy = -speed.vy;
+        } else if ((position.y - radius) <= mArea.bottom) {
+            position.y = mArea.bottom + radius;
+            speed.vy = -speed.vy;
+        }
+    }
+
+private:
+    const Area& mArea;  // Area Resource, cached at construction
+};
+
+// A System aging Entities, listing the expired ones to be despawned after the frame
+class SystemAge : public ecs::System {
+public:
+    explicit SystemAge(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mExpired() {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(Lifetime::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Decrease the remaining time to live
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) {
+        Lifetime& lifetime = mManager.getComponentStore<Lifetime>().get(aEntity);
+        lifetime.remaining -= aElapsedTime;
+        if (lifetime.remaining <= 0.0f) {
+            mExpired.push_back(aEntity);
+        }
+    }
+
+    std::vector<ecs::Entity> mExpired;  // Entities expired during the frame
+};
+
+// Configuration of the scenario, from the command line
+struct Config {
+    size_t      nbEntities;
+    size_t      nbThreads;
+    size_t      nbFrames;
+    float       churn;
+    std::string systems;
+};
+
+// A shard of the World, with its own random generator and aging System
+struct Shard {
+    ecs::Manager*   pManager;
+    SystemAge*      pSystemAge;
+    std::mt19937    random;
+};
+
+// Spawn a ball in a shard
+static void spawn(Shard& aShard, const Config& aConfig) {
+    std::uniform_real_distribution<float> position(-0.9f, 0.9f);
+    std::uniform_real_distribution<float> speed(-1.0f, 1.0f);
+    std::uniform_real_distribution<float> lifetime(0.5f, 1.5f);
+    ecs::Manager& manager = *aShard.pManager;
+    const ecs::Entity ball = manager.createEntity();
+    manager.addComponent(ball, Position(position(aShard.random), position(aShard.random)));
+    manager.addComponent(ball, Speed(speed(aShard.random), speed(aShard.random)));
+    manager.addComponent(ball, Collidable(0.01f));
+    if (0.0f < aConfig.churn) {
+        // Despawned after 1/churn frames on average
+        manager.addComponent(ball, Lifetime(lifetime(aShard.random) * _frameTime / aConfig.churn));
+    }
+    manager.registerEntity(ball);
+}
+
+// Get the peak memory used by the process (resident set size), in bytes
+static size_t getPeakRss() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<size_t>(counters.PeakWorkingSetSize);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+#ifdef __APPLE__
+    return static_cast<size_t>(usage.ru_maxrss); // in bytes
+#else
+    return static_cast<size_t>(usage.ru_maxrss) * 1024; // in kilobytes
+#endif
+#endif
+}
+
+// Get a percentile of sorted frame times, by the nearest-rank method
+static double getPercentile(const std::vector<double>& aSortedTimes, double aPercentile) {
+    size_t rank = static_cast<size_t>((aPercentile * static_cast<double>(aSortedTimes.size())) / 100.0 + 0.999999);
+    rank = std::max(static_cast<size_t>(1), std::min(rank, aSortedTimes.size()));
+    return aSortedTimes[rank - 1];
+}
+
+
+/**
+ * Stress scenario of bouncing balls, with spawning and despawning churn.
+ */
+int main(int argc, char* argv[]) {
+    Config config = {10000, 1, 100, 0.01f, "move,collide,age"};
+    for (int arg = 1; arg + 1 < argc; arg += 2) {
+        const std::string name = argv[arg];
+        const char* value = argv[arg + 1];
+        if ("--entities" == name) {
+            config.nbEntities = static_cast<size_t>(std::atol(value));
+        } else if ("--threads" == name) {
+            config.nbThreads = std::max(static_cast<size_t>(1), static_cast<size_t>(std::atol(value)));
+        } else if ("--frames" == name) {
+            config.nbFrames = std::max(static_cast<size_t>(1), static_cast<size_t>(std::atol(value)));
+        } else if ("--churn" == name) {
+            config.churn = static_cast<float>(std::atof(value));
+        } else if ("--systems" == name) {
+            config.systems = value;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--entities N] [--threads T] [--frames F] [--churn C]"
+                      << " [--systems move,collide,age]\n";
+            return 1;
+        }
+    }
+    const bool bMove = (std::string::npos != config.systems.find("move"));
+    const bool bCollide = (std::string::npos != config.systems.find("collide"));
+    const bool bAge = (std::string::npos != config.systems.find("age"));
+    if (!bAge) {
+        config.churn = 0.0f;
+    }
+    std::cout << "Stress: " << config.nbEntities << " entities, " << config.nbThreads << " threads, "
+              << config.nbFrames << " frames, churn " << config.churn << ", systems " << config.systems << "\n";
+
+    // Setup each shard, with the same share of balls
+    ecs::World world(config.nbThreads);
+    std::vector<Shard> shards(config.nbThreads);
+    for (size_t index = 0; index < config.nbThreads; ++index) {
+        Shard& shard = shards[index];
+        shard.pManager = &world.getShard(index);
+        shard.pSystemAge = nullptr;
+        shard.random.seed(static_cast<std::mt19937::result_type>(index + 1));
+        ecs::Manager& manager = *shard.pManager;
+        manager.createComponentStore<Position>();
+        manager.createComponentStore<Speed>();
+        manager.createComponentStore<Collidable>();
+        manager.createComponentStore<Lifetime>();
+        manager.setResource(Area(-1.0f, 1.0f, 1.0f, -1.0f));
+        if (bMove) {
+            manager.addSystem(ecs::System::Ptr(new SystemMove(manager)));
+        }
+        if (bCollide) {
+            manager.addSystem(ecs::System::Ptr(new SystemCollide(manager)));
+        }
+        if (bAge) {
+            shard.pSystemAge = new SystemAge(manager);
+            manager.addSystem(ecs::System::Ptr(shard.pSystemAge));
+        }
+        const size_t nbEntities = (config.nbEntities / config.nbThreads) +
+                                  ((index < (config.nbEntities % config.nbThreads)) ? 1 : 0);
+        manager.reserveEntities(nbEntities);
+        for (size_t entity = 0; entity < nbEntities; ++entity) {
+            spawn(shard, config);
+        }
+    }
+
+    // Run the frames: all shards in parallel, then despawn expired balls and respawn as many (sync point)
+    std::vector<double> frameTimes;
+    frameTimes.reserve(config.nbFrames);
+    size_t nbUpdated = 0;
+    size_t nbRespawned = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t frame = 0; frame < config.nbFrames; ++frame) {
+        const auto frameStart = std::chrono::steady_clock::now();
+        nbUpdated += world.updateFrame(_frameTime);
+        for (auto shard  = shards.begin();
+                  shard != shards.end();
+                ++shard) {
+            if (nullptr != shard->pSystemAge) {
+                std::vector<ecs::Entity>& expired = shard->pSystemAge->mExpired;
+                for (auto entity  = expired.begin();
+                          entity != expired.end();
+                        ++entity) {
+                    shard->pManager->destroyEntity(*entity);
+                    spawn(*shard, config);
+                }
+                nbRespawned += expired.size();
+                expired.clear();
+            }
+        }
+        const std::chrono::steady_clock::duration frameTime = std::chrono::steady_clock::now() - frameStart;
+        frameTimes.push_back(std::chrono::duration<double, std::milli>(frameTime).count());
+    }
+    const double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    // Report
+    std::sort(frameTimes.begin(), frameTimes.end());
+    std::cout << "Frame time (ms): p50=" << getPercentile(frameTimes, 50.0)
+              << " p95=" << getPercentile(frameTimes, 95.0)
+              << " p99=" << getPercentile(frameTimes, 99.0)
+              << " max=" << frameTimes.back() << "\n";
+    std::cout << "Entities updated per second: " << static_cast<double>(nbUpdated) / totalTime << "\n";
+    std::cout << "Entities respawned: " << nbRespawned << "\n";
+    std::cout << "Peak RSS (MB): " << static_cast<double>(getPeakRss()) / (1024.0 * 1024.0) << "\n";
+
+    // The population shall stay constant
+    size_t nbBalls = 0;
+    for (auto shard  = shards.begin();
+              shard != shards.end();
+            ++shard) {
+        nbBalls += shard->pManager->getComponentStore<Position>().size();
+    }
+    const bool bRet = (config.nbEntities == nbBalls);
+    std::cout << "Done (ret=" << bRet << ")\n";
+    return (bRet?0:1);
+}
@@ -0,0 +1,63 @@
+/**
+ * @file    AllocationTracker.h
+ * @ingroup ecs
+ * @brief   The ecs::AllocationTracker counts the dynamic memory allocations of each thread.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <cstddef>   // size_t
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   The AllocationTracker counts the dynamic memory allocations (number and bytes) of each thread.
+ * @ingroup ecs
+ *
+ *  Allocations are counted by the global operator new, replaced by the library only when built with
+ * the ECS_TRACK_ALLOCATIONS option (define): otherwise isEnabled() is false and all counters stay at zero.
+ * Counters are per thread (thread local), so the Manager of each shard measures only its own allocations,
+ * by the difference of the counters before and after each frame and each System.
+ */
+class AllocationTracker {
+public:
+    /// Number and size of allocations.
+    struct Counters {
+        uint64_t    mNbAllocations; ///< Number of allocations
+        uint64_t    mNbBytes;       ///< Total number of bytes allocated
+
+        /// Get the allocations made since an earlier value of the counters.
+        inline Counters operator-(const Counters& aEarlier) const {
+            const Counters counters = {mNbAllocations - aEarlier.mNbAllocations, mNbBytes - aEarlier.mNbBytes};
+            return counters;
+        }
+    };
+
+    /**
+     * @brief Test if allocations are counted (library built with ECS_TRACK_ALLOCATIONS).
+     */
+    static bool isEnabled();
+
+    /**
+     * @brief Get the counters of all allocations of the calling thread since its start.
+     */
+    static Counters getCounters();
+
+    /**
+     * @brief Count an allocation of the calling thread (called by the replaced operator new, or by custom allocators).
+     *
+     * @param[in] aSize Number of bytes allocated.
+     */
+    static void recordAllocation(size_t aSize);
+
+private:
+    /// Only static methods
+    AllocationTracker();
+};
+
+} // namespace ecs
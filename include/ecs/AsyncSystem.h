@@ -0,0 +1,96 @@
+/**
+ * @file    AsyncSystem.h
+ * @ingroup ecs
+ * @brief   A ecs::AsyncSystem launches asynchronous work on a ecs::Executor, applied back at a later sync point.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/System.h>
+#include <ecs/Executor.h>
+
+#include <deque>
+#include <functional>
+#include <future>
+
+namespace ecs {
+
+/**
+ * @brief   An AsyncSystem launches asynchronous work on an Executor, applied back to Components at a later sync point.
+ * @ingroup ecs
+ *
+ *  Made for Systems that would otherwise block inside updateEntity() (persistence writes, requests to a pool
+ * of workers, log shipping), stalling the whole frame. Typically, updateEntity() copies the input of each Entity
+ * into a batch, and launches the batch when full, and endUpdateEntities() launches the last partial batch.
+ *
+ *  The Work runs on a thread of the Executor, so it shall not access the Manager: it only works on the data
+ * it captured by value, and returns a Completion. Completions are applied, in order of launch, by the thread
+ * owning the Manager, at the next sync point where their Work is done (Manager::applyCompletions(), called at
+ * the start of each frame): slow work overlaps with the following frames instead of extending the current one.
+ * A Completion shall check that its Entities still exist, since they can be destroyed in the meantime.
+ *
+ *  This is a base class that needs to be subclassed.
+ */
+class AsyncSystem : public System {
+public:
+    /// Function applying the result of asynchronous work to the Manager, at a sync point.
+    typedef std::function<void(Manager&)> Completion;
+
+    /// Asynchronous work, run on a thread of the Executor, returning its Completion.
+    typedef std::function<Completion()> Work;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aManager  Reference to the manager needed to access Entity Components.
+     * @param[in] aExecutor Executor running the asynchronous work (shall outlive the System).
+     */
+    AsyncSystem(Manager& aManager, Executor& aExecutor);
+
+    /**
+     * @brief Destructor, waiting for all pending work (without applying it).
+     */
+    virtual ~AsyncSystem();
+
+    /**
+     * @brief Apply the Completions of finished work, in order of launch (sync point).
+     *
+     *  Stops at the first work not yet finished, so that Completions are always applied in order of launch.
+     * Rethrows the exception thrown by a work, if any (the following Completions are applied by the next call).
+     *
+     * @return Number of applied Completions.
+     */
+    size_t applyCompletions();
+
+    /**
+     * @brief Wait for all pending work, and apply their Completions, in order of launch (sync point).
+     *
+     * @return Number of applied Completions.
+     */
+    size_t waitCompletions();
+
+    /**
+     * @brief Get the number of launched work, not yet applied.
+     */
+    inline size_t getNbPendingWorks() const {
+        return mPendingWorks.size();
+    }
+
+protected:
+    /**
+     * @brief Launch asynchronous work on the Executor.
+     *
+     * @param[in] aWork Work to run, capturing its input by value, and returning its Completion.
+     */
+    void launch(Work&& aWork);
+
+private:
+    Executor&                           mExecutor;      ///< Executor running the asynchronous work
+    std::deque<std::future<Completion> > mPendingWorks; ///< Launched work, in order
+};
+
+} // namespace ecs
@@ -0,0 +1,258 @@
+/**
+ * @file    BlobComponentStore.h
+ * @ingroup ecs
+ * @brief   A ecs::BlobComponentStore keeps the raw data of a type of ecs::Component defined at runtime.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/ComponentStore.h>
+#include <ecs/ComponentLayout.h>
+
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A BlobComponentStore keeps the raw data of a type of Component defined at runtime by a ComponentLayout.
+ * @ingroup ecs
+ *
+ *  Like a ComponentStore, Components are packed in a contiguous array (of blobs of getStride() bytes),
+ * with the array of their Entities at the same indexes, and a hash map giving the index of each Entity.
+ * Components are plain data: they are zero-initialized when added, and copied or moved with memcpy.
+ *
+ *  Fields are read and written through the pointer to the blob of a Component, with getField().
+ */
+class BlobComponentStore : public IComponentStore {
+public:
+    /**
+     * @brief Constructor.
+     *
+     *  Throws std::runtime_error if the layout is empty.
+     *
+     * @param[in] aType     Type of the stored Components.
+     * @param[in] aLayout   Layout of the stored Components.
+     */
+    BlobComponentStore(ComponentType aType, const ComponentLayout& aLayout);
+
+    /// Destructor.
+    virtual ~BlobComponentStore();
+
+    /// Get the type of the stored Components.
+    inline ComponentType getType() const {
+        return mType;
+    }
+
+    /// Get the layout of the stored Components.
+    inline const ComponentLayout& getLayout() const {
+        return mLayout;
+    }
+
+    /// Get the size of each blob in the packed array, in bytes.
+    inline size_t getStride() const {
+        return mLayout.getSize();
+    }
+
+    /**
+     * @brief Add a zero-initialized Component associated to an Entity.
+     *
+     * @param[in] aEntity   Id of the Entity with the Component to add.
+     *
+     * @return Pointer to the new Component, valid until the next change of the store, or nullptr if already there.
+     */
+    void* add(const Entity aEntity);
+
+    /**
+     * @brief Remove (destroy) the Component associated to an Entity.
+     *
+     * @param[in] aEntity   Id of the Entity to remove.
+     *
+     * @return true if finding and removing the Entity succeeded.
+     */
+    virtual bool remove(Entity aEntity);
+
+    /**
+     * @brief Move the Component associated to an Entity into another BlobComponentStore of the same layout.
+     *
+     *  Throws std::runtime_error if the target store is not a BlobComponentStore of the same layout.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to move.
+     * @param[in] aTargetStore  BlobComponentStore of the same type of Component, receiving the Component.
+     *
+     * @return true if finding and moving the Component succeeded.
+     */
+    virtual bool moveTo(Entity aEntity, IComponentStore& aTargetStore);
+
+    /**
+     * @brief Test if another store is a BlobComponentStore of the same layout, able to receive the Components.
+     *
+     * @param[in] aTargetStore  Store registered under the same ComponentType in another Manager.
+     */
+    virtual bool canMoveTo(const IComponentStore& aTargetStore) const;
+
+    /**
+     * @brief Copy the Component associated to an Entity to a list of Entities (without any Component of this type).
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to copy (typically a prefab).
+     * @param[in] apEntities    List of Entities receiving a copy of the Component.
+     * @param[in] aNbEntities   Number of Entities in the list.
+     *
+     * @return Number of Components added.
+     */
+    virtual size_t clone(Entity aEntity, const Entity* apEntities, size_t aNbEntities);
+
+    /**
+     * @brief Test if the Components can be copied by clone(): always, as raw bytes.
+     */
+    virtual bool isCopyable() const;
+
+    /**
+     * @brief Test if the store contains a Component for the specified Entity.
+     */
+    inline bool has(Entity aEntity) const {
+        return (mIndexes.end() != mIndexes.find(aEntity));
+    }
+
+    /**
+     * @brief Get access to the Component associated with the specified Entity.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     *
+     * @return Pointer to the blob of the Component, valid until the next change of the store.
+     */
+    inline void* get(Entity aEntity) {
+        touch();
+        return getAt(mIndexes.at(aEntity));
+    }
+    /**
+     * @brief Get read-only access to the Component associated with the specified Entity.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     */
+    inline const void* get(Entity aEntity) const {
+        return getAt(mIndexes.at(aEntity));
+    }
+
+    /**
+     * @brief Get access to the Component at an index of the packed array (see Join).
+     *
+     * @param[in] aIndex    Index in the packed array, in [0; size()[.
+     */
+    inline void* getAt(size_t aIndex) {
+        touch();
+        return reinterpret_cast<uint8_t*>(mData.data()) + (aIndex * getStride());
+    }
+    /**
+     * @brief Get read-only access to the Component at an index of the packed array (see Join).
+     */
+    inline const void* getAt(size_t aIndex) const {
+        return reinterpret_cast<const uint8_t*>(mData.data()) + (aIndex * getStride());
+    }
+
+    /**
+     * @brief Get access to a field of a Component, checking its type.
+     *
+     *  Throws std::runtime_error if the type T does not match the type of the field.
+     *
+     * @tparam T    C++ type of the field.
+     *
+     * @param[in] apComponent   Pointer to the blob of the Component.
+     * @param[in] aFieldIndex   Index of the field in the layout (see ComponentLayout::findField()).
+     *
+     * @return  Reference to the field.
+     */
+    template<typename T>
+    inline T& getField(void* apComponent, size_t aFieldIndex) const {
+        const ComponentLayout::Field& field = mLayout.getField(aFieldIndex);
+        const bool bEntity = std::is_same<T, Entity>::value && (ComponentLayout::eEntity == field.mType);
+        if ((FieldTypeOf<T>::_mType != field.mType) && !bEntity) {
+            throw std::runtime_error("The type does not match the type of the field");
+        }
+        return *reinterpret_cast<T*>(static_cast<uint8_t*>(apComponent) + field.mOffset);
+    }
+
+    /// Get the number of stored Components.
+    inline size_t size() const {
+        return mEntities.size();
+    }
+
+    /**
+     * @brief Get access to the packed array of Entities, in the same order as the packed array of Components.
+     */
+    virtual const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Test if the packed arrays are sorted by increasing Entities.
+     */
+    virtual bool isSortedByEntity() const {
+        return mbSorted;
+    }
+
+    /**
+     * @brief Sort the packed arrays by increasing Entities (if not already sorted),
+     *        invalidating pointers to Components.
+     */
+    virtual void sortByEntity();
+
+    /**
+     * @brief Reserve memory for a number of Components, so that adding them does not grow the packed arrays.
+     *
+     * @param[in] aNbComponents Number of Components.
+     */
+    virtual void reserve(size_t aNbComponents);
+
+    /**
+     * @brief Create an empty State, to save the content of the store.
+     */
+    virtual IComponentStore::State::Ptr createState() const;
+
+    /**
+     * @brief Save the content of the store (a block copy of the packed arrays).
+     */
+    virtual void saveState(IComponentStore::State& aState) const;
+
+    /**
+     * @brief Restore the content of the store from a saved State.
+     */
+    virtual void restoreState(const IComponentStore::State& aState);
+
+private:
+    /// Saved content of the store.
+    class State : public IComponentStore::State {
+    public:
+        std::vector<uint64_t>               mData;      ///< Packed array of blobs
+        std::vector<Entity>                 mEntities;  ///< Entity of each stored Component
+        std::unordered_map<Entity, size_t>  mIndexes;   ///< Index of the Component of each Entity
+        bool                                mbSorted;   ///< Are the packed arrays sorted by Entity?
+    };
+
+    /// Non copyable
+    BlobComponentStore(const BlobComponentStore&);
+    /// Non copyable
+    BlobComponentStore& operator=(const BlobComponentStore&);
+
+    /// Append a blob for a new Entity, returning its index.
+    size_t append(const Entity aEntity);
+
+    /// Remove the Component at an index, moving the last one in its place.
+    void erase(std::unordered_map<Entity, size_t>::iterator aIndex);
+
+    ComponentType                       mType;      ///< Type of the stored Components
+    ComponentLayout                     mLayout;    ///< Layout of the stored Components
+    std::vector<uint64_t>               mData;      ///< Packed array of blobs (aligned on 8 bytes)
+    std::vector<Entity>                 mEntities;  ///< Entity of each stored Component
+    std::unordered_map<Entity, size_t>  mIndexes;   ///< Index of the Component of each Entity
+    bool                                mbSorted;   ///< Are the packed arrays sorted by Entity?
+};
+
+} // namespace ecs
@@ -0,0 +1,115 @@
+/**
+ * @file    ComponentFilter.h
+ * @ingroup ecs
+ * @brief   A ecs::ComponentFilter selects ecs::Entity by the types of their ecs::Component.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/ComponentType.h>
+#include <ecs/Signature.h>
+
+#include <utility>  // std::move
+
+namespace ecs {
+
+/**
+ * @brief   A ComponentFilter selects Entities by the types of their Components.
+ * @ingroup ecs
+ *
+ *  An Entity matches a filter if it has all the required Components, and none of the excluded ones.
+ * Optional Components do not take part in the matching: they only declare Components that may be accessed
+ * when present (using ComponentStore::find()).
+ *
+ *  The filter is evaluated once when an Entity is registered, so that filtered Entities never appear in iteration.
+ * Required and excluded Components are also kept as Signatures, so that matching only takes a few bitwise operations.
+ */
+class ComponentFilter {
+public:
+    /// Constructor of an empty filter (matching any Entity).
+    ComponentFilter();
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aRequiredComponents   Types of all the Components required by the filter.
+     * @param[in] aExcludedComponents   Types of all the Components excluded by the filter.
+     * @param[in] aOptionalComponents   Types of all the Components optionally accessed.
+     */
+    explicit ComponentFilter(ComponentTypeSet&& aRequiredComponents,
+                             ComponentTypeSet&& aExcludedComponents = ComponentTypeSet(),
+                             ComponentTypeSet&& aOptionalComponents = ComponentTypeSet());
+
+    /// Destructor.
+    ~ComponentFilter();
+
+    /**
+     * @brief Test if the Components of an Entity match the filter.
+     *
+     * @param[in] aEntityComponents Types of all the Components of the Entity.
+     *
+     * @return true if the Entity has all the required Components and none of the excluded ones.
+     */
+    bool matches(const ComponentTypeSet& aEntityComponents) const;
+
+    /**
+     * @brief Test if the Signature of an Entity matches the filter.
+     *
+     * @param[in] aEntitySignature  Signature of the Entity, listing the Types of all its Components.
+     *
+     * @return true if the Entity has all the required Components and none of the excluded ones.
+     */
+    inline bool matches(const Signature& aEntitySignature) const {
+        return (aEntitySignature.includes(mRequiredSignature) && !aEntitySignature.intersects(mExcludedSignature));
+    }
+
+    /**
+     * @brief Test if a type of Component is required or excluded by the filter (thus can change its matching).
+     *
+     * @param[in] aComponentType    Type of Component to test.
+     */
+    inline bool isFiltering(ComponentType aComponentType) const {
+        return (mRequiredSignature.test(aComponentType) || mExcludedSignature.test(aComponentType));
+    }
+
+    /// Get the Types of all the Components required by the filter.
+    inline const ComponentTypeSet& getRequiredComponents() const {
+        return mRequiredComponents;
+    }
+    /// Get the Types of all the Components excluded by the filter.
+    inline const ComponentTypeSet& getExcludedComponents() const {
+        return mExcludedComponents;
+    }
+    /// Get the Types of all the Components optionally accessed.
+    inline const ComponentTypeSet& getOptionalComponents() const {
+        return mOptionalComponents;
+    }
+
+    /// Specify the Types of all the Components required by the filter.
+    inline void setRequiredComponents(ComponentTypeSet&& aRequiredComponents) {
+        mRequiredSignature = Signature(aRequiredComponents);
+        mRequiredComponents = std::move(aRequiredComponents);
+    }
+    /// Specify the Types of all the Components excluded by the filter.
+    inline void setExcludedComponents(ComponentTypeSet&& aExcludedComponents) {
+        mExcludedSignature = Signature(aExcludedComponents);
+        mExcludedComponents = std::move(aExcludedComponents);
+    }
+    /// Specify the Types of all the Components optionally accessed.
+    inline void setOptionalComponents(ComponentTypeSet&& aOptionalComponents) {
+        mOptionalComponents = std::move(aOptionalComponents);
+    }
+
+private:
+    ComponentTypeSet    mRequiredComponents;    ///< Types of all the Components required
+    ComponentTypeSet    mExcludedComponents;    ///< Types of all the Components excluded
+    ComponentTypeSet    mOptionalComponents;    ///< Types of all the Components optionally accessed
+    Signature           mRequiredSignature;     ///< Signature of all the Components required
+    Signature           mExcludedSignature;     ///< Signature of all the Components excluded
+};
+
+} // namespace ecs
@@ -0,0 +1,161 @@
+/**
+ * @file    ComponentLayout.h
+ * @ingroup ecs
+ * @brief   A ecs::ComponentLayout describes the fields of a type of ecs::Component defined at runtime.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+
+#include <string>
+#include <vector>
+#include <cstddef>   // size_t
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A ComponentLayout describes the fields of a type of Component defined at runtime (by data or scripts).
+ * @ingroup ecs
+ *
+ *  Fields are added one by one, either at the next free offset respecting their alignment, or at an explicit
+ * offset; the size of the Component is then rounded up to its alignment (the biggest alignment of its fields).
+ *
+ * @see BlobComponentStore
+ */
+class ComponentLayout {
+public:
+    /**
+     * @brief Types of fields.
+     */
+    enum FieldType {
+        eBool = 0,  ///< bool (1 byte)
+        eInt32,     ///< int32_t
+        eUInt32,    ///< uint32_t
+        eInt64,     ///< int64_t
+        eFloat,     ///< float
+        eDouble,    ///< double
+        eEntity     ///< Entity
+    };
+
+    /**
+     * @brief A field of a Component.
+     */
+    struct Field {
+        std::string mName;      ///< Name of the field
+        FieldType   mType;      ///< Type of the field
+        size_t      mOffset;    ///< Offset of the field in the Component, in bytes
+    };
+
+    /**
+     * @brief Constructor of an empty layout.
+     *
+     * @param[in] aName Name of the type of Component.
+     */
+    explicit ComponentLayout(const std::string& aName);
+
+    /// Destructor.
+    ~ComponentLayout();
+
+    /**
+     * @brief Add a field at the next free offset respecting its alignment.
+     *
+     *  Throws std::runtime_error if a field of the same name already exists.
+     *
+     * @param[in] aName Name of the field.
+     * @param[in] aType Type of the field.
+     *
+     * @return  Index of the field.
+     */
+    size_t addField(const std::string& aName, FieldType aType);
+
+    /**
+     * @brief Add a field at an explicit offset.
+     *
+     *  Throws std::runtime_error if a field of the same name already exists, if the offset is not aligned
+     * for the type of the field, or if the field overlaps another one.
+     *
+     * @param[in] aName     Name of the field.
+     * @param[in] aType     Type of the field.
+     * @param[in] aOffset   Offset of the field in the Component, in bytes.
+     *
+     * @return  Index of the field.
+     */
+    size_t addField(const std::string& aName, FieldType aType, size_t aOffset);
+
+    /// Get the name of the type of Component.
+    inline const std::string& getName() const {
+        return mName;
+    }
+
+    /// Get the size of the Component, in bytes, multiple of its alignment.
+    inline size_t getSize() const {
+        return mSize;
+    }
+
+    /// Get the alignment of the Component, in bytes.
+    inline size_t getAlignment() const {
+        return mAlignment;
+    }
+
+    /// Get the number of fields.
+    inline size_t getNbFields() const {
+        return mFields.size();
+    }
+
+    /// Get a field by index.
+    inline const Field& getField(size_t aIndex) const {
+        return mFields.at(aIndex);
+    }
+
+    /**
+     * @brief Find a field by name.
+     *
+     *  Throws std::runtime_error if the field does not exist.
+     *
+     * @param[in] aName Name of the field.
+     *
+     * @return  Index of the field.
+     */
+    size_t findField(const std::string& aName) const;
+
+    /**
+     * @brief Test if another layout describes the same type of Component: same name, size, and fields.
+     *
+     * @param[in] aLayout   Layout to compare.
+     */
+    bool isSameAs(const ComponentLayout& aLayout) const;
+
+    /**
+     * @brief Get the size (and alignment) of a type of field, in bytes.
+     */
+    static size_t getFieldSize(FieldType aType);
+
+private:
+    std::string         mName;      ///< Name of the type of Component
+    std::vector<Field>  mFields;    ///< Fields, in order of addition
+    size_t              mSize;      ///< Size of the Component, in bytes, multiple of its alignment
+    size_t              mAlignment; ///< Alignment of the Component, in bytes
+};
+
+/**
+ * @brief   Type of field matching a C++ type, to check typed accesses to the fields of runtime Components.
+ * @ingroup ecs
+ */
+template<typename T>
+struct FieldTypeOf;
+/// @cond
+template<> struct FieldTypeOf<bool>     { static const ComponentLayout::FieldType _mType = ComponentLayout::eBool; };
+template<> struct FieldTypeOf<int32_t>  { static const ComponentLayout::FieldType _mType = ComponentLayout::eInt32; };
+template<> struct FieldTypeOf<uint32_t> { static const ComponentLayout::FieldType _mType = ComponentLayout::eUInt32; };
+template<> struct FieldTypeOf<int64_t>  { static const ComponentLayout::FieldType _mType = ComponentLayout::eInt64; };
+template<> struct FieldTypeOf<float>    { static const ComponentLayout::FieldType _mType = ComponentLayout::eFloat; };
+template<> struct FieldTypeOf<double>   { static const ComponentLayout::FieldType _mType = ComponentLayout::eDouble; };
+/// @endcond
+
+} // namespace ecs
@@ -0,0 +1,74 @@
+/**
+ * @file    ComponentObserver.h
+ * @ingroup ecs
+ * @brief   A ecs::ComponentObserver reacts to batches of added, removed or changed ecs::Component.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/ComponentType.h>
+#include <ecs/Entity.h>
+
+#include <vector>
+#include <memory>
+
+namespace ecs {
+
+/**
+ * @brief   A ComponentObserver reacts to batches of added, removed or changed Components of a certain type.
+ * @ingroup ecs
+ *
+ *  Changes are recorded by ComponentStores as lists of Entities, and delivered once per type of Component
+ * at sync points by Manager::notifyObservers(), instead of a virtual callback for each change on the hot path.
+ * Observers can then replace full scans of all Entities, reacting only to changes (spatial index, physics...).
+ *
+ *  This is a base class that needs to be subclassed, overriding only the needed methods.
+ */
+class ComponentObserver {
+public:
+    /// A shared pointer to a ComponentObserver, so that it can observe multiple types of Components.
+    typedef std::shared_ptr<ComponentObserver> Ptr;
+
+    /// Destructor.
+    virtual ~ComponentObserver() {
+    }
+
+    /**
+     * @brief Called at a sync point with all Entities whose Component have been added since last sync point.
+     *
+     * @param[in] aComponentType    Type of the added Components.
+     * @param[in] aEntities         Entities whose Component have been added, in order.
+     */
+    virtual void onAdded(ComponentType aComponentType, const std::vector<Entity>& aEntities) {
+        (void)aComponentType;
+        (void)aEntities;
+    }
+
+    /**
+     * @brief Called at a sync point with all Entities whose Component have been removed since last sync point.
+     *
+     * @param[in] aComponentType    Type of the removed Components.
+     * @param[in] aEntities         Entities whose Component have been removed (or migrated), in order.
+     */
+    virtual void onRemoved(ComponentType aComponentType, const std::vector<Entity>& aEntities) {
+        (void)aComponentType;
+        (void)aEntities;
+    }
+
+    /**
+     * @brief Called at a sync point with all Entities whose Component have been marked as changed.
+     *
+     * @param[in] aComponentType    Type of the changed Components.
+     * @param[in] aEntities         Entities whose Component have been changed, sorted, without duplicates.
+     */
+    virtual void onChanged(ComponentType aComponentType, const std::vector<Entity>& aEntities) {
+        (void)aComponentType;
+        (void)aEntities;
+    }
+};
+
+} // namespace ecs
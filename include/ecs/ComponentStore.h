@@ -12,15 +12,25 @@
 
 #include <ecs/Entity.h>
 #include <ecs/Component.h>
+#include <ecs/SecondaryIndex.h>
 
 #include <unordered_map>
+#include <vector>
 #include <memory>
+#include <type_traits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstdint>
 
 namespace ecs {
 
 /**
  * @brief   Abstract base class for all templated ComponentStore.
  * @ingroup ecs
+ *
+ *  When tracking changes (enabled by Manager::addObserver()), the store records the Entities whose Component
+ * have been added, removed, or marked as changed, as batches delivered to ComponentObservers at sync points.
+ * The same changes keep its secondary indexes (see SecondaryIndex) up to date.
  */
 class IComponentStore {
 public:
@@ -30,6 +40,279 @@ public:
      * @todo Remove the use of a pointer => move the ComponentStore into the manager
      */
     typedef std::unique_ptr<IComponentStore> Ptr;
+
+    /**
+     * @brief Saved content of a ComponentStore (see Rollback), reused from a save to the next to avoid allocations.
+     */
+    class State {
+    public:
+        /// Unique pointer to a saved content
+        typedef std::unique_ptr<State> Ptr;
+
+        /// Virtual destructor.
+        virtual ~State() {
+        }
+    };
+
+    /**
+     * @brief Kind of ComponentStore, checked before casting a store to its concrete class.
+     */
+    enum Kind {
+        eTypedStore = 0,    ///< ComponentStore<C>
+        eBlobStore,         ///< BlobComponentStore, of a runtime type of Component
+        eMappedStore        ///< MappedComponentStore<C>, backed by a memory-mapped file
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aKind Kind of the concrete store.
+     */
+    explicit IComponentStore(Kind aKind) :
+        mKind(aKind),
+        mbTrackChanges(false),
+        mAddedEntities(),
+        mRemovedEntities(),
+        mChangedEntities(),
+        mSecondaryIndexes(),
+        mVersion(0) {
+    }
+
+    /// Virtual destructor, required to destroy a ComponentStore through its unique pointer.
+    virtual ~IComponentStore() {
+    }
+
+    /**
+     * @brief Get the kind of the concrete store.
+     */
+    inline Kind getKind() const {
+        return mKind;
+    }
+
+    /**
+     * @brief Enable or disable the tracking of added, removed and changed Components.
+     *
+     * @param[in] abTrackChanges    true to record Entities whose Component are added, removed or changed.
+     */
+    inline void setTrackChanges(bool abTrackChanges) {
+        mbTrackChanges = abTrackChanges;
+    }
+
+    /**
+     * @brief Test if the store records Entities whose Component are added, removed or changed.
+     */
+    inline bool isTrackingChanges() const {
+        return mbTrackChanges;
+    }
+
+    /**
+     * @brief Mark the Component associated to an Entity as changed (recorded only when tracking changes).
+     *
+     * @param[in] aEntity   Id of the Entity whose Component has been modified.
+     */
+    inline void markChanged(Entity aEntity) {
+        if (mbTrackChanges) {
+            mChangedEntities.push_back(aEntity);
+        }
+        markIndexesDirty(aEntity);
+    }
+
+    /// Get the Entities whose Component have been added since last clearChanges(), in order.
+    inline const std::vector<Entity>& getAddedEntities() const {
+        return mAddedEntities;
+    }
+    /// Get the Entities whose Component have been removed since last clearChanges(), in order.
+    inline const std::vector<Entity>& getRemovedEntities() const {
+        return mRemovedEntities;
+    }
+    /// Get the Entities whose Component have been marked as changed since last clearChanges() (with duplicates).
+    inline const std::vector<Entity>& getChangedEntities() const {
+        return mChangedEntities;
+    }
+    /// Get the Entities whose Component have been marked as changed since last clearChanges() (with duplicates).
+    inline std::vector<Entity>& getChangedEntities() {
+        return mChangedEntities;
+    }
+
+    /**
+     * @brief Forget all recorded changes (keeping the capacity of the lists for the next frames).
+     */
+    inline void clearChanges() {
+        mAddedEntities.clear();
+        mRemovedEntities.clear();
+        mChangedEntities.clear();
+    }
+
+    /**
+     * @brief Remove (destroy) the specified Component associated to an Entity.
+     *
+     * @param[in] aEntity   Id of the Entity to remove.
+     *
+     * @return true if finding and removing the Entity succeeded.
+     */
+    virtual bool remove(Entity aEntity) = 0;
+
+    /**
+     * @brief Move the Component associated to an Entity into another ComponentStore of the same type.
+     *
+     *  Throws std::runtime_error if the target store cannot receive the Components of this store (see canMoveTo()).
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to move.
+     * @param[in] aTargetStore  ComponentStore of the same type of Component, receiving the Component.
+     *
+     * @return true if finding and moving the Component succeeded.
+     */
+    virtual bool moveTo(Entity aEntity, IComponentStore& aTargetStore) = 0;
+
+    /**
+     * @brief Test if another store can receive the Components of this one: same kind, and same type or layout.
+     *
+     *  ComponentTypes of runtime Components are assigned by each Manager: the same ComponentType can be given
+     * to different types in different shards.
+     *
+     * @param[in] aTargetStore  Store registered under the same ComponentType in another Manager.
+     */
+    virtual bool canMoveTo(const IComponentStore& aTargetStore) const = 0;
+
+    /**
+     * @brief Copy the Component associated to an Entity to a list of Entities (without any Component of this type).
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to copy (typically a prefab).
+     * @param[in] apEntities    List of Entities receiving a copy of the Component.
+     * @param[in] aNbEntities   Number of Entities in the list.
+     *
+     * @return Number of Components added.
+     */
+    virtual size_t clone(Entity aEntity, const Entity* apEntities, size_t aNbEntities) = 0;
+
+    /**
+     * @brief Test if the Components of the store can be copied by clone() (else it throws std::runtime_error).
+     */
+    virtual bool isCopyable() const = 0;
+
+    /**
+     * @brief Get access to the packed array of Entities, in the same order as the packed array of Components.
+     */
+    virtual const std::vector<Entity>& getEntities() const = 0;
+
+    /**
+     * @brief Test if the packed arrays are sorted by increasing Entities.
+     */
+    virtual bool isSortedByEntity() const = 0;
+
+    /**
+     * @brief Sort the packed arrays by increasing Entities (if not already sorted),
+     *        invalidating pointers to Components.
+     */
+    virtual void sortByEntity() = 0;
+
+    /**
+     * @brief Reserve memory for a number of Components, so that adding them does not grow the packed arrays.
+     *
+     *  Adding a Component can still allocate a node of the hash map of indexes of the store.
+     *
+     * @param[in] aNbComponents Number of Components.
+     */
+    virtual void reserve(size_t aNbComponents) = 0;
+
+    /**
+     * @brief Get the version of the content of the store, changed by any modification or non-const access.
+     *
+     *  Reading a Component with ComponentStore::read(), or through a const store, leaves the version unchanged.
+     */
+    inline uint64_t getVersion() const {
+        return mVersion;
+    }
+
+    /**
+     * @brief Create an empty State, to save the content of the store.
+     *
+     *  Throws std::runtime_error if the store does not support saving its content.
+     */
+    virtual State::Ptr createState() const {
+        throw std::runtime_error("The ComponentStore cannot save its content");
+    }
+
+    /**
+     * @brief Save the content of the store (copying it in a State created by createState()).
+     *
+     *  Throws std::runtime_error if the store does not support saving its content.
+     */
+    virtual void saveState(State&) const {
+        throw std::runtime_error("The ComponentStore cannot save its content");
+    }
+
+    /**
+     * @brief Restore the content of the store from a saved State (changing its version).
+     *
+     *  Throws std::runtime_error if the store does not support saving its content.
+     */
+    virtual void restoreState(const State&) {
+        throw std::runtime_error("The ComponentStore cannot save its content");
+    }
+
+protected:
+    /// Change the version of the content of the store, before any modification or non-const access.
+    inline void touch() {
+        ++mVersion;
+    }
+
+    /// Reserve memory to record changes of a number of Components (only when tracking changes).
+    inline void reserveChanges(size_t aNbComponents) {
+        if (mbTrackChanges) {
+            mAddedEntities.reserve(aNbComponents);
+            mRemovedEntities.reserve(aNbComponents);
+            mChangedEntities.reserve(aNbComponents);
+        }
+    }
+
+    /// Record an Entity whose Component has been added (only when tracking changes).
+    inline void markAdded(Entity aEntity) {
+        if (mbTrackChanges) {
+            mAddedEntities.push_back(aEntity);
+        }
+        markIndexesDirty(aEntity);
+    }
+    /// Record an Entity whose Component has been removed (only when tracking changes).
+    inline void markRemoved(Entity aEntity) {
+        if (mbTrackChanges) {
+            mRemovedEntities.push_back(aEntity);
+        }
+        markIndexesDirty(aEntity);
+    }
+
+    /// Add a secondary index, owned by the store.
+    inline void addIndex(ISecondaryIndex::Ptr&& apIndex) {
+        mSecondaryIndexes.push_back(std::move(apIndex));
+    }
+    /// Mark the whole content of the store as changed, for all secondary indexes.
+    inline void markIndexesAllDirty() {
+        for (auto index  = mSecondaryIndexes.begin();
+                  index != mSecondaryIndexes.end();
+                ++index) {
+            (*index)->markAllDirty();
+        }
+    }
+    /// Mark an Entity whose Component has been added, removed or changed, for all secondary indexes.
+    inline void markIndexesDirty(Entity aEntity) {
+        if (!mSecondaryIndexes.empty()) {
+            const size_t nbComponents = getEntities().size();
+            for (auto index  = mSecondaryIndexes.begin();
+                      index != mSecondaryIndexes.end();
+                    ++index) {
+                (*index)->markDirty(aEntity, nbComponents);
+            }
+        }
+    }
+
+private:
+    Kind                mKind;              ///< Kind of the concrete store
+    bool                mbTrackChanges;     ///< Record Entities whose Component are added, removed or changed?
+    std::vector<Entity> mAddedEntities;     ///< Entities whose Component have been added
+    std::vector<Entity> mRemovedEntities;   ///< Entities whose Component have been removed
+    std::vector<Entity> mChangedEntities;   ///< Entities whose Component have been marked as changed
+    std::vector<ISecondaryIndex::Ptr> mSecondaryIndexes; ///< Secondary indexes, kept up to date by the changes
+    uint64_t            mVersion;           ///< Version of the content, changed by any modification
 };
 
 /**
@@ -38,6 +321,13 @@ public:
  *
  * @tparam C    A structure derived from Component, of a certain type of Component.
  *
+ *  Components are packed in a contiguous array, with the array of their Entities at the same indexes,
+ * and a hash map giving the index of the Component of each Entity. Removing a Component moves the last one
+ * in its place, so the order of Components changes; sortByEntity() restores the increasing order of Entities
+ * used by Join (new Entities being added in increasing order, they keep it).
+ *
+ *  Const methods can be called concurrently by any number of threads, as long as no thread modifies the store.
+ *
  * @todo Throw instead of returning false in case of error?
  */
 template<typename C>
@@ -47,10 +337,15 @@ class ComponentStore : public IComponentStore {
 
 public:
     /// Constructor.
-    ComponentStore() {
+    ComponentStore() :
+        IComponentStore(eTypedStore),
+        mComponents(),
+        mEntities(),
+        mIndexes(),
+        mbSorted(true) {
     }
     /// Destructor.
-    ~ComponentStore() {
+    virtual ~ComponentStore() {
     }
 
     /**
@@ -72,7 +367,15 @@ public:
      * @todo Throw in case of failure!
      */
     inline bool add(const Entity aEntity, C&& aComponent) {
-        return mStore.insert(std::make_pair(aEntity, std::move(aComponent))).second;
+        touch();
+        const bool bInserted = mIndexes.insert(std::make_pair(aEntity, mComponents.size())).second;
+        if (bInserted) {
+            mbSorted = mbSorted && (mEntities.empty() || (mEntities.back() < aEntity));
+            mEntities.push_back(aEntity);
+            mComponents.push_back(std::move(aComponent));
+            markAdded(aEntity);
+        }
+        return bInserted;
     }
 
     /**
@@ -82,8 +385,100 @@ public:
      *
      * @return true if finding and removing the Entity succeeded.
      */
-    inline bool remove(Entity aEntity) {
-        return (0 < mStore.erase(aEntity));
+    virtual bool remove(Entity aEntity) {
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return false;
+        }
+        erase(index);
+        markRemoved(aEntity);
+        return true;
+    }
+
+    /**
+     * @brief Move the Component associated to an Entity into another ComponentStore of the same type.
+     *
+     *  Throws std::runtime_error if the target store is not a ComponentStore of the same type.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to move.
+     * @param[in] aTargetStore  ComponentStore of the same type of Component, receiving the Component.
+     *
+     * @return true if finding and moving the Component succeeded.
+     */
+    virtual bool moveTo(Entity aEntity, IComponentStore& aTargetStore) {
+        if (!canMoveTo(aTargetStore)) {
+            throw std::runtime_error("The target store is not of the same type");
+        }
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return false;
+        }
+        bool bMoved = static_cast<ComponentStore<C>&>(aTargetStore).add(aEntity, std::move(mComponents[index->second]));
+        erase(index);
+        markRemoved(aEntity);
+        return bMoved;
+    }
+
+    /**
+     * @brief Test if another store is a ComponentStore of the same type, able to receive the Components of this one.
+     *
+     * @param[in] aTargetStore  Store registered under the same ComponentType in another Manager.
+     */
+    virtual bool canMoveTo(const IComponentStore& aTargetStore) const {
+        return (eTypedStore == aTargetStore.getKind()) &&
+               (nullptr != dynamic_cast<const ComponentStore<C>*>(&aTargetStore));
+    }
+
+    /**
+     * @brief Test if the Components can be copied by clone(): only copy constructible Components.
+     */
+    virtual bool isCopyable() const {
+        return std::is_copy_constructible<C>::value;
+    }
+
+    /**
+     * @brief Copy the Component associated to an Entity to a list of Entities (without any Component of this type).
+     *
+     *  The copies are appended at once at the end of the packed array (as a block copy for trivially copyable
+     * Components). Throws std::runtime_error if the Component is not copy constructible.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to copy (typically a prefab).
+     * @param[in] apEntities    List of Entities receiving a copy of the Component.
+     * @param[in] aNbEntities   Number of Entities in the list.
+     *
+     * @return Number of Components added.
+     */
+    virtual size_t clone(Entity aEntity, const Entity* apEntities, size_t aNbEntities) {
+        if (!isCopyable()) {
+            throw std::runtime_error("The Component is not copy constructible");
+        }
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return 0;
+        }
+        touch();
+        const size_t first = mComponents.size();
+        mIndexes.reserve(mIndexes.size() + aNbEntities);
+        for (size_t i = 0; i < aNbEntities; ++i) {
+            if (!mIndexes.insert(std::make_pair(apEntities[i], first + i)).second) {
+                // Rollback: only new Entities can receive a copy
+                for (size_t j = 0; j < i; ++j) {
+                    mIndexes.erase(apEntities[j]);
+                }
+                throw std::runtime_error("The Entity already has a Component of this type");
+            }
+        }
+        Entity previous = mEntities.empty() ? _invalidEntity : mEntities.back();
+        for (size_t i = 0; i < aNbEntities; ++i) {
+            mbSorted = mbSorted && (previous < apEntities[i]);
+            previous = apEntities[i];
+        }
+        mEntities.insert(mEntities.end(), apEntities, apEntities + aNbEntities);
+        copyComponent(index->second, aNbEntities, std::is_copy_constructible<C>());
+        for (size_t i = 0; i < aNbEntities; ++i) {
+            markAdded(apEntities[i]);
+        }
+        return aNbEntities;
     }
 
     /**
@@ -94,12 +489,16 @@ public:
      * @return true if finding the Entity and its associated Component succeeded.
      */
     inline bool has(Entity aEntity) const {
-        return (mStore.end() != mStore.find(aEntity));
+        return (mIndexes.end() != mIndexes.find(aEntity));
     }
 
     /**
      * @brief Get access to the Component associated with the specified Entity.
      *
+     *  Changes the version of the store, and marks the Entity dirty for the secondary indexes, since the Component
+     * can be modified through the reference: use read() to only read it, so that a Rollback does not copy the store
+     * again and the indexes are not refreshed.
+     *
      *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
      *
      * @param[in] aEntity   Id of the Entity to find.
@@ -107,7 +506,86 @@ public:
      * @return Reference to the Component associated with the specified Entity (or throws).
      */
     inline C& get(Entity aEntity) {
-        return mStore.at(aEntity);
+        touch();
+        C& component = mComponents[mIndexes.at(aEntity)];
+        markIndexesDirty(aEntity);
+        return component;
+    }
+
+    /**
+     * @brief Get read-only access to the Component associated with the specified Entity, from a non-const store.
+     *
+     *  Same as the const get(), leaving the version of the store unchanged.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return Const reference to the Component associated with the specified Entity (or throws).
+     */
+    inline const C& read(Entity aEntity) const {
+        return mComponents[mIndexes.at(aEntity)];
+    }
+
+    /**
+     * @brief Get access to the Component associated with the specified Entity, to modify it (marking it as changed).
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return Reference to the Component associated with the specified Entity (or throws).
+     */
+    inline C& modify(Entity aEntity) {
+        touch();
+        C& component = mComponents[mIndexes.at(aEntity)];
+        markChanged(aEntity);
+        return component;
+    }
+
+    /**
+     * @brief Get read-only access to the Component associated with the specified Entity.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return Const reference to the Component associated with the specified Entity (or throws).
+     */
+    inline const C& get(Entity aEntity) const {
+        return mComponents[mIndexes.at(aEntity)];
+    }
+
+    /**
+     * @brief Find the Component associated with the specified Entity, if any.
+     *
+     *  Used to access optional Components with only one lookup (instead of has() followed by get()).
+     * Like get(), marks the Entity dirty for the secondary indexes.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return Pointer to the Component associated with the specified Entity, or nullptr if not found.
+     */
+    inline C* find(Entity aEntity) {
+        touch();
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return nullptr;
+        }
+        markIndexesDirty(aEntity);
+        return &(mComponents[index->second]);
+    }
+
+    /**
+     * @brief Find read-only the Component associated with the specified Entity, if any.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return Const pointer to the Component associated with the specified Entity, or nullptr if not found.
+     */
+    inline const C* find(Entity aEntity) const {
+        auto index = mIndexes.find(aEntity);
+        return (mIndexes.end() != index) ? &(mComponents[index->second]) : nullptr;
     }
 
     /**
@@ -120,23 +598,234 @@ public:
      * @return The Component associated with the specified Entity (or throw).
      */
     inline C extract(Entity aEntity) {
-        C component = std::move(mStore.at(aEntity));
-        mStore.erase(aEntity);
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            throw std::out_of_range("The Entity has no Component of this type");
+        }
+        C component = std::move(mComponents[index->second]);
+        erase(index);
+        markRemoved(aEntity);
         return component;
     }
 
     /**
-     * @brief Get access to the underlying Component map.
+     * @brief Get the number of stored Components.
+     */
+    inline size_t size() const {
+        return mComponents.size();
+    }
+
+    /**
+     * @brief Get access to the underlying packed array of Components.
      *
-     * @return Reference to the underlying Component map.
+     * @return Reference to the packed array of Components, in the same order as getEntities().
      */
-    inline const std::unordered_map<Entity, C>& getComponents() {
-        return mStore;
+    inline const std::vector<C>& getComponents() const {
+        return mComponents;
+    }
+
+    /**
+     * @brief Get access to the underlying packed array of Entities.
+     *
+     * @return Reference to the packed array of Entities, in the same order as getComponents().
+     */
+    virtual const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Test if the packed arrays are sorted by increasing Entities.
+     */
+    virtual bool isSortedByEntity() const {
+        return mbSorted;
+    }
+
+    /**
+     * @brief Sort the packed arrays by increasing Entities (if not already sorted),
+     *        invalidating pointers to Components.
+     */
+    virtual void sortByEntity() {
+        if (!mbSorted) {
+            touch();
+            // Sort the indexes of the Components by Entity, then move the Components in this order
+            std::vector<size_t> order(mEntities.size());
+            for (size_t index = 0; index < order.size(); ++index) {
+                order[index] = index;
+            }
+            const std::vector<Entity>& entities = mEntities;
+            std::sort(order.begin(), order.end(), [&entities](size_t aIndex1, size_t aIndex2) {
+                return entities[aIndex1] < entities[aIndex2];
+            });
+            std::vector<C>      components;
+            std::vector<Entity> sortedEntities;
+            components.reserve(mComponents.size());
+            sortedEntities.reserve(mEntities.size());
+            for (size_t index = 0; index < order.size(); ++index) {
+                components.push_back(std::move(mComponents[order[index]]));
+                sortedEntities.push_back(mEntities[order[index]]);
+                mIndexes[sortedEntities.back()] = index;
+            }
+            mComponents.swap(components);
+            mEntities.swap(sortedEntities);
+            mbSorted = true;
+        }
+    }
+
+    /**
+     * @brief Get access to the Component at an index of the packed array (see Join).
+     *
+     *  Like get(), marks the Entity dirty for the secondary indexes.
+     *
+     * @param[in] aIndex    Index in the packed array, in [0; size()[.
+     */
+    inline C& getAt(size_t aIndex) {
+        touch();
+        markIndexesDirty(mEntities[aIndex]);
+        return mComponents[aIndex];
+    }
+    /**
+     * @brief Get read-only access to the Component at an index of the packed array (see Join).
+     *
+     * @param[in] aIndex    Index in the packed array, in [0; size()[.
+     */
+    inline const C& getAt(size_t aIndex) const {
+        return mComponents[aIndex];
+    }
+
+    /**
+     * @brief Add a hash index, finding the Entities whose Component has a key in constant time.
+     *
+     *  The index is kept up to date by the Components added, removed, or accessed to be modified (with modify(),
+     * get(), find() or getAt(), or marked with markChanged()): use read() or the const accessors to only read them.
+     *
+     * @tparam K    Type of the key, with a std::hash specialization and an operator==.
+     *
+     * @param[in] aKeyFunction  Function computing the key of a Component (typically reading one of its fields).
+     *
+     * @return Reference to the new index, owned by the store.
+     */
+    template<typename K>
+    HashIndex<C, K>& addHashIndex(typename HashIndex<C, K>::KeyFunction aKeyFunction) {
+        HashIndex<C, K>* pIndex = new HashIndex<C, K>(*this, std::move(aKeyFunction));
+        addIndex(ISecondaryIndex::Ptr(pIndex));
+        return *pIndex;
+    }
+
+    /**
+     * @brief Add a sorted index, finding the Entities whose Component has a key in a range in logarithmic time.
+     *
+     *  The index is kept up to date like a hash index (see addHashIndex()).
+     *
+     * @tparam K    Type of the key, with an operator<.
+     *
+     * @param[in] aKeyFunction  Function computing the key of a Component (typically reading one of its fields).
+     *
+     * @return Reference to the new index, owned by the store.
+     */
+    template<typename K>
+    SortedIndex<C, K>& addSortedIndex(typename SortedIndex<C, K>::KeyFunction aKeyFunction) {
+        SortedIndex<C, K>* pIndex = new SortedIndex<C, K>(*this, std::move(aKeyFunction));
+        addIndex(ISecondaryIndex::Ptr(pIndex));
+        return *pIndex;
+    }
+
+    /**
+     * @brief Reserve memory for a number of Components, so that adding them does not grow the packed arrays.
+     *
+     *  The hash map of indexes is also sized to avoid rehashing (each insertion still allocates a node).
+     *
+     * @param[in] aNbComponents Number of Components.
+     */
+    virtual void reserve(size_t aNbComponents) {
+        mComponents.reserve(aNbComponents);
+        mEntities.reserve(aNbComponents);
+        mIndexes.reserve(aNbComponents);
+        reserveChanges(aNbComponents);
+    }
+
+    /**
+     * @brief Create an empty State, to save the content of the store.
+     */
+    virtual IComponentStore::State::Ptr createState() const {
+        return IComponentStore::State::Ptr(new State());
+    }
+
+    /**
+     * @brief Save the content of the store (a block copy for trivially copyable Components).
+     *
+     *  Throws std::runtime_error if the Component is not copy assignable.
+     */
+    virtual void saveState(IComponentStore::State& aState) const {
+        copyState(mComponents, static_cast<State&>(aState).mComponents, std::is_copy_assignable<C>());
+        State& state = static_cast<State&>(aState);
+        state.mEntities = mEntities;
+        state.mIndexes = mIndexes;
+        state.mbSorted = mbSorted;
+    }
+
+    /**
+     * @brief Restore the content of the store from a saved State.
+     */
+    virtual void restoreState(const IComponentStore::State& aState) {
+        touch();
+        const State& state = static_cast<const State&>(aState);
+        copyState(state.mComponents, mComponents, std::is_copy_assignable<C>());
+        mEntities = state.mEntities;
+        mIndexes = state.mIndexes;
+        mbSorted = state.mbSorted;
+        markIndexesAllDirty();
     }
 
 private:
-    std::unordered_map<Entity, C>   mStore;             ///< Hash map of stored Components
-    static const ComponentType      _mType = C::_mType; ///< Type of stored Components
+    /// Saved content of the store.
+    class State : public IComponentStore::State {
+    public:
+        std::vector<C>                      mComponents;    ///< Packed array of stored Components
+        std::vector<Entity>                 mEntities;      ///< Entity of each stored Component
+        std::unordered_map<Entity, size_t>  mIndexes;       ///< Index of the Component of each Entity
+        bool                                mbSorted;       ///< Are the packed arrays sorted by Entity?
+    };
+
+    /// Copy a packed array of Components (copy assignable Component, reusing the capacity of the target).
+    static inline void copyState(const std::vector<C>& aSource, std::vector<C>& aTarget, std::true_type) {
+        aTarget = aSource;
+    }
+    /// Copy a packed array of Components (non copyable Component).
+    static inline void copyState(const std::vector<C>&, std::vector<C>&, std::false_type) {
+        throw std::runtime_error("The Component is not copy assignable");
+    }
+
+    /// Remove the Component at an index, moving the last one in its place.
+    inline void erase(typename std::unordered_map<Entity, size_t>::iterator aIndex) {
+        touch();
+        const size_t index = aIndex->second;
+        const size_t last = mComponents.size() - 1;
+        if (index != last) {
+            mbSorted = false;
+            mComponents[index] = std::move(mComponents[last]);
+            mEntities[index] = mEntities[last];
+            mIndexes[mEntities[index]] = index;
+        }
+        mComponents.pop_back();
+        mEntities.pop_back();
+        mIndexes.erase(aIndex);
+    }
+
+    /// Append copies of the Component at an index (copy constructible Component).
+    inline void copyComponent(size_t aIndex, size_t aNbCopies, std::true_type) {
+        mComponents.reserve(mComponents.size() + aNbCopies);
+        const C prototype = mComponents[aIndex]; // copy, since the array may be reallocated
+        mComponents.resize(mComponents.size() + aNbCopies, prototype);
+    }
+    /// Append copies of the Component at an index (non copyable Component: never called, see clone()).
+    inline void copyComponent(size_t, size_t, std::false_type) {
+    }
+
+    std::vector<C>                      mComponents;        ///< Packed array of stored Components
+    std::vector<Entity>                 mEntities;          ///< Entity of each stored Component
+    std::unordered_map<Entity, size_t>  mIndexes;           ///< Index of the Component of each Entity
+    bool                                mbSorted;           ///< Are the packed arrays sorted by Entity?
+    static const ComponentType          _mType = C::_mType; ///< Type of stored Components
 };
 
 } // namespace ecs
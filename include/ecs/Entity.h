@@ -10,6 +10,8 @@
  */
 #pragma once
 
+#include <cstdint>
+
 namespace ecs {
 
 /**
@@ -27,4 +29,99 @@ typedef unsigned int Entity;
  */
 static const Entity _invalidEntity = 0;
 
+/**
+ * @brief   Number of high order bits of an Entity Id holding the Id of the shard (Manager) that created it.
+ * @ingroup ecs
+ *
+ *  This keeps Entity Ids globally unique across all shards of a World, even when an Entity migrates between shards.
+ * Define ECS_ENTITY_SHARD_BITS to 0 for a single Manager (World of one shard).
+ */
+#ifndef ECS_ENTITY_SHARD_BITS
+#define ECS_ENTITY_SHARD_BITS 4
+#endif
+static const unsigned int _entityShardBits = ECS_ENTITY_SHARD_BITS;
+
+/**
+ * @brief   Number of bits of an Entity Id holding the generation of its index, between the shard and the index.
+ * @ingroup ecs
+ *
+ *  The index of a destroyed Entity is reused by a next one, with the next generation, so that the Id of the
+ * destroyed Entity stays invalid (until the generation wraps around, after 2^ECS_ENTITY_GENERATION_BITS reuses).
+ */
+#ifndef ECS_ENTITY_GENERATION_BITS
+#define ECS_ENTITY_GENERATION_BITS 8
+#endif
+static const unsigned int _entityGenerationBits = ECS_ENTITY_GENERATION_BITS;
+static_assert((_entityShardBits + _entityGenerationBits) < (sizeof(Entity) * 8),
+              "ECS_ENTITY_SHARD_BITS + ECS_ENTITY_GENERATION_BITS must be lower than the size of an Entity");
+
+/**
+ * @brief   Number of low order bits of an Entity Id holding its index in the shard that created it.
+ * @ingroup ecs
+ *
+ *  Each shard can have at most 2^_entityIndexBits - 1 Entities alive at once (a million by default).
+ */
+static const unsigned int _entityIndexBits = (sizeof(Entity) * 8) - _entityShardBits - _entityGenerationBits;
+
+/**
+ * @brief   Max index of an Entity in the shard that created it (max number of live Entities of a shard).
+ * @ingroup ecs
+ */
+static const Entity _maxEntityIndex = static_cast<Entity>((static_cast<uint64_t>(1) << _entityIndexBits) - 1);
+
+/**
+ * @brief   Max generation of the index of an Entity.
+ * @ingroup ecs
+ */
+static const Entity _maxEntityGeneration =
+    static_cast<Entity>((static_cast<uint64_t>(1) << _entityGenerationBits) - 1);
+
+/**
+ * @brief   Get the Id of the shard (Manager) that created an Entity.
+ * @ingroup ecs
+ *
+ * @param[in] aEntity   Id of the Entity.
+ *
+ * @return  Id of the shard that created the Entity (not necessarily the one currently holding it).
+ */
+inline unsigned int getEntityShard(const Entity aEntity) {
+    return static_cast<unsigned int>(static_cast<uint64_t>(aEntity) >> (_entityIndexBits + _entityGenerationBits));
+}
+
+/**
+ * @brief   Get the index of an Entity in the shard that created it.
+ * @ingroup ecs
+ */
+inline Entity getEntityIndex(const Entity aEntity) {
+    return (aEntity & _maxEntityIndex);
+}
+
+/**
+ * @brief   Get the generation of the index of an Entity.
+ * @ingroup ecs
+ */
+inline Entity getEntityGeneration(const Entity aEntity) {
+    return static_cast<Entity>((static_cast<uint64_t>(aEntity) >> _entityIndexBits) & _maxEntityGeneration);
+}
+
+/**
+ * @brief   Get the Id reusing the index of a destroyed Entity, with the next generation (wrapping around).
+ * @ingroup ecs
+ */
+inline Entity getNextGenerationEntity(const Entity aEntity) {
+    const Entity generation = (getEntityGeneration(aEntity) + 1) & _maxEntityGeneration;
+    return static_cast<Entity>((aEntity & ~(_maxEntityGeneration << _entityIndexBits)) |
+                               (generation << _entityIndexBits));
+}
+
+/**
+ * @brief   Get the Id of the first Entity of a shard, minus one (invalid Id 0 for the default shard).
+ * @ingroup ecs
+ *
+ * @param[in] aShardId  Id of the shard, lower than 2^_entityShardBits.
+ */
+inline Entity getShardBaseEntity(const unsigned int aShardId) {
+    return static_cast<Entity>(static_cast<uint64_t>(aShardId) << (_entityIndexBits + _entityGenerationBits));
+}
+
 } // namespace ecs
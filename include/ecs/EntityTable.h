@@ -0,0 +1,238 @@
+/**
+ * @file    EntityTable.h
+ * @ingroup ecs
+ * @brief   A ecs::EntityTable is a flat open-addressing table of records, indexed by ecs::Entity.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+
+#include <vector>
+#include <stdexcept>
+#include <cstddef>   // size_t
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A EntityTable is a flat open-addressing table of records, indexed by Entity.
+ * @ingroup ecs
+ *
+ *  Entity Ids are mixed by a multiplicative (Fibonacci) hash, and collisions are resolved by linear probing.
+ * Ids are allocated in increasing order, so using them as their own hash would fill long contiguous runs of slots,
+ * making each probe and each removal walk the whole run under churn. The slots only hold the Entity with the index
+ * of its record, and the records are packed in a contiguous array, so iterating all Entities is a linear scan
+ * and adding an Entity does not allocate (unless the arrays grow).
+ *
+ *  Removing an Entity moves the last record to its place: pointers to records are invalidated
+ * by any insertion or removal.
+ *
+ * @tparam R    Type of the record associated to each Entity.
+ */
+template<typename R>
+class EntityTable {
+public:
+    /// Constructor.
+    EntityTable() :
+        mSlots(),
+        mSlotShift(0),
+        mEntities(),
+        mRecords() {
+    }
+
+    /// Destructor.
+    ~EntityTable() {
+    }
+
+    /**
+     * @brief Get the record of an Entity.
+     *
+     * @param[in] aEntity   Entity to find.
+     *
+     * @return  Pointer to the record, or nullptr if the Entity is not in the table.
+     */
+    inline R* find(const Entity aEntity) {
+        if (mSlots.empty()) {
+            return nullptr;
+        }
+        const size_t slot = findSlot(aEntity);
+        return (_invalidEntity != mSlots[slot].mEntity) ? &mRecords[mSlots[slot].mIndex] : nullptr;
+    }
+    /// Get the record (read-only) of an Entity, or nullptr if the Entity is not in the table.
+    inline const R* find(const Entity aEntity) const {
+        if (mSlots.empty()) {
+            return nullptr;
+        }
+        const size_t slot = findSlot(aEntity);
+        return (_invalidEntity != mSlots[slot].mEntity) ? &mRecords[mSlots[slot].mIndex] : nullptr;
+    }
+
+    /**
+     * @brief Test if an Entity is in the table.
+     */
+    inline bool has(const Entity aEntity) const {
+        return (nullptr != find(aEntity));
+    }
+
+    /**
+     * @brief Insert the record of a new Entity.
+     *
+     *  Throws std::runtime_error if the Entity is invalid or already in the table.
+     *
+     * @param[in] aEntity   Entity to insert.
+     * @param[in] aRecord   Its record.
+     *
+     * @return  Reference to the record in the table (valid until the next insertion or removal).
+     */
+    R& insert(const Entity aEntity, const R& aRecord) {
+        if (_invalidEntity == aEntity) {
+            throw std::runtime_error("Invalid Entity");
+        }
+        // Keep the load factor under 3/4 so that probe sequences stay short
+        if (((mEntities.size() + 1) * 4) > (mSlots.size() * 3)) {
+            rehash((mSlots.size() < 16) ? 16 : (mSlots.size() * 2));
+        }
+        const size_t slot = findSlot(aEntity);
+        if (_invalidEntity != mSlots[slot].mEntity) {
+            throw std::runtime_error("The Entity already exists");
+        }
+        mEntities.push_back(aEntity);
+        mRecords.push_back(aRecord); // can throw std::bad_alloc
+        mSlots[slot].mEntity = aEntity;
+        mSlots[slot].mIndex = static_cast<uint32_t>(mRecords.size() - 1);
+        return mRecords.back();
+    }
+
+    /**
+     * @brief Remove an Entity with its record.
+     *
+     * @param[in] aEntity   Entity to remove.
+     *
+     * @return  true if the Entity has been removed (false if it was not in the table)
+     */
+    bool erase(const Entity aEntity) {
+        if (mSlots.empty()) {
+            return false;
+        }
+        size_t slot = findSlot(aEntity);
+        if (_invalidEntity == mSlots[slot].mEntity) {
+            return false;
+        }
+
+        // Move the last record in place of the removed one
+        const size_t index = mSlots[slot].mIndex;
+        const size_t last = mRecords.size() - 1;
+        if (index != last) {
+            mEntities[index] = mEntities[last];
+            mRecords[index] = mRecords[last];
+            mSlots[findSlot(mEntities[index])].mIndex = static_cast<uint32_t>(index);
+        }
+        mEntities.pop_back();
+        mRecords.pop_back();
+
+        // Shift back the following slots of the probe sequence, so that no tombstone is needed
+        const size_t mask = mSlots.size() - 1;
+        for (size_t next = (slot + 1) & mask; _invalidEntity != mSlots[next].mEntity; next = (next + 1) & mask) {
+            const size_t home = getHomeSlot(mSlots[next].mEntity);
+            // Move the slot back unless its home is cyclically in ]slot; next]
+            const bool bInPlace = (slot <= next) ? ((slot < home) && (home <= next))
+                                                 : ((slot < home) || (home <= next));
+            if (!bInPlace) {
+                mSlots[slot] = mSlots[next];
+                slot = next;
+            }
+        }
+        mSlots[slot].mEntity = _invalidEntity;
+
+        return true;
+    }
+
+    /**
+     * @brief Reserve memory for a number of Entities, so that inserting them does not allocate.
+     */
+    void reserve(size_t aNbEntities) {
+        size_t nbSlots = (mSlots.size() < 16) ? 16 : mSlots.size();
+        while ((aNbEntities * 4) > (nbSlots * 3)) {
+            nbSlots *= 2;
+        }
+        if (nbSlots != mSlots.size()) {
+            rehash(nbSlots);
+        }
+        mEntities.reserve(aNbEntities);
+        mRecords.reserve(aNbEntities);
+    }
+
+    /**
+     * @brief Get the number of Entities in the table.
+     */
+    inline size_t size() const {
+        return mEntities.size();
+    }
+
+    /**
+     * @brief Get the packed array of all Entities, in no particular order (matching the records of getAt()).
+     */
+    inline const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Get the record at an index of the packed array, in [0; size()[.
+     */
+    inline R& getAt(size_t aIndex) {
+        return mRecords[aIndex];
+    }
+    /// Get the record (read-only) at an index of the packed array, in [0; size()[.
+    inline const R& getAt(size_t aIndex) const {
+        return mRecords[aIndex];
+    }
+
+private:
+    /// An Entity with the index of its record, or an empty slot (_invalidEntity).
+    struct Slot {
+        Entity      mEntity;    ///< Entity, or _invalidEntity for an empty slot
+        uint32_t    mIndex;     ///< Index of its record
+    };
+
+    /// Get the preferred slot of an Entity: the high order bits of its Id multiplied by 2^32 / golden ratio.
+    inline size_t getHomeSlot(const Entity aEntity) const {
+        return static_cast<size_t>((static_cast<uint32_t>(aEntity) * UINT32_C(2654435769)) >> mSlotShift);
+    }
+
+    /// Find the slot of an Entity, or the empty slot where it would be inserted (there shall be some slots).
+    inline size_t findSlot(const Entity aEntity) const {
+        const size_t mask = mSlots.size() - 1;
+        size_t slot = getHomeSlot(aEntity);
+        while ((_invalidEntity != mSlots[slot].mEntity) && (aEntity != mSlots[slot].mEntity)) {
+            slot = (slot + 1) & mask;
+        }
+        return slot;
+    }
+
+    /// Rebuild the slots with a new number of slots (a power of two).
+    void rehash(size_t aNbSlots) {
+        const Slot empty = {_invalidEntity, 0};
+        mSlots.assign(aNbSlots, empty);
+        mSlotShift = 32;
+        for (size_t nbSlots = aNbSlots; 1 < nbSlots; nbSlots /= 2) {
+            --mSlotShift;
+        }
+        for (size_t index = 0; index < mEntities.size(); ++index) {
+            const size_t slot = findSlot(mEntities[index]);
+            mSlots[slot].mEntity = mEntities[index];
+            mSlots[slot].mIndex = static_cast<uint32_t>(index);
+        }
+    }
+
+    std::vector<Slot>   mSlots;     ///< Open-addressing slots (a power of two), using linear probing
+    unsigned int        mSlotShift; ///< Shift of a hash to keep log2(number of slots) bits
+    std::vector<Entity> mEntities;  ///< Packed array of all Entities
+    std::vector<R>      mRecords;   ///< Packed array of their records, at the same index
+};
+
+} // namespace ecs
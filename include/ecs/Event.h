@@ -0,0 +1,41 @@
+/**
+ * @file    Event.h
+ * @ingroup ecs
+ * @brief   A ecs::Event is a message sent by an ecs::System to other Systems, valid for one frame.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+namespace ecs {
+
+/**
+ * @brief   An EventType is a positive Id referencing a type of Event.
+ * @ingroup ecs
+ */
+typedef unsigned int EventType;
+
+/**
+ * @brief   EventType are strictly positive Ids.
+ * @ingroup ecs
+ */
+static const EventType _invalidEventType = 0;
+
+/**
+ * @brief   An Event is a message sent by a System to other Systems, valid for one frame.
+ * @ingroup ecs
+ *
+ *  Events are stored in a per-frame arena, and cleared all at once without calling any destructor:
+ * they shall be trivially destructible (plain data, like Entity Ids and values).
+ *
+ *  Every Event class must derived from this struct and define its own/unique positive #EventType.
+ */
+struct Event {
+    /// Default invalid event type
+    static const EventType _mType = _invalidEventType;
+};
+
+} // namespace ecs
@@ -0,0 +1,292 @@
+/**
+ * @file    EventBus.h
+ * @ingroup ecs
+ * @brief   A ecs::EventBus holds typed ecs::EventChannel, sending ecs::Event between ecs::System for one frame.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Event.h>
+#include <ecs/FrameArena.h>
+
+#include <map>
+#include <vector>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <stdexcept>
+
+namespace ecs {
+
+class EventBus;
+
+/**
+ * @brief   Abstract base class for all templated EventChannel.
+ * @ingroup ecs
+ */
+class IEventChannel {
+public:
+    /// Unique pointer to an EventChannel
+    typedef std::unique_ptr<IEventChannel> Ptr;
+
+    /// Virtual destructor, required to destroy an EventChannel through its unique pointer.
+    virtual ~IEventChannel() {
+    }
+};
+
+/**
+ * @brief   An EventChannel holds all Events of a certain type emitted during the current frame.
+ * @ingroup ecs
+ *
+ *  Events are emitted into batches, one list of batches per slot (typically one slot per thread),
+ * allocated from the FrameArena of the slot: emitting an Event does not allocate from the heap nor call
+ * any virtual method. All Events are cleared at once, in O(1), by EventBus::clear().
+ *
+ *  Different threads can emit concurrently into different slots; Events are read after a sync point.
+ *
+ * @tparam E    A structure derived from Event, of a certain type of Event.
+ */
+template<typename E>
+class EventChannel : public IEventChannel {
+    static_assert(std::is_base_of<Event, E>::value, "E must derived from the Event struct");
+    static_assert(E::_mType != _invalidEventType, "E must define a valid non-zero _mType");
+    static_assert(std::is_trivially_destructible<E>::value, "E must be trivially destructible");
+
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aEventBus Reference to the EventBus providing the frame arenas of all slots.
+     */
+    explicit EventChannel(EventBus& aEventBus);
+
+    /// Destructor.
+    virtual ~EventChannel() {
+    }
+
+    /**
+     * @brief Emit (copy) an Event into a slot.
+     *
+     * @param[in] aSlot     Index of the slot (of the thread) emitting the Event.
+     * @param[in] aEvent    Event to emit.
+     */
+    inline void emit(size_t aSlot, const E& aEvent);
+
+    /**
+     * @brief Emit (copy) an Event into the first slot.
+     *
+     * @param[in] aEvent    Event to emit.
+     */
+    inline void emit(const E& aEvent) {
+        emit(0, aEvent);
+    }
+
+    /**
+     * @brief Call a function for each Event emitted during the current frame, in order of slot then of emission.
+     *
+     * @tparam F    Type of the function, or functor, taking a 'const E&' parameter.
+     *
+     * @param[in] aFunction Function called for each Event.
+     */
+    template<typename F>
+    inline void forEach(F aFunction) const;
+
+    /**
+     * @brief Get the number of Events emitted during the current frame.
+     */
+    inline size_t size() const;
+
+private:
+    /// A batch of Events, allocated from the FrameArena of a slot.
+    struct Batch {
+        Batch*  mpNext;     ///< Next batch of the slot
+        E*      mpEvents;   ///< Events of the batch
+        size_t  mNbEvents;  ///< Number of Events in the batch
+        size_t  mCapacity;  ///< Max number of Events in the batch
+    };
+
+    /// The list of batches of a slot.
+    struct Slot {
+        Batch*          mpFirst;    ///< First batch of the slot, or nullptr
+        Batch*          mpLast;     ///< Last batch of the slot, or nullptr
+        unsigned int    mFrame;     ///< Frame of the batches (the slot is empty if it is not the current frame)
+    };
+
+    /// Allocate a new batch for a slot, from the FrameArena of the slot.
+    inline void addBatch(size_t aSlot, Slot& aSlotBatches);
+
+    EventBus&           mEventBus;  ///< EventBus providing the frame arenas, and the current frame
+    std::vector<Slot>   mSlots;     ///< Batches of Events of each slot
+};
+
+/**
+ * @brief   An EventBus holds typed EventChannels, sending Events between Systems for one frame.
+ * @ingroup ecs
+ *
+ *  EventChannels are created at init (like ComponentStores), and Systems can keep a reference to them.
+ * All Events are cleared at once, in O(1), by clear() (at the beginning of each Manager::updateFrame()).
+ */
+class EventBus {
+public:
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aNbSlots  Number of slots, each one with its own FrameArena (typically one per thread).
+     */
+    explicit EventBus(size_t aNbSlots = 1);
+
+    /// Destructor.
+    ~EventBus();
+
+    /**
+     * @brief Change the number of slots (only before any EventChannel is created).
+     *
+     * @param[in] aNbSlots  Number of slots, each one with its own FrameArena (typically one per thread).
+     */
+    void setNbSlots(size_t aNbSlots);
+
+    /// Get the number of slots.
+    inline size_t getNbSlots() const {
+        return mArenas.size();
+    }
+
+    /// Get the FrameArena of a slot.
+    inline FrameArena& getArena(size_t aSlot) {
+        return *(mArenas[aSlot]);
+    }
+
+    /// Get the current frame, incremented by each clear().
+    inline unsigned int getFrame() const {
+        return mFrame;
+    }
+
+    /**
+     * @brief Clear all Events of all EventChannels at once, in O(1) (sync point).
+     */
+    void clear();
+
+    /**
+     * @brief Create an EventChannel for a certain type of Event.
+     *
+     * @tparam E    A structure derived from Event, of a certain type of Event.
+     *
+     * @return true if the EventChannel has been created (false if it already exists).
+     */
+    template<typename E>
+    inline bool createChannel() {
+        return mChannels.insert(std::make_pair(E::_mType, IEventChannel::Ptr(new EventChannel<E>(*this)))).second;
+    }
+
+    /**
+     * @brief Get (access to) the EventChannel of a certain type of Event.
+     *
+     *  Throws std::runtime_error if the EventChannel does not exist.
+     *
+     * @tparam E    A structure derived from Event, of a certain type of Event.
+     *
+     * @return      Reference to the EventChannel of the specified type (or throws).
+     */
+    template<typename E>
+    inline EventChannel<E>& getChannel() {
+        auto iChannel = mChannels.find(E::_mType);
+        if (mChannels.end() == iChannel) {
+            throw std::runtime_error("The EventChannel does not exist");
+        }
+        return static_cast<EventChannel<E>&>(*(iChannel->second));
+    }
+
+private:
+    /// Non copyable
+    EventBus(const EventBus&);
+    /// Non copyable
+    EventBus& operator=(const EventBus&);
+
+    std::vector<std::unique_ptr<FrameArena> >   mArenas;    ///< FrameArena of each slot
+    std::map<EventType, IEventChannel::Ptr>     mChannels;  ///< EventChannels by type of Event
+    unsigned int                                mFrame;     ///< Current frame, incremented by each clear()
+};
+
+
+template<typename E>
+EventChannel<E>::EventChannel(EventBus& aEventBus) :
+    mEventBus(aEventBus),
+    mSlots(aEventBus.getNbSlots()) {
+    for (auto slot  = mSlots.begin();
+              slot != mSlots.end();
+            ++slot) {
+        slot->mpFirst = nullptr;
+        slot->mpLast = nullptr;
+        slot->mFrame = aEventBus.getFrame();
+    }
+}
+
+template<typename E>
+inline void EventChannel<E>::emit(size_t aSlot, const E& aEvent) {
+    Slot& slot = mSlots[aSlot];
+    // Lazily forget the batches of previous frames
+    if (slot.mFrame != mEventBus.getFrame()) {
+        slot.mpFirst = nullptr;
+        slot.mpLast = nullptr;
+        slot.mFrame = mEventBus.getFrame();
+    }
+    if ((nullptr == slot.mpLast) || (slot.mpLast->mNbEvents == slot.mpLast->mCapacity)) {
+        addBatch(aSlot, slot);
+    }
+    new(&(slot.mpLast->mpEvents[slot.mpLast->mNbEvents])) E(aEvent);
+    ++(slot.mpLast->mNbEvents);
+}
+
+template<typename E>
+template<typename F>
+inline void EventChannel<E>::forEach(F aFunction) const {
+    for (auto slot  = mSlots.begin();
+              slot != mSlots.end();
+            ++slot) {
+        if (slot->mFrame == mEventBus.getFrame()) {
+            for (const Batch* pBatch = slot->mpFirst; nullptr != pBatch; pBatch = pBatch->mpNext) {
+                for (size_t event = 0; event < pBatch->mNbEvents; ++event) {
+                    aFunction(static_cast<const E&>(pBatch->mpEvents[event]));
+                }
+            }
+        }
+    }
+}
+
+template<typename E>
+inline size_t EventChannel<E>::size() const {
+    size_t nbEvents = 0;
+    for (auto slot  = mSlots.begin();
+              slot != mSlots.end();
+            ++slot) {
+        if (slot->mFrame == mEventBus.getFrame()) {
+            for (const Batch* pBatch = slot->mpFirst; nullptr != pBatch; pBatch = pBatch->mpNext) {
+                nbEvents += pBatch->mNbEvents;
+            }
+        }
+    }
+    return nbEvents;
+}
+
+template<typename E>
+inline void EventChannel<E>::addBatch(size_t aSlot, Slot& aSlotBatches) {
+    // Double the capacity of each new batch of the frame, starting with 64 Events
+    const size_t capacity = (nullptr != aSlotBatches.mpLast) ? (2 * aSlotBatches.mpLast->mCapacity) : 64;
+    FrameArena& arena = mEventBus.getArena(aSlot);
+    Batch* pBatch = static_cast<Batch*>(arena.allocate(sizeof(Batch), std::alignment_of<Batch>::value));
+    pBatch->mpNext = nullptr;
+    pBatch->mpEvents = static_cast<E*>(arena.allocate(capacity * sizeof(E), std::alignment_of<E>::value));
+    pBatch->mNbEvents = 0;
+    pBatch->mCapacity = capacity;
+    if (nullptr != aSlotBatches.mpLast) {
+        aSlotBatches.mpLast->mpNext = pBatch;
+    } else {
+        aSlotBatches.mpFirst = pBatch;
+    }
+    aSlotBatches.mpLast = pBatch;
+}
+
+} // namespace ecs
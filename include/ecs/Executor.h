@@ -0,0 +1,93 @@
+/**
+ * @file    Executor.h
+ * @ingroup ecs
+ * @brief   A ecs::Executor runs asynchronous work on a pool of threads, returning futures.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <type_traits>
+
+namespace ecs {
+
+/**
+ * @brief   An Executor runs asynchronous work on a pool of threads, returning futures.
+ * @ingroup ecs
+ *
+ *  Work is run in order of submission by the first available thread. Blocking work (I/O, requests to a
+ * service) is run here instead of inside a System, so that it overlaps with the simulation (see AsyncSystem).
+ *
+ *  submit() can be called by any thread. The destructor runs all work already submitted before joining
+ * the threads, so that all futures are eventually ready.
+ */
+class Executor {
+public:
+    /**
+     * @brief Constructor, starting the threads.
+     *
+     * @param[in] aNbThreads    Number of threads (at least one).
+     */
+    explicit Executor(size_t aNbThreads = 1);
+
+    /// Destructor, running all submitted work, then joining the threads.
+    ~Executor();
+
+    /// Get the number of threads.
+    inline size_t getNbThreads() const {
+        return mThreads.size();
+    }
+
+    /**
+     * @brief Submit work to be run on a thread of the pool.
+     *
+     * @tparam F    Type of the function, or functor, without parameter (copied or moved to the thread).
+     *
+     * @param[in] aFunction Work to run.
+     *
+     * @return  Future of the result of the function (or of the exception it has thrown).
+     */
+    template<typename F>
+    std::future<typename std::result_of<F()>::type> submit(F&& aFunction) {
+        typedef typename std::result_of<F()>::type R;
+        // A std::function shall be copyable: share the move-only packaged_task
+        std::shared_ptr<std::packaged_task<R()> > task(new std::packaged_task<R()>(std::forward<F>(aFunction)));
+        std::future<R> future = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mTasks.push_back([task]() {
+                (*task)();
+            });
+        }
+        mCondition.notify_one();
+        return future;
+    }
+
+private:
+    /// Non copyable
+    Executor(const Executor&);
+    /// Non copyable
+    Executor& operator=(const Executor&);
+
+    /// Loop of the threads.
+    void run();
+
+    std::vector<std::thread>            mThreads;       ///< Threads of the pool
+    std::mutex                          mMutex;         ///< Protects all following members
+    std::condition_variable             mCondition;     ///< Signals new work, or stopping
+    bool                                mbStopping;     ///< Are the threads stopping (once all work is done)?
+    std::deque<std::function<void()> >  mTasks;         ///< Submitted work, in order
+};
+
+} // namespace ecs
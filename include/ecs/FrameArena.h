@@ -0,0 +1,82 @@
+/**
+ * @file    FrameArena.h
+ * @ingroup ecs
+ * @brief   A ecs::FrameArena is a bump allocator for data valid for one frame.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace ecs {
+
+/**
+ * @brief   A FrameArena is a bump allocator for data valid for one frame.
+ * @ingroup ecs
+ *
+ *  Memory is allocated by blocks, which are kept from one frame to the next, so that once warmed up
+ * a frame does not allocate anything from the heap. All allocations are released at once in O(1) by reset(),
+ * without calling any destructor.
+ *
+ *  Not thread-safe: use one arena per thread.
+ */
+class FrameArena {
+public:
+    /**
+     * @brief Constructor (does not allocate anything).
+     *
+     * @param[in] aBlockSize    Size of the blocks of memory allocated from the heap, in bytes.
+     */
+    explicit FrameArena(size_t aBlockSize = 64 * 1024);
+
+    /// Destructor, releasing all blocks of memory.
+    ~FrameArena();
+
+    /**
+     * @brief Allocate some memory, valid until the next reset().
+     *
+     * @param[in] aSize         Size of the memory to allocate, in bytes.
+     * @param[in] aAlignment    Alignment of the memory to allocate (power of two).
+     *
+     * @return Pointer to the allocated memory (throws std::bad_alloc on failure).
+     */
+    void* allocate(size_t aSize, size_t aAlignment);
+
+    /**
+     * @brief Release all allocations at once in O(1), keeping the blocks of memory for the next frame.
+     */
+    inline void reset() {
+        mCurrentBlock = 0;
+        mOffset = 0;
+    }
+
+    /**
+     * @brief Get the total size of the blocks of memory allocated from the heap, in bytes.
+     */
+    size_t getCapacity() const;
+
+private:
+    /// Non copyable
+    FrameArena(const FrameArena&);
+    /// Non copyable
+    FrameArena& operator=(const FrameArena&);
+
+    /// A block of memory allocated from the heap.
+    struct Block {
+        char*   mpData; ///< Start of the block
+        size_t  mSize;  ///< Size of the block, in bytes
+    };
+
+    size_t              mBlockSize;     ///< Default size of the blocks of memory, in bytes
+    std::vector<Block>  mBlocks;        ///< All blocks of memory, kept from one frame to the next
+    size_t              mCurrentBlock;  ///< Index of the block currently used for allocations
+    size_t              mOffset;        ///< Offset of the first free byte in the current block
+};
+
+} // namespace ecs
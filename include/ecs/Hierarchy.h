@@ -0,0 +1,278 @@
+/**
+ * @file    Hierarchy.h
+ * @ingroup ecs
+ * @brief   A ecs::Hierarchy links parent and children ecs::Entity, stored by depth level.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+
+#include <vector>
+#include <unordered_map>
+#include <cstddef>   // size_t
+
+namespace ecs {
+
+template<typename C>
+class ComponentStore;
+
+/**
+ * @brief   A Hierarchy links parent and children Entities, stored by depth level.
+ * @ingroup ecs
+ *
+ *  Each Entity of the Hierarchy has a parent (or none for a root), a first child and a next sibling.
+ * The Entities are also stored in one contiguous array per depth level, each with its parent, so that
+ * propagating values from parents to children (like local-to-world transforms) is a linear pass over
+ * the levels, where all Entities of a same level are independent and can be processed in parallel.
+ *
+ *  Attaching, detaching or removing an Entity only moves the Entities of its own subtree.
+ */
+class Hierarchy {
+public:
+    /**
+     * @brief An Entity with its parent, as stored in the array of its depth level.
+     */
+    struct Link {
+        Entity  mEntity;    ///< The Entity
+        Entity  mParent;    ///< Its parent, or _invalidEntity for a root
+    };
+
+    /// Constructor.
+    Hierarchy();
+
+    /// Destructor.
+    ~Hierarchy();
+
+    /**
+     * @brief Attach an Entity (with its subtree) as the first child of a parent Entity.
+     *
+     *  Any Entity not yet in the Hierarchy is added to it, the parent as a root.
+     * The Entity is first detached from its previous parent if any.
+     *
+     *  Throws std::runtime_error if the parent is the Entity itself or one of its descendants.
+     *
+     * @param[in] aEntity   Entity to attach.
+     * @param[in] aParent   New parent of the Entity.
+     */
+    void attach(const Entity aEntity, const Entity aParent);
+
+    /**
+     * @brief Detach an Entity (with its subtree) from its parent, making it a root.
+     *
+     *  Throws std::runtime_error if the Entity is not in the Hierarchy.
+     *
+     * @param[in] aEntity   Entity to detach.
+     */
+    void detach(const Entity aEntity);
+
+    /**
+     * @brief Remove an Entity from the Hierarchy, its children becoming roots.
+     *
+     * @param[in] aEntity   Entity to remove.
+     *
+     * @return true if the Entity has been removed (false if it was not in the Hierarchy)
+     */
+    bool remove(const Entity aEntity);
+
+    /**
+     * @brief Remove an Entity with its whole subtree from the Hierarchy.
+     *
+     * @param[in]  aEntity          Root of the subtree to remove.
+     * @param[out] aRemovedEntities List of removed Entities, appended in depth order (the Entity itself first).
+     *
+     * @return  Number of Entities removed.
+     */
+    size_t removeSubtree(const Entity aEntity, std::vector<Entity>& aRemovedEntities);
+
+    /**
+     * @brief Test if an Entity is in the Hierarchy.
+     */
+    inline bool has(const Entity aEntity) const {
+        return (mNodes.end() != mNodes.find(aEntity));
+    }
+
+    /**
+     * @brief Get the number of Entities in the Hierarchy.
+     */
+    inline size_t size() const {
+        return mNodes.size();
+    }
+
+    /**
+     * @brief Get the parent of an Entity, or _invalidEntity for a root (or an Entity not in the Hierarchy).
+     */
+    inline Entity getParent(const Entity aEntity) const {
+        auto node = mNodes.find(aEntity);
+        return (mNodes.end() != node) ? node->second.mParent : _invalidEntity;
+    }
+
+    /**
+     * @brief Get the first child of an Entity, or _invalidEntity.
+     */
+    inline Entity getFirstChild(const Entity aEntity) const {
+        auto node = mNodes.find(aEntity);
+        return (mNodes.end() != node) ? node->second.mFirstChild : _invalidEntity;
+    }
+
+    /**
+     * @brief Get the next sibling of an Entity, or _invalidEntity.
+     */
+    inline Entity getNextSibling(const Entity aEntity) const {
+        auto node = mNodes.find(aEntity);
+        return (mNodes.end() != node) ? node->second.mNextSibling : _invalidEntity;
+    }
+
+    /**
+     * @brief Get the depth of an Entity (0 for a root).
+     *
+     *  Throws std::runtime_error if the Entity is not in the Hierarchy.
+     */
+    size_t getDepth(const Entity aEntity) const;
+
+    /**
+     * @brief Get the number of depth levels.
+     */
+    inline size_t getNbLevels() const {
+        return mLevels.size();
+    }
+
+    /**
+     * @brief Get all Entities of a depth level, with their parent, in no particular order.
+     *
+     * @param[in] aDepth    Depth of the level, in [0; getNbLevels()[.
+     */
+    inline const std::vector<Link>& getLevel(size_t aDepth) const {
+        return mLevels.at(aDepth);
+    }
+
+    /**
+     * @brief Call a function for each child Entity with its parent, level by level (parents before children).
+     *
+     *  All the calls of a same level are independent, and could be split between threads
+     * (see getLevel()), as long as each level is done before the next one.
+     *
+     *  Only the Entities are known: the function has to look up the values of the Entity and of its parent
+     * (for Components, see the overload taking their ComponentStore).
+     *
+     * @tparam F    Type of the function, or functor, taking an 'Entity aEntity, Entity aParent' parameters.
+     *
+     * @param[in] aFunction Function called for each child Entity.
+     *
+     * @return  Number of Entities processed.
+     */
+    template<typename F>
+    inline size_t propagate(F aFunction) const {
+        size_t nbEntities = 0;
+        for (size_t depth = 1; depth < mLevels.size(); ++depth) {
+            const std::vector<Link>& level = mLevels[depth];
+            for (auto link  = level.begin();
+                      link != level.end();
+                    ++link) {
+                aFunction(link->mEntity, link->mParent);
+            }
+            nbEntities += level.size();
+        }
+        return nbEntities;
+    }
+
+    /**
+     * @brief Call a function for each child Entity with the Component of its parent, level by level.
+     *
+     *  See propagateLevel(): each Entity costs two lookups in the store, one for itself and one for its parent.
+     *
+     * @tparam C    A structure derived from Component, of a certain type of Component (like a transform).
+     * @tparam F    Type of the function, or functor, taking a 'C& aComponent, const C& aParentComponent' parameters.
+     *
+     * @param[in] aStore    ComponentStore of the Components to propagate.
+     * @param[in] aFunction Function called for each child Entity.
+     *
+     * @return  Number of Entities processed.
+     */
+    template<typename C, typename F>
+    inline size_t propagate(ComponentStore<C>& aStore, F aFunction) const {
+        size_t nbEntities = 0;
+        for (size_t depth = 1; depth < mLevels.size(); ++depth) {
+            nbEntities += propagateLevel(depth, aStore, aFunction);
+        }
+        return nbEntities;
+    }
+
+    /**
+     * @brief Call a function for each child Entity of a depth level, with the Component of its parent.
+     *
+     *  The Hierarchy does not know where the Components are in the packed arrays of the store (they move when
+     * Components are added or removed), so each Entity costs two hash lookups, one for itself and one for
+     * its parent. Entities without a Component in the store, or whose parent has none, are skipped.
+     *
+     *  Levels shall be processed in increasing order of depth.
+     *
+     * @tparam C    A structure derived from Component, of a certain type of Component (like a transform).
+     * @tparam F    Type of the function, or functor, taking a 'C& aComponent, const C& aParentComponent' parameters.
+     *
+     * @param[in] aDepth    Depth of the level, in [1; getNbLevels()[.
+     * @param[in] aStore    ComponentStore of the Components to propagate.
+     * @param[in] aFunction Function called for each child Entity.
+     *
+     * @return  Number of Entities processed.
+     */
+    template<typename C, typename F>
+    inline size_t propagateLevel(size_t aDepth, ComponentStore<C>& aStore, F aFunction) const {
+        size_t nbEntities = 0;
+        const ComponentStore<C>& parentStore = aStore;
+        const std::vector<Link>& level = mLevels.at(aDepth);
+        for (auto link  = level.begin();
+                  link != level.end();
+                ++link) {
+            const C* pParentComponent = parentStore.find(link->mParent);
+            if (nullptr != pParentComponent) {
+                C* pComponent = aStore.find(link->mEntity);
+                if (nullptr != pComponent) {
+                    aFunction(*pComponent, *pParentComponent);
+                    ++nbEntities;
+                }
+            }
+        }
+        return nbEntities;
+    }
+
+private:
+    /// Non copyable
+    Hierarchy(const Hierarchy&);
+    /// Non copyable
+    Hierarchy& operator=(const Hierarchy&);
+
+    /// The relationships of an Entity, with its location in the array of its level.
+    struct Node {
+        Entity  mParent;        ///< Parent, or _invalidEntity for a root
+        Entity  mFirstChild;    ///< First child, or _invalidEntity
+        Entity  mPrevSibling;   ///< Previous sibling, or _invalidEntity
+        Entity  mNextSibling;   ///< Next sibling, or _invalidEntity
+        size_t  mDepth;         ///< Depth level (0 for a root)
+        size_t  mIndex;         ///< Index in the array of the depth level
+    };
+
+    /// Get the Node of an Entity, adding it as a root if needed.
+    Node& getOrAddNode(const Entity aEntity);
+
+    /// Unlink an Entity from its parent and siblings (without changing its depth).
+    void unlink(Node& aNode);
+
+    /// Move an Entity with its whole subtree to a new depth level.
+    void moveSubtree(const Entity aEntity, Node& aNode, size_t aDepth);
+
+    /// Remove an Entity from the array of its level (swap with the last one).
+    void removeFromLevel(const Node& aNode);
+
+    /// Add an Entity at the end of the array of a level.
+    void addToLevel(const Entity aEntity, Node& aNode, size_t aDepth);
+
+    std::unordered_map<Entity, Node>    mNodes;     ///< Relationships of all Entities of the Hierarchy
+    std::vector<std::vector<Link> >     mLevels;    ///< Entities with their parent, by depth level
+};
+
+} // namespace ecs
@@ -0,0 +1,142 @@
+/**
+ * @file    Join.h
+ * @ingroup ecs
+ * @brief   A ecs::Join intersects the packed ecs::Entity arrays of several ecs::ComponentStore.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/ComponentStore.h>
+
+#include <vector>
+#include <cstddef>   // size_t
+
+namespace ecs {
+
+/**
+ * @brief   Intersect two arrays of strictly increasing Entities.
+ * @ingroup ecs
+ *
+ *  Uses a galloping (exponential) search of the Entities of the smallest array into the biggest one
+ * when their sizes differ a lot, else a linear merge comparing blocks of 4 Entities with SSE2 (when available).
+ *
+ * @param[in]  apEntities1  First array of strictly increasing Entities.
+ * @param[in]  aSize1       Number of Entities of the first array.
+ * @param[in]  apEntities2  Second array of strictly increasing Entities.
+ * @param[in]  aSize2       Number of Entities of the second array.
+ * @param[out] aIndexes1    Indexes in the first array of the common Entities (appended, in increasing order).
+ * @param[out] aIndexes2    Indexes in the second array of the common Entities (appended, in increasing order).
+ *
+ * @return  Number of common Entities.
+ */
+size_t intersectEntities(const Entity* apEntities1, size_t aSize1,
+                         const Entity* apEntities2, size_t aSize2,
+                         std::vector<size_t>& aIndexes1, std::vector<size_t>& aIndexes2);
+
+/**
+ * @brief   A Join intersects the packed Entity arrays of several ComponentStores, giving the Entities having
+ *          a Component in each store, with the index of their Component in each packed array.
+ * @ingroup ecs
+ *
+ *  The stores are first sorted by Entity (see ComponentStore::sortByEntity(), usually already done), then
+ * intersected from the smallest to the biggest, so the cost is driven by the smallest store.
+ * The result is a list of rows (one per Entity, in increasing order) holding one index per store,
+ * in the order of the stores given to compute(); it is valid until the stores are modified.
+ *
+ *  A Join reuses its buffers: keep it across frames to avoid any allocation.
+ */
+class Join {
+public:
+    /// Constructor.
+    Join();
+
+    /// Destructor.
+    ~Join();
+
+    /**
+     * @brief Compute the Entities having a Component in each ComponentStore.
+     *
+     * @param[in] apStores  Array of pointers to the ComponentStores to join.
+     * @param[in] aNbStores Number of ComponentStores.
+     *
+     * @return  Number of Entities (rows) of the result.
+     */
+    size_t compute(IComponentStore* const* apStores, size_t aNbStores);
+
+    /**
+     * @brief Compute the Entities having a Component in both ComponentStores.
+     */
+    template<typename C1, typename C2>
+    inline size_t compute(ComponentStore<C1>& aStore1, ComponentStore<C2>& aStore2) {
+        IComponentStore* const stores[] = {&aStore1, &aStore2};
+        return compute(stores, 2);
+    }
+
+    /**
+     * @brief Compute the Entities having a Component in all three ComponentStores.
+     */
+    template<typename C1, typename C2, typename C3>
+    inline size_t compute(ComponentStore<C1>& aStore1, ComponentStore<C2>& aStore2, ComponentStore<C3>& aStore3) {
+        IComponentStore* const stores[] = {&aStore1, &aStore2, &aStore3};
+        return compute(stores, 3);
+    }
+
+    /// Get the number of Entities (rows) of the result.
+    inline size_t size() const {
+        return mEntities.size();
+    }
+
+    /// Get the number of joined stores (indexes per row).
+    inline size_t getNbStores() const {
+        return mNbStores;
+    }
+
+    /// Get the Entity of a row of the result.
+    inline Entity getEntity(size_t aRow) const {
+        return mEntities[aRow];
+    }
+
+    /// Get the indexes of the Components of a row of the result, one per store, in the order given to compute().
+    inline const size_t* getIndexes(size_t aRow) const {
+        return &mIndexes[aRow * mNbStores];
+    }
+
+    /**
+     * @brief Call a function for each row of the result.
+     *
+     * @tparam F    Type of the function, or functor, taking an 'Entity aEntity, const size_t* apIndexes' parameters.
+     *
+     * @param[in] aFunction Function called for each row, with the Entity and the indexes of its Components.
+     *
+     * @return  Number of rows.
+     */
+    template<typename F>
+    inline size_t forEach(F aFunction) const {
+        for (size_t row = 0; row < mEntities.size(); ++row) {
+            aFunction(mEntities[row], &mIndexes[row * mNbStores]);
+        }
+        return mEntities.size();
+    }
+
+private:
+    /// Non copyable
+    Join(const Join&);
+    /// Non copyable
+    Join& operator=(const Join&);
+
+    size_t              mNbStores;          ///< Number of joined stores (indexes per row)
+    std::vector<Entity> mEntities;          ///< Entity of each row
+    std::vector<size_t> mIndexes;           ///< Indexes of the Components of each row, one per store
+    std::vector<Entity> mNextEntities;      ///< Entities of each row, while joining the next store
+    std::vector<size_t> mNextIndexes;       ///< Indexes of each row, while joining the next store
+    std::vector<size_t> mMatches;           ///< Indexes of the common Entities in the current rows
+    std::vector<size_t> mStoreMatches;      ///< Indexes of the common Entities in the next store
+    std::vector<size_t> mOrder;             ///< Indexes of the stores, from the smallest to the biggest
+};
+
+} // namespace ecs
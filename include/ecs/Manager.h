@@ -11,17 +11,28 @@
 #pragma once
 
 #include <ecs/Entity.h>
+#include <ecs/EntityTable.h>
 #include <ecs/Component.h>
 #include <ecs/ComponentType.h>
 #include <ecs/ComponentStore.h>
+#include <ecs/BlobComponentStore.h>
+#include <ecs/MappedComponentStore.h>
+#include <ecs/Resource.h>
+#include <ecs/ComponentFilter.h>
+#include <ecs/Signature.h>
 #include <ecs/System.h>
+#include <ecs/EventBus.h>
+#include <ecs/Hierarchy.h>
+#include <ecs/Query.h>
+#include <ecs/Snapshot.h>
+#include <ecs/ComponentObserver.h>
 
 #include <map>
-#include <unordered_map>
+#include <string>
 #include <set>
 #include <vector>
 #include <memory>   // std::shared_ptr
-#include <cassert>
+#include <atomic>
 #include <limits>
 #include <stdexcept>
 
@@ -31,21 +42,47 @@
  */
 namespace ecs {
 
+class AsyncSystem;
+
 /**
  * @brief   Manage associations of Entity, Component and System.
  * @ingroup ecs
  *
+ *  Concurrency contract:
+ * - a Manager is owned by one thread, the only one allowed to modify its structure (create, destroy, register
+ *   or migrate Entities, add or remove Components, add Systems...) at sync points, between frames;
+ * - reserveEntity() can be called by any thread at any time: reserved Ids are lock-free and materialized into
+ *   Entities by the owning thread at the next sync point, with createReservedEntities();
+ * - during a frame, any number of threads can concurrently use the const methods of the Manager and of its
+ *   ComponentStores (hasEntity(), getComponentStore() const, ComponentStore::has(), get() const, find() const),
+ *   but reading a Component while a System is modifying it is a data race.
+ *
  * @todo Map ComponentStore by value, not by pointer.
  * @todo Add a Manager::unregisterEntity() method.
- * @todo Add a Manager::destroyEntity() method.
  * @todo Add a Manager::extractComponent() method.
  * @todo Wrap createEntity() -> addComponent() -> registerEntity() methods into a Transaction.
  * @todo Throw instead of returning false in case of error?
  */
 class Manager {
 public:
-    /// Constructor
-    Manager();
+    /**
+     * @brief Check of the allocations made by each frame, after a warm-up (see setAllocationCheck()).
+     */
+    enum AllocationCheck {
+        eAllocationIgnored = 0, ///< Frames can allocate (default)
+        eAllocationReported,    ///< Frames allocating after the warm-up are counted (see getNbAllocatingFrames())
+        eAllocationForbidden    ///< Frames allocating after the warm-up throw std::runtime_error
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     *  Throws std::runtime_error if the Id of the shard does not fit in _entityShardBits.
+     *
+     * @param[in] aShardId  Id of the shard, stored in the high order bits of all Entities created by this Manager
+     *                      (see World, to run multiple Manager shards in parallel).
+     */
+    explicit Manager(unsigned int aShardId = 0);
     /// Destructor
     virtual ~Manager();
 
@@ -59,14 +96,109 @@ public:
     inline bool createComponentStore() {
         static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
         static_assert(C::_mType != _invalidComponentType, "C must define a valid non-zero _mType");
+        static_assert(C::_mType < _firstRuntimeComponentType,
+                      "C must define a _mType lower than the ComponentTypes reserved to runtime Components");
         return mComponentStores.insert(std::make_pair(C::_mType, IComponentStore::Ptr(new ComponentStore<C>()))).second;
     }
 
+    /**
+     * @brief   Create a BlobComponentStore for a type of Component defined at runtime by its layout.
+     *
+     *  The ComponentType is allocated from the top of the range reserved to runtime Components (the highest
+     * ECS_RUNTIME_COMPONENT_TYPES ones), so that it cannot collide with a Component structure or a Tag.
+     * The stores of runtime Components are used exactly like the other ones, by filters, Systems, Queries, Joins,
+     * prefabs and migrations (as long as each shard creates them in the same order).
+     *
+     *  Throws std::runtime_error if a runtime type of Component of the same name already exists,
+     * or if all the ComponentTypes reserved to runtime Components are used.
+     *
+     * @param[in] aLayout   Layout of the Component, with the name of its type.
+     *
+     * @return  The ComponentType allocated for the runtime type of Component.
+     */
+    ComponentType createBlobComponentStore(const ComponentLayout& aLayout);
+
+    /**
+     * @brief   Get the ComponentType of a runtime type of Component, by name.
+     *
+     *  Throws std::runtime_error if the runtime type of Component does not exist.
+     *
+     * @param[in] aName Name of the type of Component.
+     */
+    ComponentType getBlobComponentType(const std::string& aName) const;
+
+    /**
+     * @brief   Get (access to) the BlobComponentStore of a runtime type of Component.
+     *
+     *  Throws std::runtime_error if the BlobComponentStore does not exist.
+     *
+     * @param[in] aComponentType    Type of Component, as returned by createBlobComponentStore().
+     */
+    BlobComponentStore& getBlobComponentStore(ComponentType aComponentType);
+
+    /**
+     * @brief   Create (or reopen) a MappedComponentStore,
+     *          keeping the trivially copyable Components of a type in a file.
+     *
+     *  The Components already in the file are adopted: their Entities are created if needed (and left
+     * unregistered, like new Entities), so that a world is reopened by opening all its stores, then registering
+     * its Entities. Open the stores before creating any new Entity, so that their Ids do not collide.
+     *
+     *  Components of this type are then accessed by getMappedComponentStore() and addMappedComponent()
+     * (instead of getComponentStore() and addComponent()).
+     *
+     *  Throws std::runtime_error if a ComponentStore of this type already exists, or if the file cannot be opened.
+     *
+     * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aPath         Path of the file.
+     * @param[in] aCapacity     Initial capacity, in number of Components, of a new file.
+     *
+     * @return  Number of Components found in the file.
+     */
+    template<typename C>
+    inline size_t createMappedComponentStore(const std::string& aPath, size_t aCapacity = 1024) {
+        static_assert(C::_mType < _firstRuntimeComponentType,
+                      "C must define a _mType lower than the ComponentTypes reserved to runtime Components");
+        if (mComponentStores.end() != mComponentStores.find(C::_mType)) {
+            throw std::runtime_error("The ComponentStore already exists");
+        }
+        MappedComponentStore<C>* pStore = new MappedComponentStore<C>(aPath, aCapacity);
+        mComponentStores.insert(std::make_pair(C::_mType, IComponentStore::Ptr(pStore)));
+
+        const std::vector<Entity>& entities = pStore->getEntities();
+        for (auto entity  = entities.begin();
+                  entity != entities.end();
+                ++entity) {
+            adoptEntity(*entity).mSignature.set(C::_mType);
+        }
+        return entities.size();
+    }
+
+    /**
+     * @brief   Get (access to) the MappedComponentStore of a certain type of Component.
+     *
+     *  Throws std::runtime_error if the MappedComponentStore does not exist.
+     */
+    template<typename C>
+    inline MappedComponentStore<C>& getMappedComponentStore() {
+        auto iComponentStore = mComponentStores.find(C::_mType);
+        MappedComponentStore<C>* pStore = nullptr;
+        if (mComponentStores.end() != iComponentStore) {
+            pStore = dynamic_cast<MappedComponentStore<C>*>(iComponentStore->second.get());
+        }
+        if (nullptr == pStore) {
+            throw std::runtime_error("The MappedComponentStore does not exist");
+        }
+        return *pStore;
+    }
+
     /**
      * @brief   Get (access to) the ComponentStore of a certain type of Component.
      * @ingroup ecs
      *
-     *  Throws std::runtime_error if the ComponentStore does not exist.
+     *  Throws std::runtime_error if the ComponentStore does not exist, or is not a ComponentStore<C>
+     * (for instance a MappedComponentStore, see getMappedComponentStore()).
      *
      * @tparam C    A structure derived from Component, of a certain type of Component.
      *
@@ -80,9 +212,147 @@ public:
         if (mComponentStores.end() == iComponentStore) {
             throw std::runtime_error("The ComponentStore does not exist");
         }
-        return reinterpret_cast<ComponentStore<C>&>(*(iComponentStore->second));
+        if (IComponentStore::eTypedStore != iComponentStore->second->getKind()) {
+            throw std::runtime_error("The ComponentStore is not a ComponentStore<C>");
+        }
+        return static_cast<ComponentStore<C>&>(*(iComponentStore->second));
+    }
+
+    /**
+     * @brief   Take an immutable view of the ComponentStore of a type in each published Snapshot.
+     *
+     *  Throws std::runtime_error if the ComponentStore does not exist, or is not a ComponentStore<C>.
+     *
+     * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+     */
+    template<typename C>
+    inline void enableSnapshot() {
+        getComponentStore<C>();
+        mSnapshotFunctions[C::_mType] = &takeComponentSnapshot<C>;
+    }
+
+    /**
+     * @brief   Publish a new Snapshot of all enabled ComponentStores (see enableSnapshot()).
+     *
+     *  Done at the end of each updateEntities() and updateFrame(). Only the chunks of the stores
+     * that changed since the previous Snapshot are copied, and the views of the stores whose version
+     * did not change are shared as a whole.
+     */
+    void publishSnapshot();
+
+    /**
+     * @brief   Get the last published Snapshot (or nullptr), from any thread, without locking the Manager.
+     *
+     *  The Snapshot stays valid (and unchanged) as long as the returned shared pointer is held.
+     */
+    inline Snapshot::Ptr getSnapshot() const {
+        return std::atomic_load(&mSnapshot);
+    }
+
+    /**
+     * @brief   Set (move) the unique Resource of a certain type of Component, not associated to any Entity.
+     *
+     *  If the Resource already exists, its data is replaced in place, so references to it stay valid.
+     *
+     * @tparam R    A structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aResource 'rvalue' to the data of the Resource.
+     *
+     * @return true if the Resource has been created, false if it has been replaced.
+     */
+    template<typename R>
+    inline bool setResource(R&& aResource) {
+        static_assert(std::is_base_of<Component, R>::value, "R must derived from the Component struct");
+        static_assert(R::_mType != _invalidComponentType, "R must define a valid non-zero _mType");
+        if (hasResource<R>()) {
+            static_cast<Resource<R>&>(*mResources[R::_mType]).mValue = std::move(aResource);
+            return false;
+        }
+        if (mResources.size() <= R::_mType) {
+            mResources.resize(R::_mType + 1);
+        }
+        mResources[R::_mType] = IResource::Ptr(new Resource<R>(std::move(aResource)));
+        return true;
+    }
+
+    /**
+     * @brief   Test if the unique Resource of a certain type of Component exists.
+     *
+     * @tparam R    A structure derived from Component, of a certain type of Component.
+     */
+    template<typename R>
+    inline bool hasResource() const {
+        return ((R::_mType < mResources.size()) && (mResources[R::_mType]));
+    }
+
+    /**
+     * @brief   Get (access to) the unique Resource of a certain type of Component, in constant time.
+     *
+     *  Throws std::runtime_error if the Resource does not exist.
+     *  The Resource never moves in memory: the reference can be kept by Systems.
+     *
+     * @tparam R    A structure derived from Component, of a certain type of Component.
+     *
+     * @return      Reference to the data of the Resource of the specified type (or throws).
+     */
+    template<typename R>
+    inline R& getResource() {
+        if (!hasResource<R>()) {
+            throw std::runtime_error("The Resource does not exist");
+        }
+        return static_cast<Resource<R>&>(*mResources[R::_mType]).mValue;
+    }
+
+    /**
+     * @brief   Get read-only access to the unique Resource of a certain type of Component, in constant time.
+     *
+     *  Throws std::runtime_error if the Resource does not exist.
+     *
+     * @tparam R    A structure derived from Component, of a certain type of Component.
+     *
+     * @return      Const reference to the data of the Resource of the specified type (or throws).
+     */
+    template<typename R>
+    inline const R& getResource() const {
+        if (!hasResource<R>()) {
+            throw std::runtime_error("The Resource does not exist");
+        }
+        return static_cast<const Resource<R>&>(*mResources[R::_mType]).mValue;
+    }
+
+    /**
+     * @brief   Get (access to) the EventBus of the Manager, to create and get EventChannels.
+     */
+    inline EventBus& getEventBus() {
+        return mEventBus;
     }
 
+    /**
+     * @brief   Get (access to) the Hierarchy of the Manager, linking parent and children Entities.
+     */
+    inline Hierarchy& getHierarchy() {
+        return mHierarchy;
+    }
+
+    /**
+     * @brief   Add an observer of the Components of a certain type, enabling the tracking of changes of the store.
+     *
+     *  Throws std::runtime_error if the ComponentStore does not exist.
+     *
+     * @param[in] aComponentType    Type of the observed Components.
+     * @param[in] aObserverPtr      Shared pointer to the ComponentObserver to add.
+     */
+    void addObserver(ComponentType aComponentType, const ComponentObserver::Ptr& aObserverPtr);
+
+    /**
+     * @brief   Deliver all changes recorded by ComponentStores to their observers, as one batch per type (sync point).
+     *
+     *  Called at the end of each updateFrame().
+     *
+     * @return  Number of batches delivered.
+     */
+    size_t notifyObservers();
+
     /**
      * @brief Add a System.
      *
@@ -93,22 +363,184 @@ public:
      */
     void addSystem(const System::Ptr& aSystemPtr);
 
+    /**
+     * @brief   Get (read-only access to) the ComponentStore of a certain type of Component.
+     * @ingroup ecs
+     *
+     *  Throws std::runtime_error if the ComponentStore does not exist, or is not a ComponentStore<C>.
+     *
+     * @tparam C    A structure derived from Component, of a certain type of Component.
+     *
+     * @return      Const reference to the ComponentStore of the specified type (or throws).
+     */
+    template<typename C>
+    inline const ComponentStore<C>& getComponentStore() const {
+        static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+        static_assert(C::_mType != _invalidComponentType, "C must define a valid non-zero _mType");
+        auto iComponentStore = mComponentStores.find(C::_mType);
+        if (mComponentStores.end() == iComponentStore) {
+            throw std::runtime_error("The ComponentStore does not exist");
+        }
+        if (IComponentStore::eTypedStore != iComponentStore->second->getKind()) {
+            throw std::runtime_error("The ComponentStore is not a ComponentStore<C>");
+        }
+        return static_cast<const ComponentStore<C>&>(*(iComponentStore->second));
+    }
+
     /**
      * @brief   Create a new Entity - simply allocate an new Id.
      *
+     *  Reuses the index of the last destroyed Entity, with its next generation, if any, else allocates a new index
+     * (see reserveEntity()). Also materializes any Entity reserved before by another thread.
+     *
+     *  Throws std::runtime_error if the shard has no Id left (see reserveEntity()).
+     *
      * @return  Id of the new Entity.
      */
     inline Entity createEntity() {
-        assert(mLastEntity < std::numeric_limits<Entity>::max());
-        mEntities.insert(std::make_pair((mLastEntity + 1), ComponentTypeSet())); // can trow std::bad_alloc
-        return (++mLastEntity);
+        if (!mFreeEntities.empty()) {
+            return recycleEntity();
+        }
+        const Entity entity = reserveEntity();
+        createReservedEntities(entity);
+        return entity;
+    }
+
+    /**
+     * @brief   Reserve the Id of a new Entity, to be materialized at the next sync point - thread-safe and lock-free.
+     *
+     *  The Entity does not exist until the owning thread calls createReservedEntities() (or createEntity()).
+     *
+     *  Always allocates a new index (only createEntity() reuses the indexes of destroyed Entities): a Manager
+     * allocates at most _maxEntityIndex indexes (2^20 - 1 by default, see ECS_ENTITY_SHARD_BITS
+     * and ECS_ENTITY_GENERATION_BITS), after which it throws std::runtime_error, instead of overflowing
+     * into the Ids of the next shard.
+     *
+     * @return  Id of the reserved Entity.
+     */
+    inline Entity reserveEntity() {
+        Entity last = mLastEntity.load(std::memory_order_relaxed);
+        do {
+            // Never go past the last Id of the shard, so that createReservedEntities() stays in range
+            if ((last - mFirstEntity) >= _maxEntityIndex) {
+                throw std::runtime_error("The Manager has no Entity Id left");
+            }
+        } while (!mLastEntity.compare_exchange_weak(last, last + 1, std::memory_order_relaxed));
+        return last + 1;
+    }
+
+    /**
+     * @brief   Materialize all Entities reserved by reserveEntity() (sync point).
+     *
+     * @return  Number of created Entities.
+     */
+    inline size_t createReservedEntities() {
+        return createReservedEntities(mLastEntity.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief   Reserve memory for a number of Entities, in the table of Entities, all Systems and all Queries.
+     *
+     *  Together with IComponentStore::reserve(), this avoids growing arrays during the frames. Registering
+     * an Entity, or adding a Component, still allocates a node in the hash maps of indexes: only steady-state
+     * frames, without any new Entity or Component, are free of allocations.
+     *
+     * @param[in] aNbEntities   Number of Entities.
+     */
+    void reserveEntities(size_t aNbEntities);
+
+    /**
+     * @brief   Instantiate a prefab: create new Entities, each with a copy of all Components and Tags of the prefab.
+     *
+     *  A prefab is any Entity holding the template values of Components, typically not registered to the Systems.
+     * Each Component is copied to all instances at once, and the Signature of the prefab is matched against
+     * the Systems only once for the whole batch. The instances are registered to the matching Systems
+     * (but are not linked into the Hierarchy).
+     *
+     *  Throws std::runtime_error if the prefab does not exist, or if one of its Components is not copyable
+     * (see IComponentStore::isCopyable()), before creating any instance.
+     *
+     * @param[in]  aPrefab      Id of the prefab Entity.
+     * @param[in]  aNbInstances Number of instances to create.
+     * @param[out] aInstances   List of Entities, where the new instances are appended.
+     *
+     * @return  Number of Systems associated to each instance.
+     */
+    size_t instantiate(const Entity aPrefab, size_t aNbInstances, std::vector<Entity>& aInstances);
+
+    /**
+     * @brief   Destroy an Entity: unregister it from all Systems, and remove all its Components.
+     *
+     *  Its children in the Hierarchy become roots. If the Entity has been created by this Manager, its index is reused
+     * by a next createEntity(), with the next generation, so that its Id stays invalid.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the Entity to destroy.
+     */
+    void destroyEntity(const Entity aEntity);
+
+    /**
+     * @brief   Reuse the index of an Entity created by this Manager, but destroyed by another shard it migrated to.
+     *
+     *  Throws std::runtime_error if the Entity has not been created by this Manager, or still exists in it.
+     *
+     * @param[in] aEntity   Id of the destroyed Entity.
+     */
+    void releaseEntity(const Entity aEntity);
+
+    /**
+     * @brief   Destroy an Entity with all its descendants in the Hierarchy.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the root Entity of the subtree to destroy.
+     *
+     * @return  Number of destroyed Entities.
+     */
+    size_t destroySubtree(const Entity aEntity);
+
+    /**
+     * @brief   Migrate an Entity, with all its Components, into another Manager (shard).
+     *
+     *  The Entity keeps its Id (globally unique thanks to the shard Id) and is unregistered from all Systems
+     * of this Manager, then registered to all matching Systems of the target Manager.
+     * Must be called at a sync point, when no System of either Manager is running.
+     *
+     *  Throws std::runtime_error if the Entity does not exist, if it already exists in the target Manager,
+     * if it is in the Hierarchy, or if a ComponentStore of the Entity does not exist in the target Manager
+     * (or is of a different type, or layout, see IComponentStore::canMoveTo()).
+     *
+     * @param[in] aEntity   Id of the Entity to migrate.
+     * @param[in] aTarget   Manager receiving the Entity and its Components.
+     *
+     * @return  Number of Systems of the target Manager associated to the Entity.
+     */
+    size_t migrateEntity(const Entity aEntity, Manager& aTarget);
+
+    /**
+     * @brief   Test if the Manager holds the specified Entity.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return  true if the Entity exists in this Manager.
+     */
+    inline bool hasEntity(const Entity aEntity) const {
+        return mEntities.has(aEntity);
+    }
+
+    /**
+     * @brief   Get the Id of the shard, stored in the high order bits of all Entities created by this Manager.
+     */
+    inline unsigned int getShardId() const {
+        return getEntityShard(mFirstEntity);
     }
 
     /**
      * @brief Add (move) a Component (of the same type as the ComponentStore) associated to an Entity.
      *
      *  Throws std::runtime_error if the Entity does not exist.
-     *  Throws std::runtime_error if the ComponentStore does not exist.
+     *  Throws std::runtime_error if the ComponentStore does not exist, or is not a ComponentStore<C>.
      *
      *  Move a new Component into the Store, associating it to its Entity.
      * Using 'rvalue' (using the move semantic of C++11) requires:
@@ -130,14 +562,147 @@ public:
         static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
         static_assert(C::_mType != _invalidComponentType, "C must define a valid non-zero _mType");
         // Access corresponding Entity
-        auto entity = mEntities.find(aEntity);
-        if (mEntities.end() == entity) {
+        EntityRecord* pRecord = mEntities.find(aEntity);
+        if (nullptr == pRecord) {
             throw std::runtime_error("The Entity does not exist");
         }
-        // Add the ComponentType to the Entity
-        (*entity).second.insert(C::_mType);
+        ComponentStore<C>& componentStore = getComponentStore<C>();
+        // Add the ComponentType to the Signature of the Entity
+        pRecord->mSignature.set(C::_mType);
         // Add the Component to the corresponding Store
-        return getComponentStore<C>().add(aEntity, std::move(aComponent));
+        return componentStore.add(aEntity, std::move(aComponent));
+    }
+
+    /**
+     * @brief Add a zero-initialized Component of a runtime type associated to an Entity.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *  Throws std::runtime_error if the BlobComponentStore does not exist.
+     *
+     * @param[in] aEntity           Id of the Entity with the Component to add.
+     * @param[in] aComponentType    Type of Component, as returned by createBlobComponentStore().
+     *
+     * @return Pointer to the new Component, valid until the next change of the store, or nullptr if already there.
+     */
+    void* addComponent(const Entity aEntity, ComponentType aComponentType);
+
+    /**
+     * @brief Add (copy) a Component associated to an Entity, into the MappedComponentStore of its type.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *  Throws std::runtime_error if the MappedComponentStore does not exist.
+     *
+     * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to add.
+     * @param[in] aComponent    New Component to add.
+     *
+     * @return true if insertion succeeded
+     */
+    template<typename C>
+    inline bool addMappedComponent(const Entity aEntity, const C& aComponent) {
+        EntityRecord* pRecord = mEntities.find(aEntity);
+        if (nullptr == pRecord) {
+            throw std::runtime_error("The Entity does not exist");
+        }
+        MappedComponentStore<C>& componentStore = getMappedComponentStore<C>();
+        pRecord->mSignature.set(C::_mType);
+        return componentStore.add(aEntity, aComponent);
+    }
+
+    /**
+     * @brief   Add a Tag to an Entity: an empty Component, stored only as a bit of the Signature of the Entity.
+     *
+     *  A Tag type has no ComponentStore: no memory is allocated for it. If the Entity is already registered,
+     * it is registered to, or unregistered from, the Systems filtering on this Tag.
+     *
+     *  Throws std::runtime_error if the Entity does not exist, or if a ComponentStore exists for this type
+     * (or if it is reserved to runtime Components).
+     *
+     * @tparam T    An empty structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntity   Id of the Entity to tag.
+     *
+     * @return true if the Tag has been added (false if the Entity already had it)
+     */
+    template<typename T>
+    inline bool addTag(const Entity aEntity) {
+        static_assert(std::is_empty<T>::value, "T must be an empty struct");
+        return (1 == setTag(T::_mType, &aEntity, 1, true));
+    }
+
+    /**
+     * @brief   Add a Tag to a list of Entities at once (see addTag()).
+     *
+     * @tparam T    An empty structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntities List of Entities to tag.
+     *
+     * @return  Number of Entities that did not already have the Tag.
+     */
+    template<typename T>
+    inline size_t addTag(const std::vector<Entity>& aEntities) {
+        static_assert(std::is_empty<T>::value, "T must be an empty struct");
+        return setTag(T::_mType, aEntities.data(), aEntities.size(), true);
+    }
+
+    /**
+     * @brief   Remove a Tag from an Entity (see addTag()).
+     *
+     * @tparam T    An empty structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntity   Id of the Entity to untag.
+     *
+     * @return true if the Tag has been removed (false if the Entity did not have it)
+     */
+    template<typename T>
+    inline bool removeTag(const Entity aEntity) {
+        static_assert(std::is_empty<T>::value, "T must be an empty struct");
+        return (1 == setTag(T::_mType, &aEntity, 1, false));
+    }
+
+    /**
+     * @brief   Remove a Tag from a list of Entities at once (see addTag()).
+     *
+     * @tparam T    An empty structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntities List of Entities to untag.
+     *
+     * @return  Number of Entities that had the Tag.
+     */
+    template<typename T>
+    inline size_t removeTag(const std::vector<Entity>& aEntities) {
+        static_assert(std::is_empty<T>::value, "T must be an empty struct");
+        return setTag(T::_mType, aEntities.data(), aEntities.size(), false);
+    }
+
+    /**
+     * @brief   Test if an Entity has a Tag (or any Component) of a certain type.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @tparam T    A structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] aEntity   Id of the Entity to test.
+     */
+    template<typename T>
+    inline bool hasTag(const Entity aEntity) const {
+        return getSignature(aEntity).test(T::_mType);
+    }
+
+    /**
+     * @brief   Get the Signature of an Entity, listing the Types of all its Components and Tags.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     */
+    inline const Signature& getSignature(const Entity aEntity) const {
+        const EntityRecord* pRecord = mEntities.find(aEntity);
+        if (nullptr == pRecord) {
+            throw std::runtime_error("The Entity does not exist");
+        }
+        return pRecord->mSignature;
     }
 
     /**
@@ -161,26 +726,252 @@ public:
      */
     size_t unregisterEntity(const Entity aEntity);
 
+    /**
+     * @brief   Put an Entity to sleep in all its Systems: it is not updated anymore until woken up.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     *
+     * @return  Number of Systems where the Entity was active.
+     */
+    size_t sleepEntity(const Entity aEntity);
+
+    /**
+     * @brief   Wake up an Entity in all its Systems.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     *
+     * @return  Number of Systems where the Entity was sleeping.
+     */
+    size_t wakeEntity(const Entity aEntity);
+
+    /**
+     * @brief   Apply the sleep policies of all Systems, using the changes tracked by the watched ComponentStores.
+     *
+     *  Called at the end of each updateFrame(), before notifyObservers().
+     *
+     * @return  Number of Entities put to sleep.
+     */
+    size_t applySleepPolicies();
+
+    /**
+     * @brief   Find all Entities matching a filter (ad-hoc query, scanning all Entities).
+     *
+     * @param[in]  aFilter      Required, excluded and optional Components to select Entities.
+     * @param[out] aEntities    List of matching Entities (appended, in no particular order).
+     *
+     * @return  Number of matching Entities found.
+     */
+    size_t queryEntities(const ComponentFilter& aFilter, std::vector<Entity>& aEntities) const;
+
+    /**
+     * @brief   Create a named Query, keeping the list of all registered Entities matching a filter.
+     *
+     *  The Query is filled with the registered Entities matching the filter, and is then kept up to date
+     * incrementally, like the Systems, by registerEntity(), unregisterEntity(), addTag() and instantiate().
+     *
+     *  Throws std::runtime_error if a Query with the same name already exists.
+     *
+     * @param[in] aName     Name of the Query.
+     * @param[in] aFilter   Required, excluded and optional Components to select Entities.
+     *
+     * @return  Reference to the new Query, valid until removeQuery().
+     */
+    const Query& createQuery(const std::string& aName, ComponentFilter&& aFilter);
+
+    /**
+     * @brief   Get (access to) a named Query.
+     *
+     *  Throws std::runtime_error if the Query does not exist.
+     *
+     * @param[in] aName     Name of the Query.
+     *
+     * @return  Reference to the Query (or throws).
+     */
+    const Query& getQuery(const std::string& aName) const;
+
+    /**
+     * @brief   Remove a named Query.
+     *
+     * @param[in] aName     Name of the Query.
+     *
+     * @return  true if the Query has been removed (false if it does not exist)
+     */
+    inline bool removeQuery(const std::string& aName) {
+        return (0 < mQueries.erase(aName));
+    }
+
     /**
      * @brief   Update all Entities of all Systems.
      *
+     *  Run each System once, in order of insertion, ignoring their phase and tick rate (see updateFrame()).
+     * Then publish a new Snapshot, if enabled.
+     *
      * @param[in] abElapsedTime Elapsed time since last update call, in seconds.
      *
      * @return  Number update of Entities (an Entity can be updated multiple time by multiple Systems).
      */
     size_t updateEntities(float abElapsedTime);
 
+    /**
+     * @brief   Specify the fixed time step of the eFixedUpdate phase of updateFrame().
+     *
+     * @param[in] aFixedTimeStep    Fixed time step, in seconds (1/60s by default).
+     * @param[in] aMaxFixedSteps    Maximum number of fixed steps per frame; the time left over is dropped
+     *                              (5 by default).
+     */
+    void setFixedTimeStep(float aFixedTimeStep, unsigned int aMaxFixedSteps);
+
+    /**
+     * @brief   Get the fraction of a fixed time step accumulated but not simulated yet, in [0;1[ (for interpolation).
+     */
+    inline float getFixedTimeAlpha() const {
+        return (mFixedTimeAccumulator / mFixedTimeStep);
+    }
+
+    /**
+     * @brief   Run a frame: all Systems of each phase, in order, honoring their tick rate.
+     *
+     *  - eFixedUpdate Systems are run with the fixed time step, as many times as needed to catch-up with
+     *    the elapsed time, but at most the configured maximum number of fixed steps.
+     *  - ePreUpdate, eUpdate and ePostUpdate Systems are run once with the elapsed time.
+     *
+     *  In each phase, Systems are run in order of insertion.
+     *
+     *  All Events of the previous frame are first cleared: Events emitted during a frame can be consumed
+     * by Systems of later phases, or after the frame.
+     * Changes of Components are delivered to observers at the end of the frame, then a new Snapshot
+     * is published, if enabled.
+     *
+     * @param[in] aElapsedTime  Elapsed time since last frame, in seconds.
+     *
+     * @return  Number update of Entities (an Entity can be updated multiple time by multiple Systems).
+     */
+    size_t updateFrame(float aElapsedTime);
+
+    /**
+     * @brief   Apply the Completions of the finished asynchronous work of all AsyncSystems (sync point).
+     *
+     *  Called at the start of each updateFrame() and updateEntities(), before running any System.
+     *
+     * @return  Number of applied Completions.
+     */
+    size_t applyCompletions();
+
+    /**
+     * @brief   Check the allocations made by each frame (updateFrame() or updateEntities()) after a warm-up.
+     *
+     *  Allocations are only counted when the library is built with ECS_TRACK_ALLOCATIONS (see AllocationTracker).
+     * The publication of Snapshots, allocating by design, is not part of the checked frame.
+     *
+     * @param[in] aCheck            Check of the allocations.
+     * @param[in] aNbWarmupFrames   Number of frames, from now, that can allocate (filling caches and arrays).
+     */
+    void setAllocationCheck(AllocationCheck aCheck, unsigned int aNbWarmupFrames = 0);
+
+    /**
+     * @brief   Get the allocations made by the last frame (see System::getAllocations() for each System).
+     */
+    inline const AllocationTracker::Counters& getFrameAllocations() const {
+        return mFrameAllocations;
+    }
+
+    /**
+     * @brief   Get the number of frames that allocated after the warm-up (eAllocationReported).
+     */
+    inline size_t getNbAllocatingFrames() const {
+        return mNbAllocatingFrames;
+    }
+
 private:
-    /// Id of the last created Entity (start with invalid Id 0).
-    Entity                                          mLastEntity;
+    /// The Rollback saves and restores the table of Entities, the ComponentStores, the Systems and the Queries.
+    friend class Rollback;
+
+    /**
+     * @brief   Record of an Entity.
+     */
+    struct EntityRecord {
+        /// Constructor.
+        explicit EntityRecord(const Signature& aSignature = Signature()) :
+            mSignature(aSignature),
+            mbRegistered(false) {
+        }
+
+        Signature   mSignature;     ///< Types of all the Components and Tags of the Entity
+        bool        mbRegistered;   ///< Has the Entity been registered to the Systems?
+    };
+
+    /**
+     * @brief   Add or remove a Tag to a list of Entities, updating the Systems of registered Entities.
+     *
+     * @param[in] aTagType      Type of the Tag.
+     * @param[in] apEntities    List of Entities.
+     * @param[in] aNbEntities   Number of Entities in the list.
+     * @param[in] abTag         true to add the Tag, false to remove it.
+     *
+     * @return  Number of Entities whose Tag has changed.
+     */
+    size_t setTag(ComponentType aTagType, const Entity* apEntities, size_t aNbEntities, bool abTag);
+
+    /**
+     * @brief   Materialize all reserved Entities up to the specified one.
+     *
+     * @param[in] aLastEntity   Id of the last reserved Entity to materialize.
+     *
+     * @return  Number of created Entities.
+     */
+    size_t createReservedEntities(const Entity aLastEntity);
+
+    /**
+     * @brief   Create a new Entity reusing the index of the last destroyed Entity (there shall be some).
+     *
+     * @return  Id of the new Entity.
+     */
+    Entity recycleEntity();
+
+    /**
+     * @brief   Get the record of an Entity found in a persistent store, creating it if needed.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     *
+     * @return  Record of the Entity.
+     */
+    EntityRecord& adoptEntity(const Entity aEntity);
+
+    /// Function taking the view of a ComponentStore, sharing the unchanged chunks of its previous view.
+    typedef IComponentSnapshot::Ptr (*SnapshotFunction)(const IComponentStore& aStore,
+                                                        const IComponentSnapshot* apPrevious);
+
+    /// Take the view of the ComponentStore of a type.
+    template<typename C>
+    static IComponentSnapshot::Ptr takeComponentSnapshot(const IComponentStore& aStore,
+                                                         const IComponentSnapshot* apPrevious) {
+        return IComponentSnapshot::Ptr(new ComponentSnapshot<C>(static_cast<const ComponentStore<C>&>(aStore),
+                                                                static_cast<const ComponentSnapshot<C>*>(apPrevious)));
+    }
+
+    /// Id of the first Entity of the shard, minus one (invalid Id 0 for the default shard).
+    Entity                                          mFirstEntity;
+
+    /// Id of the last created or reserved Entity (start with invalid Id 0) - atomic for reserveEntity().
+    std::atomic<Entity>                             mLastEntity;
+
+    /// Id of the last materialized Entity (all reserved Ids up to this one exist in mEntities).
+    Entity                                          mLastCreatedEntity;
+
+    /// Ids reusing the indexes of destroyed Entities of this shard, with their next generation.
+    std::vector<Entity>                             mFreeEntities;
 
     /**
-     * @brief Hashmap of all registered entities, listing the Type of their Components.
+     * @brief Table of all entities, with the Signature listing the Type of their Components.
      *
-     *  This only associates the Id of each Entity with Types of all it Components.
-     * Using a hashmap, since the number of Entities can be very high.
+     *  This only associates the Id of each Entity with Types of all it Components (and Tags).
+     * Using a flat open-addressing table indexed by the Entity Ids, since the number of Entities can be very high.
      */
-    std::unordered_map<Entity, ComponentTypeSet>    mEntities;
+    EntityTable<EntityRecord>                       mEntities;
 
     /**
      * @brief Map of all Components by type and Entity.
@@ -192,12 +983,76 @@ private:
      */
     std::map<ComponentType, IComponentStore::Ptr>   mComponentStores;
 
+    /**
+     * @brief Unique Resources, indexed by ComponentType for a constant time access (nullptr if not set).
+     */
+    std::vector<IResource::Ptr>                     mResources;
+
     /**
      * @brief List of all Systems, ordered by insertion (first created, first executed).
      *
      * If a pointer to a System is inserted twice, it is executed twice in each iteration (in the order of insertion).
      */
     std::vector<System::Ptr>                        mSystems;
+
+    /// AsyncSystems among the Systems, found once by addSystem(), to apply their Completions at each frame.
+    std::vector<AsyncSystem*>                       mAsyncSystems;
+
+    /// Types of the Components watched by the sleep policies of the frame (reused from a frame to the next).
+    std::vector<ComponentType>                      mWatchedComponentTypes;
+
+    /// Systems filtering on the Tag being set or reset (reused from a call to the next).
+    std::vector<System*>                            mTagSystems;
+
+    /// Queries filtering on the Tag being set or reset (reused from a call to the next).
+    std::vector<Query*>                             mTagQueries;
+
+    float                                           mFixedTimeStep;         ///< Fixed time step, in seconds
+    unsigned int                                    mMaxFixedSteps;         ///< Max number of fixed steps per frame
+    float                                           mFixedTimeAccumulator;  ///< Time not yet simulated by fixed steps
+
+    /// Typed EventChannels, cleared at the beginning of each frame.
+    EventBus                                        mEventBus;
+
+    /// Runtime types of Components, by name.
+    std::map<std::string, ComponentType>            mBlobComponentTypes;
+
+    /// Named Queries, kept up to date like the Systems.
+    std::map<std::string, Query::Ptr>               mQueries;
+
+    /// Parent and children relationships between Entities.
+    Hierarchy                                       mHierarchy;
+
+    /// Observers of Components, by type of Components.
+    std::map<ComponentType, std::vector<ComponentObserver::Ptr> >   mObservers;
+
+    /// Functions taking the view of each ComponentStore of the Snapshots, by type of Component.
+    std::map<ComponentType, SnapshotFunction>       mSnapshotFunctions;
+
+    /// Last published Snapshot, accessed atomically (by std::atomic_load() and std::atomic_store()).
+    Snapshot::Ptr                                   mSnapshot;
+
+    AllocationCheck                                 mAllocationCheck;       ///< Check of the allocations of frames
+    unsigned int                                    mNbWarmupFrames;        ///< Frames left before checking
+    size_t                                          mNbAllocatingFrames;    ///< Frames allocating after warm-up
+    AllocationTracker::Counters                     mFrameAllocations;      ///< Allocations of the last frame
+
+    /**
+     * @brief Run all Systems of a phase, in order of insertion.
+     *
+     * @param[in] aPhase        Phase of the frame to run.
+     * @param[in] aElapsedTime  Elapsed time to give to the Systems, in seconds.
+     *
+     * @return  Number update of Entities.
+     */
+    size_t updatePhase(System::Phase aPhase, float aElapsedTime);
+
+    /**
+     * @brief Account for the allocations made by a frame, and check them after the warm-up.
+     *
+     * @param[in] aStart    Allocation counters at the start of the frame.
+     */
+    void checkFrameAllocations(const AllocationTracker::Counters& aStart);
 };
 
 } // namespace ecs
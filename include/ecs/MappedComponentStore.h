@@ -0,0 +1,421 @@
+/**
+ * @file    MappedComponentStore.h
+ * @ingroup ecs
+ * @brief   A ecs::MappedComponentStore keeps trivially copyable ecs::Component in a memory-mapped file.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/ComponentStore.h>
+#include <ecs/MappedFile.h>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A MappedComponentStore keeps trivially copyable Components in a memory-mapped file.
+ * @ingroup ecs
+ *
+ * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+ *
+ *  Like a ComponentStore, Components are packed in a contiguous array with the array of their Entities,
+ * but both arrays live in a file with a stable layout (a 64 bytes header, the Entities, then the Components,
+ * each array aligned on 64 bytes), so that reopening it only reads the Entities to rebuild the index:
+ * the pages of Components are only loaded from disk when first touched by a System.
+ *
+ *  Modified pages are written back to the file by the system; flush() forces them to disk at a checkpoint.
+ * The file is only consistent on disk after a flush() (or a clean exit), and is only portable between
+ * builds with the same layout of Component (checked by size) and the same endianness.
+ *
+ *  Growing the store remaps the file, invalidating all references to Components, like a std::vector.
+ */
+template<typename C>
+class MappedComponentStore : public IComponentStore {
+    static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+    static_assert(C::_mType != _invalidComponentType, "C must define a valid non-zero _mType");
+    static_assert(std::is_trivially_copyable<C>::value, "C must be trivially copyable to be stored in a file");
+    static_assert(std::alignment_of<C>::value <= 64, "C must not be aligned on more than 64 bytes");
+
+public:
+    /**
+     * @brief Constructor, opening (or creating) the file of the store.
+     *
+     *  Throws std::runtime_error if the file cannot be mapped, or is not a store of the same type of Component.
+     *
+     * @param[in] aPath         Path of the file.
+     * @param[in] aCapacity     Initial capacity, in number of Components, of a new file.
+     */
+    explicit MappedComponentStore(const std::string& aPath, size_t aCapacity = 1024) :
+        IComponentStore(eMappedStore),
+        mFile(),
+        mEntities(),
+        mIndexes() {
+        if (0 == aCapacity) {
+            aCapacity = 1;
+        }
+        mFile.open(aPath, getFileSize(aCapacity));
+        Header& header = getHeader();
+        if (0 == header.mMagic) {
+            // New file
+            header.mMagic = _mMagic;
+            header.mVersion = _mVersion;
+            header.mType = C::_mType;
+            header.mComponentSize = sizeof(C);
+            header.mNbComponents = 0;
+            header.mCapacity = aCapacity;
+            header.mbSorted = 1;
+        } else if ((_mMagic != header.mMagic) || (_mVersion != header.mVersion)) {
+            throw std::runtime_error("The file is not a MappedComponentStore");
+        } else if ((C::_mType != header.mType) || (sizeof(C) != header.mComponentSize)) {
+            throw std::runtime_error("The file does not store the same type of Component");
+        } else if ((header.mNbComponents > header.mCapacity) || (mFile.getSize() < getFileSize(header.mCapacity))) {
+            throw std::runtime_error("The file is truncated");
+        }
+
+        // Only the Entities are read, to rebuild their index
+        const size_t nbComponents = static_cast<size_t>(getHeader().mNbComponents);
+        const Entity* pEntities = getEntitiesData();
+        mEntities.assign(pEntities, pEntities + nbComponents);
+        mIndexes.reserve(nbComponents);
+        for (size_t index = 0; index < nbComponents; ++index) {
+            mIndexes.insert(std::make_pair(mEntities[index], index));
+        }
+    }
+
+    /// Destructor, unmapping the file (modified pages are written back by the system).
+    virtual ~MappedComponentStore() {
+    }
+
+    /**
+     * @brief Add (copy) a Component associated to an Entity.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to add.
+     * @param[in] aComponent    New Component (of the store type) to add.
+     *
+     * @return true if insertion succeeded
+     */
+    inline bool add(const Entity aEntity, const C& aComponent) {
+        if (has(aEntity)) {
+            return false;
+        }
+        reserve(mEntities.size() + 1);
+        const size_t index = append(aEntity);
+        std::memcpy(&getAt(index), &aComponent, sizeof(C));
+        markAdded(aEntity);
+        return true;
+    }
+
+    /**
+     * @brief Remove the Component associated to an Entity.
+     *
+     * @param[in] aEntity   Id of the Entity to remove.
+     *
+     * @return true if finding and removing the Entity succeeded.
+     */
+    virtual bool remove(Entity aEntity) {
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return false;
+        }
+        erase(index);
+        markRemoved(aEntity);
+        return true;
+    }
+
+    /**
+     * @brief Move the Component associated to an Entity into another MappedComponentStore of the same type.
+     *
+     *  All shards shall use the same backend for a same type of Component: throws std::runtime_error
+     * if the target store is not a MappedComponentStore of the same type.
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to move.
+     * @param[in] aTargetStore  MappedComponentStore of the same type of Component, receiving the Component.
+     *
+     * @return true if finding and moving the Component succeeded.
+     */
+    virtual bool moveTo(Entity aEntity, IComponentStore& aTargetStore) {
+        if (!canMoveTo(aTargetStore)) {
+            throw std::runtime_error("The target store is not a MappedComponentStore of the same type");
+        }
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return false;
+        }
+        const bool bMoved = static_cast<MappedComponentStore<C>&>(aTargetStore).add(aEntity, getAt(index->second));
+        erase(index);
+        markRemoved(aEntity);
+        return bMoved;
+    }
+
+    /**
+     * @brief Test if another store is a MappedComponentStore of the same type, able to receive the Components.
+     *
+     * @param[in] aTargetStore  Store registered under the same ComponentType in another Manager.
+     */
+    virtual bool canMoveTo(const IComponentStore& aTargetStore) const {
+        return (eMappedStore == aTargetStore.getKind()) &&
+               (nullptr != dynamic_cast<const MappedComponentStore<C>*>(&aTargetStore));
+    }
+
+    /**
+     * @brief Copy the Component associated to an Entity to a list of Entities (without any Component of this type).
+     *
+     * @param[in] aEntity       Id of the Entity with the Component to copy (typically a prefab).
+     * @param[in] apEntities    List of Entities receiving a copy of the Component.
+     * @param[in] aNbEntities   Number of Entities in the list.
+     *
+     * @return Number of Components added.
+     */
+    virtual size_t clone(Entity aEntity, const Entity* apEntities, size_t aNbEntities) {
+        auto index = mIndexes.find(aEntity);
+        if (mIndexes.end() == index) {
+            return 0;
+        }
+        for (size_t i = 0; i < aNbEntities; ++i) {
+            if (has(apEntities[i])) {
+                throw std::runtime_error("The Entity already has a Component of this type");
+            }
+        }
+        const size_t source = index->second;
+        reserve(mEntities.size() + aNbEntities);
+        mIndexes.reserve(mIndexes.size() + aNbEntities);
+        for (size_t i = 0; i < aNbEntities; ++i) {
+            const size_t target = append(apEntities[i]);
+            std::memcpy(&getAt(target), &getAt(source), sizeof(C));
+            markAdded(apEntities[i]);
+        }
+        return aNbEntities;
+    }
+
+    /**
+     * @brief Test if the Components can be copied by clone(): always, as trivially copyable Components.
+     */
+    virtual bool isCopyable() const {
+        return true;
+    }
+
+    /**
+     * @brief Test if the store contains a Component for the specified Entity.
+     */
+    inline bool has(Entity aEntity) const {
+        return (mIndexes.end() != mIndexes.find(aEntity));
+    }
+
+    /**
+     * @brief Get access to the Component associated with the specified Entity.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     */
+    inline C& get(Entity aEntity) {
+        return getAt(mIndexes.at(aEntity));
+    }
+    /**
+     * @brief Get read-only access to the Component associated with the specified Entity.
+     *
+     *  Throws std::out_of_range exception if the Entity and its associated Component is not found.
+     */
+    inline const C& get(Entity aEntity) const {
+        return getAt(mIndexes.at(aEntity));
+    }
+
+    /**
+     * @brief Find the Component associated with the specified Entity, if any.
+     *
+     * @return Pointer to the Component associated with the specified Entity, or nullptr if not found.
+     */
+    inline C* find(Entity aEntity) {
+        auto index = mIndexes.find(aEntity);
+        return (mIndexes.end() != index) ? &getAt(index->second) : nullptr;
+    }
+
+    /**
+     * @brief Get access to the Component at an index of the packed array (see Join).
+     *
+     * @param[in] aIndex    Index in the packed array, in [0; size()[.
+     */
+    inline C& getAt(size_t aIndex) {
+        return getComponentsData()[aIndex];
+    }
+    /**
+     * @brief Get read-only access to the Component at an index of the packed array (see Join).
+     */
+    inline const C& getAt(size_t aIndex) const {
+        return getComponentsData()[aIndex];
+    }
+
+    /// Get the number of stored Components.
+    inline size_t size() const {
+        return mEntities.size();
+    }
+
+    /// Get the number of Components that can be stored without growing the file.
+    inline size_t getCapacity() const {
+        return static_cast<size_t>(getHeader().mCapacity);
+    }
+
+    /**
+     * @brief Grow the file to store a number of Components (invalidating references to Components if it grows).
+     *
+     *  Throws std::runtime_error if the file cannot be resized.
+     */
+    virtual void reserve(size_t aCapacity) {
+        const size_t capacity = getCapacity();
+        if (aCapacity > capacity) {
+            const size_t newCapacity = std::max(aCapacity, capacity * 2);
+            const size_t componentsOffset = getComponentsOffset(capacity);
+            mFile.resize(getFileSize(newCapacity));
+            // The Entities grow in place, the Components move toward the end of the file
+            uint8_t* pData = static_cast<uint8_t*>(mFile.getData());
+            std::memmove(pData + getComponentsOffset(newCapacity), pData + componentsOffset, size() * sizeof(C));
+            getHeader().mCapacity = newCapacity;
+        }
+    }
+
+    /**
+     * @brief Write all modified pages to disk, waiting for completion (checkpoint).
+     *
+     *  Throws std::runtime_error on failure.
+     */
+    inline void flush() {
+        mFile.flush();
+    }
+
+    /**
+     * @brief Get access to the packed array of Entities, in the same order as the packed array of Components.
+     */
+    virtual const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Test if the packed arrays are sorted by increasing Entities.
+     */
+    virtual bool isSortedByEntity() const {
+        return (0 != getHeader().mbSorted);
+    }
+
+    /**
+     * @brief Sort the packed arrays by increasing Entities (if not already sorted),
+     *        invalidating pointers to Components.
+     */
+    virtual void sortByEntity() {
+        if (!isSortedByEntity()) {
+            std::vector<size_t> order(mEntities.size());
+            for (size_t index = 0; index < order.size(); ++index) {
+                order[index] = index;
+            }
+            const std::vector<Entity>& entities = mEntities;
+            std::sort(order.begin(), order.end(), [&entities](size_t aIndex1, size_t aIndex2) {
+                return entities[aIndex1] < entities[aIndex2];
+            });
+            std::vector<C> components(getComponentsData(), getComponentsData() + size());
+            for (size_t index = 0; index < order.size(); ++index) {
+                std::memcpy(&getAt(index), &components[order[index]], sizeof(C));
+            }
+            std::sort(mEntities.begin(), mEntities.end());
+            for (size_t index = 0; index < mEntities.size(); ++index) {
+                getEntitiesData()[index] = mEntities[index];
+                mIndexes[mEntities[index]] = index;
+            }
+            getHeader().mbSorted = 1;
+        }
+    }
+
+private:
+    /// Non copyable
+    MappedComponentStore(const MappedComponentStore&);
+    /// Non copyable
+    MappedComponentStore& operator=(const MappedComponentStore&);
+
+    /// Header of the file, stable on disk.
+    struct Header {
+        uint32_t    mMagic;         ///< Identifies a MappedComponentStore file
+        uint32_t    mVersion;       ///< Version of the layout of the file
+        uint32_t    mType;          ///< Type of the stored Components
+        uint32_t    mComponentSize; ///< Size of each stored Component
+        uint64_t    mNbComponents;  ///< Number of stored Components
+        uint64_t    mCapacity;      ///< Number of Components that fit in the file
+        uint64_t    mbSorted;       ///< Are the packed arrays sorted by Entity?
+        uint64_t    mReserved[3];   ///< Padding to 64 bytes
+    };
+    static_assert(sizeof(Header) == 64, "The header of the file must be 64 bytes");
+
+    /// Size of the header, and alignment of the arrays
+    static const size_t     _mHeaderSize = 64;
+    /// "ECSM" in little endian
+    static const uint32_t   _mMagic = 0x4D534345;
+    /// Version of the layout of the file
+    static const uint32_t   _mVersion = 1;
+
+    /// Offset of the packed array of Components in a file of a certain capacity.
+    static inline size_t getComponentsOffset(size_t aCapacity) {
+        return (_mHeaderSize + (aCapacity * sizeof(Entity)) + _mHeaderSize - 1) & ~(_mHeaderSize - 1);
+    }
+    /// Size of a file of a certain capacity.
+    static inline size_t getFileSize(size_t aCapacity) {
+        return getComponentsOffset(aCapacity) + (aCapacity * sizeof(C));
+    }
+
+    inline Header& getHeader() {
+        return *static_cast<Header*>(mFile.getData());
+    }
+    inline const Header& getHeader() const {
+        return *static_cast<const Header*>(mFile.getData());
+    }
+    inline Entity* getEntitiesData() {
+        return reinterpret_cast<Entity*>(static_cast<uint8_t*>(mFile.getData()) + _mHeaderSize);
+    }
+    inline C* getComponentsData() {
+        return reinterpret_cast<C*>(static_cast<uint8_t*>(mFile.getData()) + getComponentsOffset(getCapacity()));
+    }
+    inline const C* getComponentsData() const {
+        const uint8_t* pData = static_cast<const uint8_t*>(mFile.getData());
+        return reinterpret_cast<const C*>(pData + getComponentsOffset(getCapacity()));
+    }
+
+    /// Append a new Entity (the capacity shall be reserved), returning its index.
+    inline size_t append(const Entity aEntity) {
+        const size_t index = mEntities.size();
+        Header& header = getHeader();
+        header.mbSorted = (header.mbSorted && (mEntities.empty() || (mEntities.back() < aEntity))) ? 1 : 0;
+        mEntities.push_back(aEntity);
+        mIndexes.insert(std::make_pair(aEntity, index));
+        getEntitiesData()[index] = aEntity;
+        header.mNbComponents = mEntities.size();
+        return index;
+    }
+
+    /// Remove the Component at an index, moving the last one in its place.
+    inline void erase(typename std::unordered_map<Entity, size_t>::iterator aIndex) {
+        const size_t index = aIndex->second;
+        const size_t last = mEntities.size() - 1;
+        if (index != last) {
+            getHeader().mbSorted = 0;
+            std::memcpy(&getAt(index), &getAt(last), sizeof(C));
+            mEntities[index] = mEntities[last];
+            getEntitiesData()[index] = mEntities[last];
+            mIndexes[mEntities[index]] = index;
+        }
+        mEntities.pop_back();
+        mIndexes.erase(aIndex);
+        getHeader().mNbComponents = mEntities.size();
+    }
+
+    MappedFile                          mFile;      ///< The memory-mapped file, with the header and packed arrays
+    std::vector<Entity>                 mEntities;  ///< Entity of each stored Component (copy of the file array)
+    std::unordered_map<Entity, size_t>  mIndexes;   ///< Index of the Component of each Entity
+};
+
+} // namespace ecs
@@ -0,0 +1,105 @@
+/**
+ * @file    MappedFile.h
+ * @ingroup ecs
+ * @brief   A ecs::MappedFile maps a whole file in memory, shared with the file on disk.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <string>
+#include <cstddef>   // size_t
+
+namespace ecs {
+
+/**
+ * @brief   A MappedFile maps a whole file in memory, shared with the file on disk.
+ * @ingroup ecs
+ *
+ *  Pages are only read from disk when first touched, and modified pages are written back by the system,
+ * or explicitly by flush() (at a checkpoint). Resizing the file remaps it, invalidating all pointers to its data.
+ *
+ *  Uses mmap() on POSIX systems, and CreateFileMapping()/MapViewOfFile() on Windows.
+ */
+class MappedFile {
+public:
+    /// Constructor of a closed file.
+    MappedFile();
+
+    /// Destructor, unmapping and closing the file (without forcing modified pages to disk).
+    ~MappedFile();
+
+    /**
+     * @brief Open (or create) a file and map it in memory, growing it to a minimum size if needed.
+     *
+     *  Throws std::runtime_error if the file cannot be opened, resized or mapped.
+     *
+     * @param[in] aPath     Path of the file.
+     * @param[in] aMinSize  Minimum size of the file, in bytes (new bytes are zero).
+     */
+    void open(const std::string& aPath, size_t aMinSize);
+
+    /**
+     * @brief Resize the file, and remap it (invalidating all pointers to its data).
+     *
+     *  Throws std::runtime_error if the file cannot be resized or mapped.
+     *
+     * @param[in] aSize     New size of the file, in bytes (new bytes are zero).
+     */
+    void resize(size_t aSize);
+
+    /**
+     * @brief Write all modified pages to disk, waiting for completion (checkpoint).
+     *
+     *  Throws std::runtime_error on failure.
+     */
+    void flush();
+
+    /// Unmap and close the file.
+    void close();
+
+    /// Test if the file is open.
+    inline bool isOpen() const {
+        return (nullptr != mpData);
+    }
+
+    /// Get access to the data of the file.
+    inline void* getData() {
+        return mpData;
+    }
+    /// Get read-only access to the data of the file.
+    inline const void* getData() const {
+        return mpData;
+    }
+
+    /// Get the size of the file, in bytes.
+    inline size_t getSize() const {
+        return mSize;
+    }
+
+private:
+    /// Non copyable
+    MappedFile(const MappedFile&);
+    /// Non copyable
+    MappedFile& operator=(const MappedFile&);
+
+    /// Map the whole file in memory.
+    void map();
+
+    /// Unmap the file.
+    void unmap();
+
+#if defined(_WIN32)
+    void*       mFile;      ///< Handle of the file
+    void*       mMapping;   ///< Handle of the file mapping
+#else
+    int         mFile;      ///< Descriptor of the file
+#endif
+    void*       mpData;     ///< Address of the mapped file
+    size_t      mSize;      ///< Size of the file, in bytes
+};
+
+} // namespace ecs
@@ -0,0 +1,137 @@
+/**
+ * @file    Query.h
+ * @ingroup ecs
+ * @brief   A ecs::Query keeps the list of all registered ecs::Entity matching a ecs::ComponentFilter.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/ComponentFilter.h>
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+
+namespace ecs {
+
+/**
+ * @brief   A Query keeps the list of all registered Entities matching a ComponentFilter.
+ * @ingroup ecs
+ *
+ *  Queries are created by name with Manager::createQuery(), and are then fed incrementally by the Manager,
+ * exactly like Systems, when Entities are registered, unregistered, or tagged. Iterating the result
+ * is a walk over a packed array of Entities, in no particular order.
+ */
+class Query {
+public:
+    /// Unique pointer to a Query (stable address).
+    typedef std::unique_ptr<Query> Ptr;
+
+    /**
+     * @brief Saved result of a Query (see Rollback), reused from a save to the next.
+     */
+    struct State {
+        std::vector<Entity>                 mEntities;  ///< Packed array of matching Entities
+        std::unordered_map<Entity, size_t>  mIndexes;   ///< Index of each matching Entity in the packed array
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aName     Name of the Query.
+     * @param[in] aFilter   Filter selecting Entities by the types of their Components.
+     */
+    Query(const std::string& aName, ComponentFilter&& aFilter);
+
+    /// Destructor.
+    ~Query();
+
+    /// Get the name of the Query.
+    inline const std::string& getName() const {
+        return mName;
+    }
+
+    /// Get the filter selecting Entities.
+    inline const ComponentFilter& getFilter() const {
+        return mFilter;
+    }
+
+    /**
+     * @brief Register a matching Entity.
+     *
+     * @param[in] aEntity   Matching Entity
+     *
+     * @return true if the Entity has been inserted successfully
+     */
+    bool registerEntity(Entity aEntity);
+
+    /**
+     * @brief Unregister an Entity (moving the last Entity of the result in its place).
+     *
+     * @param[in] aEntity   Entity to unregister
+     *
+     * @return 1 if the Entity has been removed successfully, 0 otherwize
+     */
+    size_t unregisterEntity(Entity aEntity);
+
+    /**
+     * @brief Reserve memory for a number of matching Entities, so that registering them does not grow the arrays.
+     *
+     *  The hash map of indexes is also sized to avoid rehashing, but each registration still allocates a node.
+     */
+    void reserve(size_t aNbEntities);
+
+    /**
+     * @brief Test if the Entity is in the result of the Query.
+     */
+    inline bool hasEntity(Entity aEntity) const {
+        return (mIndexes.end() != mIndexes.find(aEntity));
+    }
+
+    /**
+     * @brief Get the number of Entities in the result of the Query.
+     */
+    inline size_t size() const {
+        return mEntities.size();
+    }
+
+    /**
+     * @brief Get the packed array of Entities matching the Query.
+     */
+    inline const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Save the result of the Query.
+     *
+     * @param[out] aState   State receiving a copy (reusing its memory).
+     */
+    void saveState(State& aState) const;
+
+    /**
+     * @brief Restore the result of the Query (without matching).
+     *
+     * @param[in] aState    State saved by saveState().
+     */
+    void restoreState(const State& aState);
+
+private:
+    /// Non copyable
+    Query(const Query&);
+    /// Non copyable
+    Query& operator=(const Query&);
+
+    std::string                         mName;      ///< Name of the Query
+    ComponentFilter                     mFilter;    ///< Filter selecting Entities
+    std::vector<Entity>                 mEntities;  ///< Packed array of matching Entities
+    std::unordered_map<Entity, size_t>  mIndexes;   ///< Index of each matching Entity in the packed array
+};
+
+} // namespace ecs
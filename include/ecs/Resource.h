@@ -0,0 +1,67 @@
+/**
+ * @file    Resource.h
+ * @ingroup ecs
+ * @brief   A ecs::Resource keep the unique (singleton) data of a certain type of ecs::Component.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Component.h>
+
+#include <memory>
+#include <utility>
+#include <type_traits>
+
+namespace ecs {
+
+/**
+ * @brief   Abstract base class for all templated Resource.
+ * @ingroup ecs
+ */
+class IResource {
+public:
+    /// Unique pointer to a Resource
+    typedef std::unique_ptr<IResource> Ptr;
+
+    /// Virtual destructor, required to destroy a Resource through its unique pointer.
+    virtual ~IResource() {
+    }
+};
+
+/**
+ * @brief   A Resource keep the unique (singleton) data of a certain type of Component, not associated to any Entity.
+ * @ingroup ecs
+ *
+ *  Global configuration, clocks or the bounds of the world are Resources: the Manager stores them by type,
+ * giving access to them in constant time. The data never moves in memory, so that Systems can keep a reference.
+ *
+ * @tparam R    A structure derived from Component, of a certain type of Component.
+ */
+template<typename R>
+class Resource : public IResource {
+    static_assert(std::is_base_of<Component, R>::value, "R must derived from the Component struct");
+    static_assert(R::_mType != _invalidComponentType, "R must define a valid non-zero _mType");
+
+public:
+    /**
+     * @brief Constructor, moving the data of the Resource.
+     *
+     * @param[in] aValue    'rvalue' to the data of the Resource.
+     */
+    explicit Resource(R&& aValue) :
+        mValue(std::move(aValue)) {
+    }
+
+    /// Destructor.
+    virtual ~Resource() {
+    }
+
+    /// Data of the Resource.
+    R   mValue;
+};
+
+} // namespace ecs
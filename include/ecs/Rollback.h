@@ -0,0 +1,138 @@
+/**
+ * @file    Rollback.h
+ * @ingroup ecs
+ * @brief   A ecs::Rollback keeps a ring buffer of saved states of a ecs::Manager, to restore any recent tick.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/EntityTable.h>
+#include <ecs/ComponentStore.h>
+#include <ecs/System.h>
+#include <ecs/Query.h>
+#include <ecs/Manager.h>
+
+#include <vector>
+#include <cstddef>   // size_t
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A Rollback keeps a ring buffer of saved states of a Manager, to restore any of the last ticks.
+ * @ingroup ecs
+ *
+ *  Made for rollback netcode: the world is saved at each tick, and when a late input arrives,
+ * the tick it applies to is restored before simulating again the following ticks.
+ *
+ *  All memory is allocated up front, and then reused from a save to the next (slots of the ring buffer are
+ * overwritten in place, reusing the capacity of their arrays). Each save copies the table of Entities,
+ * the registered Entities of the Systems and the results of the Queries, so that restoring does not need
+ * to match any Entity again. ComponentStores are only copied when modified since the previous save
+ * (see IComponentStore::getVersion()): a slot then references the content saved by an older slot. Systems shall
+ * thus read Components with ComponentStore::read() instead of get(), which counts as a modification.
+ *
+ *  The ComponentStores, Systems and Queries of the Manager shall not change after the construction of the Rollback,
+ * and all ComponentStores shall support saving their content (see IComponentStore::createState()).
+ * The Hierarchy, Resources and Events of the Manager are not saved.
+ */
+class Rollback {
+public:
+    /**
+     * @brief Constructor, preallocating the slots of the ring buffer.
+     *
+     *  Throws std::runtime_error if a ComponentStore does not support saving its content.
+     *
+     * @param[in] aManager  Manager to save and restore.
+     * @param[in] aNbSlots  Number of saved ticks (at least one).
+     */
+    explicit Rollback(Manager& aManager, size_t aNbSlots = 8);
+
+    /// Destructor.
+    ~Rollback();
+
+    /**
+     * @brief Save the state of the Manager for a tick, overwriting the oldest saved tick.
+     *
+     *  Throws std::runtime_error if the tick is not after the last saved one, or if the ComponentStores,
+     * Systems or Queries of the Manager have changed since the construction of the Rollback.
+     *
+     * @param[in] aTick     Number of the tick.
+     */
+    void save(uint64_t aTick);
+
+    /**
+     * @brief Restore the state of the Manager saved for a tick, forgetting all the ticks saved after this one.
+     *
+     *  Only the ComponentStores modified since are copied back.
+     *
+     * @param[in] aTick     Number of the tick.
+     *
+     * @return  true if the tick was saved and has been restored, false if the tick is not available.
+     */
+    bool restore(uint64_t aTick);
+
+    /**
+     * @brief Test if a tick is saved.
+     */
+    bool has(uint64_t aTick) const;
+
+    /// Get the number of slots of the ring buffer.
+    inline size_t getNbSlots() const {
+        return mSlots.size();
+    }
+
+    /// Get the number of ComponentStores copied by the last call to save() or restore().
+    inline size_t getNbCopiedStores() const {
+        return mNbCopiedStores;
+    }
+
+private:
+    /// Non copyable
+    Rollback(const Rollback&);
+    /// Non copyable
+    Rollback& operator=(const Rollback&);
+
+    /// A saved tick.
+    struct Slot {
+        bool                                    mbValid;                ///< Does the slot hold a saved tick?
+        uint64_t                                mTick;                  ///< Number of the saved tick
+        Entity                                  mLastEntity;            ///< Id of the last created or reserved Entity
+        Entity                                  mLastCreatedEntity;     ///< Id of the last materialized Entity
+        std::vector<Entity>                     mFreeEntities;          ///< Ids reusing destroyed indexes
+        float                                   mFixedTimeAccumulator;  ///< Time not yet simulated by fixed steps
+        EntityTable<Manager::EntityRecord>      mEntities;              ///< Table of all Entities
+        std::vector<System::State>              mSystems;               ///< Registered Entities of each System
+        std::vector<Query::State>               mQueries;               ///< Result of each Query
+        std::vector<IComponentStore::State::Ptr> mStores;               ///< Content of each ComponentStore (if copied)
+        std::vector<size_t>                     mSources;               ///< Slot holding the content of each store
+    };
+
+    /// Find the slot of a saved tick, or return getNbSlots().
+    size_t findSlot(uint64_t aTick) const;
+
+    /// Before overwriting a slot, hand over the content of stores it holds to another slot referencing it.
+    void releaseSlot(size_t aSlot);
+
+    /// Throw if the ComponentStores, Systems or Queries of the Manager have changed.
+    void checkManager() const;
+
+    Manager&                        mManager;           ///< Manager to save and restore
+    std::vector<Slot>               mSlots;             ///< Ring buffer of saved ticks
+    size_t                          mNextSlot;          ///< Next slot to overwrite
+    std::vector<IComponentStore*>   mStores;            ///< ComponentStores of the Manager, in order of type
+    std::vector<System*>            mSystems;           ///< Systems of the Manager, in order of insertion
+    std::vector<Query*>             mQueries;           ///< Queries of the Manager, in order of name
+    std::vector<uint64_t>           mVersions;          ///< Version of each store when last saved or restored
+    std::vector<size_t>             mLastSources;       ///< Slot holding the content of each store at this version
+    bool                            mbSaved;            ///< Has a tick been saved (after the last restore)?
+    uint64_t                        mLastTick;          ///< Last saved (or restored) tick
+    size_t                          mNbCopiedStores;    ///< Number of stores copied by the last save or restore
+};
+
+} // namespace ecs
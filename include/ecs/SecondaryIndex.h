@@ -0,0 +1,389 @@
+/**
+ * @file    SecondaryIndex.h
+ * @ingroup ecs
+ * @brief   A ecs::SecondaryIndex finds ecs::Entity by the value of a field of their ecs::Component.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <memory>
+#include <functional>
+#include <limits>
+#include <utility>
+
+namespace ecs {
+
+template<typename C>
+class ComponentStore;
+
+/**
+ * @brief   Abstract base class of the secondary indexes of a ComponentStore.
+ * @ingroup ecs
+ *
+ *  The ComponentStore owning the index marks as dirty the Entities whose Component is added, removed, marked
+ * as changed, or accessed through a non-const accessor (ComponentStore::modify(), get(), find() or getAt()).
+ * The value of a Component modified through a reference is only known after the call, so the index is refreshed
+ * lazily, by its next lookup.
+ */
+class ISecondaryIndex {
+public:
+    /// Unique pointer to an index, owned by its ComponentStore
+    typedef std::unique_ptr<ISecondaryIndex> Ptr;
+
+    /// Constructor, of an index to be built from the content of its store.
+    ISecondaryIndex() :
+        mDirtyEntities(),
+        mbRebuild(true) {
+    }
+
+    /// Virtual destructor, required to destroy an index through its unique pointer.
+    virtual ~ISecondaryIndex() {
+    }
+
+    /**
+     * @brief Mark an Entity whose Component has been added, removed or changed, to be refreshed by the next lookup.
+     *
+     *  Once more Entities are marked than there are Components in the store (an Entity can be marked many times
+     * between two lookups), the index is rebuilt instead, so that the list of dirty Entities stays bounded.
+     *
+     * @param[in] aEntity       Id of the Entity.
+     * @param[in] aNbComponents Number of Components in the store.
+     */
+    inline void markDirty(Entity aEntity, size_t aNbComponents) {
+        if (!mbRebuild) {
+            if (mDirtyEntities.size() < aNbComponents) {
+                mDirtyEntities.push_back(aEntity);
+            } else {
+                markAllDirty();
+            }
+        }
+    }
+
+    /**
+     * @brief Mark the whole content of the store as changed, to rebuild the index on the next lookup.
+     */
+    inline void markAllDirty() {
+        mbRebuild = true;
+        mDirtyEntities.clear();
+    }
+
+    /**
+     * @brief Apply the pending changes of the store to the index (done by each lookup).
+     */
+    virtual void refresh() = 0;
+
+protected:
+    std::vector<Entity> mDirtyEntities; ///< Entities whose Component have changed since the last refresh()
+    bool                mbRebuild;      ///< Shall the index be rebuilt from the whole content of the store?
+
+private:
+    /// Non copyable
+    ISecondaryIndex(const ISecondaryIndex&);
+    /// Non copyable
+    ISecondaryIndex& operator=(const ISecondaryIndex&);
+};
+
+/**
+ * @brief   Base class of the secondary indexes on a key computed from the Components of a ComponentStore.
+ * @ingroup ecs
+ *
+ * @tparam C    A structure derived from Component, of a certain type of Component.
+ * @tparam K    Type of the key, computed from a Component (typically one of its fields).
+ */
+template<typename C, typename K>
+class SecondaryIndex : public ISecondaryIndex {
+public:
+    /// Function computing the key of a Component.
+    typedef std::function<K(const C&)> KeyFunction;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aStore        ComponentStore owning the index.
+     * @param[in] aKeyFunction  Function computing the key of a Component.
+     */
+    SecondaryIndex(const ComponentStore<C>& aStore, KeyFunction&& aKeyFunction) :
+        mStore(aStore),
+        mKeyFunction(std::move(aKeyFunction)) {
+    }
+
+    /// Destructor.
+    virtual ~SecondaryIndex() {
+    }
+
+    /**
+     * @brief Apply the pending changes of the store to the index (done by each lookup).
+     */
+    virtual void refresh() {
+        if (mbRebuild) {
+            clearKeys();
+            const std::vector<Entity>&  entities = mStore.getEntities();
+            const std::vector<C>&       components = mStore.getComponents();
+            for (size_t index = 0; index < entities.size(); ++index) {
+                setKey(entities[index], mKeyFunction(components[index]));
+            }
+            mbRebuild = false;
+        } else {
+            for (auto entity  = mDirtyEntities.begin();
+                      entity != mDirtyEntities.end();
+                    ++entity) {
+                const C* pComponent = mStore.find(*entity);
+                if (nullptr != pComponent) {
+                    setKey(*entity, mKeyFunction(*pComponent));
+                } else {
+                    eraseKey(*entity);
+                }
+            }
+        }
+        mDirtyEntities.clear();
+    }
+
+protected:
+    /// Forget all the keys.
+    virtual void clearKeys() = 0;
+    /// Set the key of an Entity, inserting it if needed.
+    virtual void setKey(Entity aEntity, const K& aKey) = 0;
+    /// Forget the key of an Entity, if any.
+    virtual void eraseKey(Entity aEntity) = 0;
+
+private:
+    const ComponentStore<C>&    mStore;         ///< ComponentStore owning the index
+    KeyFunction                 mKeyFunction;   ///< Function computing the key of a Component
+};
+
+/**
+ * @brief   A hash index finds the Entities whose Component has a certain key, in constant time.
+ * @ingroup ecs
+ *
+ *  Made for "the Entity of this network id" or "all Entities of this team" lookups, instead of scanning all the
+ * Components. The Entities of each key are packed in an array: changing the key of an Entity moves the last one
+ * of its array in its place, so the order of the Entities of a key is not significant.
+ *
+ * @tparam C    A structure derived from Component, of a certain type of Component.
+ * @tparam K    Type of the key, with a std::hash specialization and an operator==.
+ */
+template<typename C, typename K>
+class HashIndex : public SecondaryIndex<C, K> {
+public:
+    /**
+     * @brief Constructor (see ComponentStore::addHashIndex()).
+     *
+     * @param[in] aStore        ComponentStore owning the index.
+     * @param[in] aKeyFunction  Function computing the key of a Component.
+     */
+    HashIndex(const ComponentStore<C>& aStore, typename SecondaryIndex<C, K>::KeyFunction&& aKeyFunction) :
+        SecondaryIndex<C, K>(aStore, std::move(aKeyFunction)),
+        mBuckets(),
+        mEntries(),
+        mNoEntities() {
+    }
+
+    /// Destructor.
+    virtual ~HashIndex() {
+    }
+
+    /**
+     * @brief Find all the Entities whose Component has a key.
+     *
+     * @param[in] aKey  Key to find.
+     *
+     * @return Reference to the Entities of the key (empty if none), valid until the next change of the store.
+     */
+    inline const std::vector<Entity>& find(const K& aKey) {
+        this->refresh();
+        auto bucket = mBuckets.find(aKey);
+        return (mBuckets.end() != bucket) ? bucket->second : mNoEntities;
+    }
+
+    /**
+     * @brief Find the Entity whose Component has a key (for unique keys).
+     *
+     * @param[in] aKey  Key to find.
+     *
+     * @return Id of one of the Entities of the key, or _invalidEntity if none.
+     */
+    inline Entity findFirst(const K& aKey) {
+        const std::vector<Entity>& entities = find(aKey);
+        return entities.empty() ? _invalidEntity : entities.front();
+    }
+
+    /**
+     * @brief Get the number of Entities whose Component has a key.
+     *
+     * @param[in] aKey  Key to count.
+     */
+    inline size_t count(const K& aKey) {
+        return find(aKey).size();
+    }
+
+protected:
+    /// Forget all the keys.
+    virtual void clearKeys() {
+        mBuckets.clear();
+        mEntries.clear();
+    }
+
+    /// Set the key of an Entity, inserting it if needed.
+    virtual void setKey(Entity aEntity, const K& aKey) {
+        auto entry = mEntries.find(aEntity);
+        if (mEntries.end() != entry) {
+            if (entry->second.mKey == aKey) {
+                return;
+            }
+            removeFromBucket(entry->second);
+            entry->second.mKey = aKey;
+            entry->second.mPosition = appendToBucket(aEntity, aKey);
+        } else {
+            const Entry newEntry = {aKey, appendToBucket(aEntity, aKey)};
+            mEntries.insert(std::make_pair(aEntity, newEntry));
+        }
+    }
+
+    /// Forget the key of an Entity, if any.
+    virtual void eraseKey(Entity aEntity) {
+        auto entry = mEntries.find(aEntity);
+        if (mEntries.end() != entry) {
+            removeFromBucket(entry->second);
+            mEntries.erase(entry);
+        }
+    }
+
+private:
+    /// Key of an Entity, with its position in the array of its key.
+    struct Entry {
+        K       mKey;       ///< Key of the Component of the Entity
+        size_t  mPosition;  ///< Position of the Entity in the array of its key
+    };
+
+    /// Append an Entity to the array of a key, returning its position.
+    inline size_t appendToBucket(Entity aEntity, const K& aKey) {
+        std::vector<Entity>& entities = mBuckets[aKey];
+        entities.push_back(aEntity);
+        return entities.size() - 1;
+    }
+
+    /// Remove an Entity from the array of its key, moving the last one in its place.
+    inline void removeFromBucket(const Entry& aEntry) {
+        auto bucket = mBuckets.find(aEntry.mKey);
+        std::vector<Entity>& entities = bucket->second;
+        const Entity last = entities.back();
+        entities[aEntry.mPosition] = last;
+        mEntries.find(last)->second.mPosition = aEntry.mPosition;
+        entities.pop_back();
+        if (entities.empty()) {
+            mBuckets.erase(bucket);
+        }
+    }
+
+    std::unordered_map<K, std::vector<Entity> > mBuckets;       ///< Entities of each key
+    std::unordered_map<Entity, Entry>           mEntries;       ///< Key of each indexed Entity
+    const std::vector<Entity>                   mNoEntities;    ///< Empty array, for missing keys
+};
+
+/**
+ * @brief   A sorted index finds the Entities whose Component has a key in a range, in logarithmic time.
+ * @ingroup ecs
+ *
+ *  Entities are kept sorted by key, then by Entity.
+ *
+ * @tparam C    A structure derived from Component, of a certain type of Component.
+ * @tparam K    Type of the key, with an operator<.
+ */
+template<typename C, typename K>
+class SortedIndex : public SecondaryIndex<C, K> {
+public:
+    /**
+     * @brief Constructor (see ComponentStore::addSortedIndex()).
+     *
+     * @param[in] aStore        ComponentStore owning the index.
+     * @param[in] aKeyFunction  Function computing the key of a Component.
+     */
+    SortedIndex(const ComponentStore<C>& aStore, typename SecondaryIndex<C, K>::KeyFunction&& aKeyFunction) :
+        SecondaryIndex<C, K>(aStore, std::move(aKeyFunction)),
+        mSortedEntities(),
+        mKeys() {
+    }
+
+    /// Destructor.
+    virtual ~SortedIndex() {
+    }
+
+    /**
+     * @brief Find the Entities whose Component has a key in a range, in increasing order of keys.
+     *
+     * @param[in]  aMin         Minimum key (included).
+     * @param[in]  aMax         Maximum key (included).
+     * @param[out] aEntities    List receiving the Entities found (appended).
+     *
+     * @return Number of Entities found.
+     */
+    size_t findRange(const K& aMin, const K& aMax, std::vector<Entity>& aEntities) {
+        this->refresh();
+        size_t nbEntities = 0;
+        for (auto entry  = mSortedEntities.lower_bound(std::make_pair(aMin, std::numeric_limits<Entity>::min()));
+                  entry != mSortedEntities.end() && !(aMax < entry->first);
+                ++entry) {
+            aEntities.push_back(entry->second);
+            ++nbEntities;
+        }
+        return nbEntities;
+    }
+
+    /**
+     * @brief Find the Entities whose Component has a key.
+     *
+     * @param[in]  aKey         Key to find.
+     * @param[out] aEntities    List receiving the Entities found (appended).
+     *
+     * @return Number of Entities found.
+     */
+    inline size_t find(const K& aKey, std::vector<Entity>& aEntities) {
+        return findRange(aKey, aKey, aEntities);
+    }
+
+protected:
+    /// Forget all the keys.
+    virtual void clearKeys() {
+        mSortedEntities.clear();
+        mKeys.clear();
+    }
+
+    /// Set the key of an Entity, inserting it if needed.
+    virtual void setKey(Entity aEntity, const K& aKey) {
+        auto key = mKeys.find(aEntity);
+        if (mKeys.end() != key) {
+            if (!(key->second < aKey) && !(aKey < key->second)) {
+                return;
+            }
+            mSortedEntities.erase(std::make_pair(key->second, aEntity));
+            key->second = aKey;
+        } else {
+            mKeys.insert(std::make_pair(aEntity, aKey));
+        }
+        mSortedEntities.insert(std::make_pair(aKey, aEntity));
+    }
+
+    /// Forget the key of an Entity, if any.
+    virtual void eraseKey(Entity aEntity) {
+        auto key = mKeys.find(aEntity);
+        if (mKeys.end() != key) {
+            mSortedEntities.erase(std::make_pair(key->second, aEntity));
+            mKeys.erase(key);
+        }
+    }
+
+private:
+    std::set<std::pair<K, Entity> > mSortedEntities;    ///< Indexed Entities, sorted by key
+    std::unordered_map<Entity, K>   mKeys;              ///< Key of each indexed Entity
+};
+
+} // namespace ecs
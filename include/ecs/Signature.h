@@ -0,0 +1,220 @@
+/**
+ * @file    Signature.h
+ * @ingroup ecs
+ * @brief   A ecs::Signature is a fixed size set of bits, one for each ecs::ComponentType of an ecs::Entity.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/ComponentType.h>
+
+#include <stdexcept>
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>  // _BitScanForward64
+#endif
+
+/**
+ * @brief Max number of ComponentTypes (valid ComponentType are in [1; ECS_MAX_COMPONENT_TYPES[).
+ *
+ *  Can be defined at build time to a multiple of 64, to allow for more ComponentTypes.
+ */
+#ifndef ECS_MAX_COMPONENT_TYPES
+#define ECS_MAX_COMPONENT_TYPES 128
+#endif
+
+/**
+ * @brief Number of the highest ComponentTypes reserved to runtime types of Component (see BlobComponentStore).
+ *
+ *  Can be defined at build time, lower than ECS_MAX_COMPONENT_TYPES.
+ */
+#ifndef ECS_RUNTIME_COMPONENT_TYPES
+#define ECS_RUNTIME_COMPONENT_TYPES 16
+#endif
+
+namespace ecs {
+
+/**
+ * @brief   Max number of ComponentTypes (valid ComponentType are in [1; _maxComponentTypes[).
+ * @ingroup ecs
+ */
+static const ComponentType _maxComponentTypes = ECS_MAX_COMPONENT_TYPES;
+
+static_assert((0 < ECS_RUNTIME_COMPONENT_TYPES) && (ECS_RUNTIME_COMPONENT_TYPES < ECS_MAX_COMPONENT_TYPES),
+              "ECS_RUNTIME_COMPONENT_TYPES must be lower than ECS_MAX_COMPONENT_TYPES");
+
+/**
+ * @brief   First of the ComponentTypes reserved to runtime types of Component (up to _maxComponentTypes).
+ * @ingroup ecs
+ *
+ *  Component structures and Tags shall use lower ComponentTypes.
+ */
+static const ComponentType _firstRuntimeComponentType = ECS_MAX_COMPONENT_TYPES - ECS_RUNTIME_COMPONENT_TYPES;
+
+/**
+ * @brief   A Signature is a fixed size set of bits, one for each ComponentType of an Entity.
+ * @ingroup ecs
+ *
+ *  The Signature of an Entity lists the Types of all its Components (and Tags) without any allocation,
+ * and matching it against the Components required by a System only takes a few bitwise operations.
+ */
+class Signature {
+    static_assert((ECS_MAX_COMPONENT_TYPES % 64) == 0, "ECS_MAX_COMPONENT_TYPES must be a multiple of 64");
+
+public:
+    /// Number of 64 bits words
+    static const size_t _nbWords = ECS_MAX_COMPONENT_TYPES / 64;
+
+    /// Constructor of an empty Signature.
+    Signature() {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            mWords[word] = 0;
+        }
+    }
+
+    /**
+     * @brief Constructor from a sorted list of ComponentTypes.
+     *
+     *  Throws std::out_of_range if a ComponentType is not lower than _maxComponentTypes.
+     *
+     * @param[in] aComponentTypes   List of ComponentTypes
+     */
+    explicit Signature(const ComponentTypeSet& aComponentTypes) {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            mWords[word] = 0;
+        }
+        for (auto componentType  = aComponentTypes.begin();
+                  componentType != aComponentTypes.end();
+                ++componentType) {
+            set(*componentType);
+        }
+    }
+
+    /**
+     * @brief Add a ComponentType to the Signature.
+     *
+     *  Throws std::out_of_range if the ComponentType is not lower than _maxComponentTypes.
+     *
+     * @param[in] aComponentType    ComponentType to add.
+     */
+    inline void set(ComponentType aComponentType) {
+        if (aComponentType >= _maxComponentTypes) {
+            throw std::out_of_range("The ComponentType shall be lower than ECS_MAX_COMPONENT_TYPES");
+        }
+        mWords[aComponentType / 64] |= (static_cast<uint64_t>(1) << (aComponentType % 64));
+    }
+
+    /**
+     * @brief Remove a ComponentType from the Signature.
+     *
+     * @param[in] aComponentType    ComponentType to remove.
+     */
+    inline void reset(ComponentType aComponentType) {
+        if (aComponentType < _maxComponentTypes) {
+            mWords[aComponentType / 64] &= ~(static_cast<uint64_t>(1) << (aComponentType % 64));
+        }
+    }
+
+    /**
+     * @brief Test if the Signature has a ComponentType.
+     *
+     * @param[in] aComponentType    ComponentType to test.
+     */
+    inline bool test(ComponentType aComponentType) const {
+        return ((aComponentType < _maxComponentTypes) &&
+                (0 != (mWords[aComponentType / 64] & (static_cast<uint64_t>(1) << (aComponentType % 64)))));
+    }
+
+    /**
+     * @brief Test if the Signature has all the ComponentTypes of another Signature.
+     */
+    inline bool includes(const Signature& aSignature) const {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            if ((mWords[word] & aSignature.mWords[word]) != aSignature.mWords[word]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Test if the Signature has any of the ComponentTypes of another Signature.
+     */
+    inline bool intersects(const Signature& aSignature) const {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            if (0 != (mWords[word] & aSignature.mWords[word])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Test if the Signature has no ComponentType.
+     */
+    inline bool empty() const {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            if (0 != mWords[word]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /// Test if two Signatures have the same ComponentTypes.
+    inline bool operator==(const Signature& aSignature) const {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            if (mWords[word] != aSignature.mWords[word]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    /// Test if two Signatures have different ComponentTypes.
+    inline bool operator!=(const Signature& aSignature) const {
+        return !(*this == aSignature);
+    }
+
+    /**
+     * @brief Call a function for each ComponentType of the Signature, in increasing order.
+     *
+     * @tparam F    Type of the function, or functor, taking a ComponentType parameter.
+     *
+     * @param[in] aFunction Function called for each ComponentType.
+     */
+    template<typename F>
+    inline void forEach(F aFunction) const {
+        for (size_t word = 0; word < _nbWords; ++word) {
+            for (uint64_t bits = mWords[word]; 0 != bits; bits &= (bits - 1)) {
+                aFunction(static_cast<ComponentType>((word * 64) + countTrailingZeros(bits)));
+            }
+        }
+    }
+
+private:
+    /// Index of the lowest bit set of a non-zero word
+    static inline unsigned int countTrailingZeros(uint64_t aBits) {
+#if defined(__GNUC__)
+        return static_cast<unsigned int>(__builtin_ctzll(aBits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+        unsigned long index;
+        _BitScanForward64(&index, aBits);
+        return static_cast<unsigned int>(index);
+#else
+        unsigned int index = 0;
+        for (; 0 == (aBits & 1); aBits >>= 1) {
+            ++index;
+        }
+        return index;
+#endif
+    }
+
+    uint64_t    mWords[_nbWords];   ///< One bit for each ComponentType
+};
+
+} // namespace ecs
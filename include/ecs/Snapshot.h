@@ -0,0 +1,277 @@
+/**
+ * @file    Snapshot.h
+ * @ingroup ecs
+ * @brief   A ecs::Snapshot is an immutable view of ecs::ComponentStore, published at the end of each update.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/Component.h>
+#include <ecs/ComponentType.h>
+#include <ecs/ComponentStore.h>
+
+#include <map>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <algorithm>
+#include <type_traits>
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   Abstract base class of the immutable view of a ComponentStore.
+ * @ingroup ecs
+ */
+class IComponentSnapshot {
+public:
+    /// Shared pointer to an immutable view
+    typedef std::shared_ptr<const IComponentSnapshot> Ptr;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aVersion  Version of the content of the store when the view is taken.
+     */
+    explicit IComponentSnapshot(uint64_t aVersion) :
+        mVersion(aVersion) {
+    }
+
+    /// Destructor.
+    virtual ~IComponentSnapshot() {
+    }
+
+    /// Get the version of the content of the store when the view was taken (see IComponentStore::getVersion()).
+    inline uint64_t getVersion() const {
+        return mVersion;
+    }
+
+private:
+    /// Non copyable
+    IComponentSnapshot(const IComponentSnapshot&);
+    /// Non copyable
+    IComponentSnapshot& operator=(const IComponentSnapshot&);
+
+    uint64_t    mVersion;   ///< Version of the content of the store
+};
+
+/**
+ * @brief   An immutable copy-on-write view of a ComponentStore of trivially copyable Components.
+ * @ingroup ecs
+ *
+ *  The packed arrays of the store are split into chunks of _mChunkSize Components. Taking a new view
+ * compares each chunk with the one of the previous view, and only duplicates the chunks that changed:
+ * unchanged chunks are shared (by reference counting) between consecutive views. A store whose version
+ * did not change is not compared at all: the Manager publishes the previous view again.
+ *
+ * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+ */
+template<typename C>
+class ComponentSnapshot : public IComponentSnapshot {
+    static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+    static_assert(std::is_trivially_copyable<C>::value, "C must be trivially copyable to be compared by chunks");
+
+public:
+    /// Number of Components per chunk
+    static const size_t _mChunkSize = 256;
+
+    /// An immutable chunk of the packed arrays.
+    struct Chunk {
+        std::vector<Entity> mEntities;      ///< Entity of each Component
+        std::vector<C>      mComponents;    ///< Packed Components
+    };
+
+    /**
+     * @brief Take a view of a store, sharing the unchanged chunks of a previous view.
+     *
+     * @param[in] aStore        ComponentStore to copy.
+     * @param[in] apPrevious    Previous view of the same store, or nullptr.
+     */
+    ComponentSnapshot(const ComponentStore<C>& aStore, const ComponentSnapshot<C>* apPrevious) :
+        IComponentSnapshot(aStore.getVersion()),
+        mChunks(),
+        mIndexes(),
+        mSize(aStore.size()),
+        mNbSharedChunks(0) {
+        const std::vector<Entity>& entities = aStore.getEntities();
+        const std::vector<C>& components = aStore.getComponents();
+        bool bSameEntities = (nullptr != apPrevious) && (apPrevious->mSize == mSize);
+
+        mChunks.reserve((mSize + _mChunkSize - 1) / _mChunkSize);
+        for (size_t first = 0; first < mSize; first += _mChunkSize) {
+            const size_t nbComponents = std::min(_mChunkSize, mSize - first);
+            const size_t chunkIndex = first / _mChunkSize;
+            const Chunk* pPrevious = nullptr;
+            if ((nullptr != apPrevious) && (chunkIndex < apPrevious->mChunks.size())) {
+                pPrevious = apPrevious->mChunks[chunkIndex].get();
+            }
+            const bool bChunkSameEntities = (nullptr != pPrevious) && (pPrevious->mEntities.size() == nbComponents) &&
+                (0 == std::memcmp(pPrevious->mEntities.data(), &entities[first], nbComponents * sizeof(Entity)));
+            bSameEntities = bSameEntities && bChunkSameEntities;
+            if (bChunkSameEntities &&
+                (0 == std::memcmp(pPrevious->mComponents.data(), &components[first], nbComponents * sizeof(C)))) {
+                // Unchanged chunk: share it with the previous view
+                mChunks.push_back(apPrevious->mChunks[chunkIndex]);
+                ++mNbSharedChunks;
+            } else {
+                std::shared_ptr<Chunk> chunk(new Chunk());
+                chunk->mEntities.assign(entities.begin() + first, entities.begin() + first + nbComponents);
+                chunk->mComponents.assign(components.begin() + first, components.begin() + first + nbComponents);
+                mChunks.push_back(chunk);
+            }
+        }
+
+        // The index of Entities is also shared as long as no Entity has been added, removed or moved
+        if (bSameEntities) {
+            mIndexes = apPrevious->mIndexes;
+        } else {
+            std::shared_ptr<std::unordered_map<Entity, size_t> > indexes(new std::unordered_map<Entity, size_t>());
+            indexes->reserve(mSize);
+            for (size_t index = 0; index < mSize; ++index) {
+                indexes->insert(std::make_pair(entities[index], index));
+            }
+            mIndexes = indexes;
+        }
+    }
+
+    /// Destructor.
+    virtual ~ComponentSnapshot() {
+    }
+
+    /// Get the number of Components.
+    inline size_t size() const {
+        return mSize;
+    }
+
+    /// Get the number of chunks.
+    inline size_t getNbChunks() const {
+        return mChunks.size();
+    }
+
+    /// Get a chunk, in [0; getNbChunks()[.
+    inline const Chunk& getChunk(size_t aChunkIndex) const {
+        return *mChunks[aChunkIndex];
+    }
+
+    /// Get the number of chunks shared with the previous view (that did not change).
+    inline size_t getNbSharedChunks() const {
+        return mNbSharedChunks;
+    }
+
+    /**
+     * @brief Find the Component of an Entity.
+     *
+     * @return Pointer to the Component associated with the specified Entity, or nullptr if not found.
+     */
+    inline const C* find(Entity aEntity) const {
+        auto index = mIndexes->find(aEntity);
+        if (mIndexes->end() == index) {
+            return nullptr;
+        }
+        return &(mChunks[index->second / _mChunkSize]->mComponents[index->second % _mChunkSize]);
+    }
+
+    /**
+     * @brief Call a function for each Entity with its Component.
+     *
+     * @tparam F    Type of the function, or functor, taking 'Entity aEntity, const C& aComponent' parameters.
+     */
+    template<typename F>
+    inline void forEach(F aFunction) const {
+        for (auto chunk  = mChunks.begin();
+                  chunk != mChunks.end();
+                ++chunk) {
+            for (size_t index = 0; index < (*chunk)->mEntities.size(); ++index) {
+                aFunction((*chunk)->mEntities[index], (*chunk)->mComponents[index]);
+            }
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<const Chunk> >                  mChunks;            ///< Chunks, shared between views
+    std::shared_ptr<const std::unordered_map<Entity, size_t> >  mIndexes;           ///< Index of each Entity
+    size_t                                                      mSize;              ///< Number of Components
+    size_t                                                      mNbSharedChunks;    ///< Number of shared chunks
+};
+
+template<typename C>
+const size_t ComponentSnapshot<C>::_mChunkSize;
+
+/**
+ * @brief   A Snapshot is an immutable view of some ComponentStores, published by the Manager at the end of each update.
+ * @ingroup ecs
+ *
+ *  All views of a Snapshot are taken at the same time, so they are consistent with each other.
+ * Readers (render or network threads) hold the Snapshot by a shared pointer as long as they need it,
+ * without any lock, while the simulation goes on updating the stores.
+ */
+class Snapshot {
+public:
+    /// Shared pointer to an immutable Snapshot
+    typedef std::shared_ptr<const Snapshot> Ptr;
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] aNumber   Number of the Snapshot (incremented at each publication).
+     * @param[in] aViews    Views of the ComponentStores, by type of Component.
+     */
+    Snapshot(uint64_t aNumber, std::map<ComponentType, IComponentSnapshot::Ptr>&& aViews) :
+        mNumber(aNumber),
+        mViews(std::move(aViews)) {
+    }
+
+    /// Destructor.
+    ~Snapshot() {
+    }
+
+    /// Get the number of the Snapshot (incremented at each publication).
+    inline uint64_t getNumber() const {
+        return mNumber;
+    }
+
+    /// Test if the Snapshot has a view of the ComponentStore of a type.
+    template<typename C>
+    inline bool has() const {
+        return (mViews.end() != mViews.find(C::_mType));
+    }
+
+    /**
+     * @brief Get the view of the ComponentStore of a type.
+     *
+     *  Throws std::runtime_error if the Snapshot has no view of this type.
+     */
+    template<typename C>
+    inline const ComponentSnapshot<C>& get() const {
+        auto view = mViews.find(C::_mType);
+        if (mViews.end() == view) {
+            throw std::runtime_error("The Snapshot has no view of this type of Component");
+        }
+        return static_cast<const ComponentSnapshot<C>&>(*(view->second));
+    }
+
+    /// Get the view of a type of Component (or nullptr), to build the next Snapshot.
+    inline IComponentSnapshot::Ptr find(ComponentType aComponentType) const {
+        auto view = mViews.find(aComponentType);
+        return (mViews.end() != view) ? view->second : IComponentSnapshot::Ptr();
+    }
+
+private:
+    /// Non copyable
+    Snapshot(const Snapshot&);
+    /// Non copyable
+    Snapshot& operator=(const Snapshot&);
+
+    uint64_t                                            mNumber;    ///< Number of the Snapshot
+    std::map<ComponentType, IComponentSnapshot::Ptr>    mViews;     ///< Views by type of Component
+};
+
+} // namespace ecs
@@ -0,0 +1,273 @@
+/**
+ * @file    StaticManager.h
+ * @ingroup ecs
+ * @brief   A ecs::StaticManager manages ecs::Entity of a list of ecs::Component types known at compile time.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/Component.h>
+#include <ecs/ComponentStore.h>
+
+#include <tuple>
+#include <vector>
+#include <type_traits>
+#include <stdexcept>
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A list of Component types, known at compile time.
+ * @ingroup ecs
+ */
+template<typename... Cs>
+struct ComponentList {
+};
+
+/**
+ * @brief   Index of a Component type C in a list of Component types Cs, known at compile time.
+ * @ingroup ecs
+ */
+template<typename C, typename... Cs>
+struct ComponentIndex;
+/// @cond
+template<typename C, typename... Cs>
+struct ComponentIndex<C, C, Cs...> {
+    static const size_t _mValue = 0;
+};
+template<typename C, typename D, typename... Cs>
+struct ComponentIndex<C, D, Cs...> {
+    static const size_t _mValue = 1 + ComponentIndex<C, Cs...>::_mValue;
+};
+/// @endcond
+
+/**
+ * @brief   Bitmask of a list of Component types Ts, by their index in a list of Component types, known at compile time.
+ * @ingroup ecs
+ */
+template<typename List, typename... Ts>
+struct ComponentMask;
+/// @cond
+template<typename... Cs>
+struct ComponentMask<ComponentList<Cs...> > {
+    static const uint64_t _mValue = 0;
+};
+template<typename... Cs, typename T, typename... Ts>
+struct ComponentMask<ComponentList<Cs...>, T, Ts...> {
+    static const uint64_t _mValue = (static_cast<uint64_t>(1) << ComponentIndex<T, Cs...>::_mValue)
+                                  | ComponentMask<ComponentList<Cs...>, Ts...>::_mValue;
+};
+/// @endcond
+
+/**
+ * @brief   A StaticManager manages Entities of a list of Component types known at compile time.
+ * @ingroup ecs
+ *
+ *  It is the compile-time counterpart of the Manager, for builds where the list of Component types is fixed:
+ * it holds a tuple of the same ComponentStore, so accessing a store is resolved at compile time,
+ * and the Signature of each Entity is a 64 bits mask, matched against masks computed at compile time.
+ *
+ *  Systems are plain classes (without any virtual method) run by updateSystem(), listing their required
+ * Components with a typedef, and receiving them as references, so the whole update loop can be inlined:
+ * @code
+ * struct SystemMove {
+ *     typedef ecs::ComponentList<Position, Speed> Components;
+ *     void updateEntity(float aElapsedTime, ecs::Entity aEntity, Position& aPosition, Speed& aSpeed);
+ * };
+ * ecs::StaticManager<Position, Speed, Area> manager;
+ * manager.updateSystem(systemMove, 0.016f);
+ * @endcode
+ *
+ * @tparam Cs   List of structures derived from Component (at most 64).
+ */
+template<typename... Cs>
+class StaticManager {
+    static_assert(sizeof...(Cs) <= 64, "A StaticManager supports at most 64 types of Components");
+
+public:
+    /// Bitmask of a list of Component types, computed at compile time.
+    template<typename... Ts>
+    struct Mask {
+        static const uint64_t _mValue = ComponentMask<ComponentList<Cs...>, Ts...>::_mValue;
+    };
+
+    /// Constructor.
+    StaticManager() :
+        mStores(),
+        mRecords(1) { // the invalid Entity 0 is never alive
+    }
+
+    /// Destructor.
+    ~StaticManager() {
+    }
+
+    /**
+     * @brief   Get (access to) the ComponentStore of a certain type of Component, resolved at compile time.
+     */
+    template<typename C>
+    inline ComponentStore<C>& getComponentStore() {
+        return std::get<ComponentIndex<C, Cs...>::_mValue>(mStores);
+    }
+    /**
+     * @brief   Get (read-only access to) the ComponentStore of a certain type of Component.
+     */
+    template<typename C>
+    inline const ComponentStore<C>& getComponentStore() const {
+        return std::get<ComponentIndex<C, Cs...>::_mValue>(mStores);
+    }
+
+    /**
+     * @brief   Create a new Entity.
+     */
+    inline Entity createEntity() {
+        Record record = {0, true};
+        mRecords.push_back(record);
+        return static_cast<Entity>(mRecords.size() - 1);
+    }
+
+    /**
+     * @brief   Test if the Entity exists.
+     */
+    inline bool hasEntity(const Entity aEntity) const {
+        return (aEntity < mRecords.size()) && mRecords[aEntity].mbAlive;
+    }
+
+    /**
+     * @brief   Destroy an Entity, removing all its Components.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     */
+    inline void destroyEntity(const Entity aEntity) {
+        getRecord(aEntity);
+        // Remove the Component of each type present in the mask of the Entity
+        const int expand[] = {0, (removeComponentIfAny<Cs>(aEntity), 0)...};
+        (void)expand;
+        mRecords[aEntity].mbAlive = false;
+    }
+
+    /**
+     * @brief   Add (move) a Component associated to an Entity.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @return true if insertion succeeded
+     */
+    template<typename C>
+    inline bool addComponent(const Entity aEntity, C&& aComponent) {
+        Record& record = getRecord(aEntity);
+        const bool bInserted = getComponentStore<C>().add(aEntity, std::move(aComponent));
+        record.mMask |= Mask<C>::_mValue;
+        return bInserted;
+    }
+
+    /**
+     * @brief   Remove the Component of a certain type associated to an Entity.
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @return true if the Component has been removed
+     */
+    template<typename C>
+    inline bool removeComponent(const Entity aEntity) {
+        Record& record = getRecord(aEntity);
+        record.mMask &= ~Mask<C>::_mValue;
+        return getComponentStore<C>().remove(aEntity);
+    }
+
+    /**
+     * @brief   Test if an Entity has all the Components of a list of types, with one mask comparison.
+     */
+    template<typename... Ts>
+    inline bool hasComponents(const Entity aEntity) const {
+        return hasEntity(aEntity) && ((mRecords[aEntity].mMask & Mask<Ts...>::_mValue) == Mask<Ts...>::_mValue);
+    }
+
+    /**
+     * @brief   Get the mask of the Components of an Entity (bits ordered like the types of the StaticManager).
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     */
+    inline uint64_t getMask(const Entity aEntity) const {
+        return getRecord(aEntity).mMask;
+    }
+
+    /**
+     * @brief   Update all Entities having all the Components required by a System.
+     *
+     *  Walks the packed array of the first required Component type (list it first if it is the rarest),
+     * matching the mask of each Entity, and calls the non-virtual method
+     * 'void updateEntity(float aElapsedTime, Entity aEntity, C1& aComponent1, C2& aComponent2...)'
+     * of the System, with the Components listed by its 'Components' typedef.
+     *
+     *  The System shall not add or remove Components of the required types while being updated.
+     *
+     * @tparam S    Type of the System, with a 'typedef ComponentList<C1, C2...> Components;'.
+     *
+     * @param[in] aSystem       The System to update.
+     * @param[in] aElapsedTime  Elapsed time since last update call, in seconds.
+     *
+     * @return Number of updated Entities
+     */
+    template<typename S>
+    inline size_t updateSystem(S& aSystem, float aElapsedTime) {
+        return updateSystem(aSystem, aElapsedTime, typename S::Components());
+    }
+
+private:
+    /// Compile-time signature of an Entity.
+    struct Record {
+        uint64_t    mMask;      ///< Bitmask of the types of Components of the Entity
+        bool        mbAlive;    ///< Is the Entity alive (not destroyed)?
+    };
+
+    /// Get the record of an existing Entity, or throw.
+    inline Record& getRecord(const Entity aEntity) {
+        if (!hasEntity(aEntity)) {
+            throw std::runtime_error("The Entity does not exist");
+        }
+        return mRecords[aEntity];
+    }
+    /// Get the record of an existing Entity, or throw.
+    inline const Record& getRecord(const Entity aEntity) const {
+        if (!hasEntity(aEntity)) {
+            throw std::runtime_error("The Entity does not exist");
+        }
+        return mRecords[aEntity];
+    }
+
+    /// Remove the Component of a type if the Entity has one.
+    template<typename C>
+    inline void removeComponentIfAny(const Entity aEntity) {
+        if (0 != (mRecords[aEntity].mMask & Mask<C>::_mValue)) {
+            removeComponent<C>(aEntity);
+        }
+    }
+
+    /// Update all Entities having all the required Components (unpacked from the list).
+    template<typename S, typename R, typename... Rs>
+    inline size_t updateSystem(S& aSystem, float aElapsedTime, ComponentList<R, Rs...>) {
+        size_t nbUpdatedEntities = 0;
+        const uint64_t mask = Mask<R, Rs...>::_mValue;
+        ComponentStore<R>& store = getComponentStore<R>();
+        const std::vector<Entity>& entities = store.getEntities();
+        for (size_t index = 0; index < entities.size(); ++index) {
+            const Entity entity = entities[index];
+            if ((mRecords[entity].mMask & mask) == mask) {
+                aSystem.updateEntity(aElapsedTime, entity, store.getAt(index), getComponentStore<Rs>().get(entity)...);
+                ++nbUpdatedEntities;
+            }
+        }
+        return nbUpdatedEntities;
+    }
+
+    std::tuple<ComponentStore<Cs>...>   mStores;    ///< One ComponentStore per type of Component
+    std::vector<Record>                 mRecords;   ///< Signature of each Entity, indexed by Entity
+};
+
+} // namespace ecs
@@ -11,10 +11,14 @@
 #pragma once
 
 #include <ecs/ComponentType.h>
+#include <ecs/ComponentFilter.h>
 #include <ecs/Entity.h>
+#include <ecs/AllocationTracker.h>
 
-#include <set>
+#include <vector>
+#include <unordered_map>
 #include <memory>
+#include <cstdint>
 
 namespace ecs {
 
@@ -29,6 +33,13 @@ class Manager;
  *
  *  This is a base class that needs to be subclassed.
  *
+ *  Matching Entities are kept in a packed array, with active Entities first: only those are updated.
+ * Entities can be put to sleep, and woken up, in constant time, either manually (see Manager::sleepEntity())
+ * or by a sleep policy (see setSleepPolicy()).
+ *
+ *  An expensive System can be time-sliced (see setTimeSlice()): each call to updateEntities() then resumes
+ * a sweep over the active Entities where the previous call stopped, until its budget is exhausted.
+ *
  * @todo Add an additional Entity list, matching an other Component list, to work with (for collision for instance)
  */
 class System {
@@ -36,6 +47,37 @@ public:
     /// A shared pointer to a System is needed to add multiple entry into the vector of Systems, for multi-execution.
     typedef std::shared_ptr<System> Ptr;
 
+    /**
+     * @brief Saved registration of Entities of a System (see Rollback), reused from a save to the next.
+     */
+    struct State {
+        std::vector<Entity>                 mEntities;          ///< Packed array of registered Entities
+        std::vector<unsigned int>           mIdleFrames;        ///< Number of idle frames of each Entity
+        std::unordered_map<Entity, size_t>  mIndexes;           ///< Index of each Entity in the packed array
+        size_t                              mNbActiveEntities;  ///< Number of active Entities
+        float                               mTickTimer;         ///< Time accumulated toward the next run
+        float                               mTickElapsed;       ///< Time really elapsed since the last run
+        std::vector<uint32_t>               mSweeps;            ///< Last sweep in which each Entity was updated
+        std::vector<double>                 mUpdateTimes;       ///< Time of the last update of each Entity
+        size_t                              mCursor;            ///< Position of the time-slicing cursor
+        uint32_t                            mSweep;             ///< Number of the current sweep
+        size_t                              mNbPendingEntities; ///< Active Entities not yet updated by the sweep
+        size_t                              mNbSweepFrames;     ///< Calls to updateEntities() in the current sweep
+        size_t                              mNbFramesPerSweep;  ///< Calls to updateEntities() of the last sweep
+        double                              mSliceTime;         ///< Time accumulated by time-sliced updates
+    };
+
+    /**
+     * @brief Phases of a frame, in order of execution by Manager::updateFrame().
+     */
+    enum Phase {
+        ePreUpdate = 0, ///< Run once at the beginning of each frame
+        eFixedUpdate,   ///< Run zero or more times per frame, with a fixed time step
+        eUpdate,        ///< Run once per frame, with the variable elapsed time (default)
+        ePostUpdate,    ///< Run once at the end of each frame
+        eNbPhases       ///< Number of phases
+    };
+
     /**
      * @brief Constructor.
      *
@@ -52,7 +94,14 @@ public:
      * @brief Get the Types of all the Components required by the System.
      */
     inline const ComponentTypeSet& getRequiredComponents() const {
-        return mRequiredComponents;
+        return mFilter.getRequiredComponents();
+    }
+
+    /**
+     * @brief Get the filter (required, excluded and optional Components) used to match Entities with the System.
+     */
+    inline const ComponentFilter& getFilter() const {
+        return mFilter;
     }
 
     /**
@@ -62,20 +111,33 @@ public:
      *
      * @return true if the Entity has been inserted successfully
      */
-    inline bool registerEntity(Entity aEntity) {
-        return mMatchingEntities.insert(aEntity).second;
-    }
+    bool registerEntity(Entity aEntity);
 
     /**
-     * @brief Register a matching Entity, having all required Components.
+     * @brief Register a list of new matching Entities at once (see Manager::instantiate()).
+     *
+     * @param[in] apEntities    List of matching Entities
+     * @param[in] aNbEntities   Number of Entities in the list
+     */
+    void registerEntities(const Entity* apEntities, size_t aNbEntities);
+
+    /**
+     * @brief Reserve memory for a number of registered Entities, so that registering them does not grow the arrays.
+     *
+     *  The hash map of indexes is also sized to avoid rehashing, but each registration still allocates a node.
+     *
+     * @param[in] aNbEntities   Number of Entities.
+     */
+    void reserveEntities(size_t aNbEntities);
+
+    /**
+     * @brief Unregister an Entity.
      *
      * @param[in] aEntity   Matching Entity
      *
      * @return 1 if the Entity has been removed successfully, 0 otherwize
      */
-    inline size_t unregisterEntity(Entity aEntity) {
-        return mMatchingEntities.erase(aEntity);
-    }
+    size_t unregisterEntity(Entity aEntity);
 
     /**
      * @brief Test if the System has registered this Entity.
@@ -85,11 +147,186 @@ public:
      * @return true if finding the Entity succeeded.
      */
     inline bool hasEntity(Entity aEntity) const {
-        return (mMatchingEntities.end() != mMatchingEntities.find(aEntity));
+        return (mIndexes.end() != mIndexes.find(aEntity));
     }
 
     /**
-     * @brief Update function - for all matching Entities.
+     * @brief Test if the System has registered this Entity as active (updated by updateEntities()).
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     */
+    inline bool isEntityActive(Entity aEntity) const {
+        auto index = mIndexes.find(aEntity);
+        return (mIndexes.end() != index) && (index->second < mNbActiveEntities);
+    }
+
+    /**
+     * @brief Get the number of registered Entities, active or sleeping.
+     */
+    inline size_t getNbEntities() const {
+        return mEntities.size();
+    }
+
+    /**
+     * @brief Get the number of active Entities, updated by updateEntities().
+     */
+    inline size_t getNbActiveEntities() const {
+        return mNbActiveEntities;
+    }
+
+    /**
+     * @brief Get the packed array of registered Entities: the getNbActiveEntities() first ones are active.
+     */
+    inline const std::vector<Entity>& getEntities() const {
+        return mEntities;
+    }
+
+    /**
+     * @brief Put a registered Entity to sleep: it is not updated anymore until woken up.
+     *
+     *  Can be called from updateEntity(), even for any other Entity: each active Entity is still updated at most once
+     * by the call, and a sleeping one is never updated.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     *
+     * @return true if the Entity was active
+     */
+    bool sleepEntity(Entity aEntity);
+
+    /**
+     * @brief Wake up a sleeping Entity (and reset its count of idle frames).
+     *
+     *  Can be called from updateEntity(); the Entity is then only updated from the next call.
+     *
+     * @param[in] aEntity   Id of the Entity.
+     *
+     * @return true if the Entity was sleeping
+     */
+    bool wakeEntity(Entity aEntity);
+
+    /**
+     * @brief Put Entities to sleep when their Component of a certain type has not changed for a number of frames.
+     *
+     *  Applied by Manager::updateFrame(), using the changes tracked by the ComponentStore of this type: only
+     * Components added, or marked as changed (with ComponentStore::modify() or markChanged()), wake up Entities.
+     *
+     * @param[in] aComponentType    Type of the watched Components.
+     * @param[in] aNbIdleFrames     Number of frames without change before sleeping (0 to disable the policy).
+     */
+    inline void setSleepPolicy(ComponentType aComponentType, unsigned int aNbIdleFrames) {
+        mSleepComponentType = aComponentType;
+        mSleepIdleFrames = aNbIdleFrames;
+    }
+
+    /**
+     * @brief Get the type of the Components watched by the sleep policy (_invalidComponentType if disabled).
+     */
+    inline ComponentType getSleepComponentType() const {
+        return (0 < mSleepIdleFrames) ? mSleepComponentType : _invalidComponentType;
+    }
+
+    /**
+     * @brief Apply the sleep policy for one frame: wake up the changed Entities, and age all other active ones.
+     *
+     * @param[in] aAddedEntities    Entities whose watched Component has been added during the frame.
+     * @param[in] aChangedEntities  Entities whose watched Component has been changed during the frame.
+     *
+     * @return Number of Entities put to sleep.
+     */
+    size_t applySleepPolicy(const std::vector<Entity>& aAddedEntities, const std::vector<Entity>& aChangedEntities);
+
+    /**
+     * @brief Apply the sleep policy for one frame: wake up the changed Entities, and age all other active ones.
+     *
+     * @param[in] aChangedEntities  Entities whose watched Component has been added or changed during the frame.
+     *
+     * @return Number of Entities put to sleep.
+     */
+    inline size_t applySleepPolicy(const std::vector<Entity>& aChangedEntities) {
+        return applySleepPolicy(aChangedEntities, std::vector<Entity>());
+    }
+
+    /**
+     * @brief Get the phase of the frame in which the System is run by Manager::updateFrame().
+     */
+    inline Phase getPhase() const {
+        return mPhase;
+    }
+
+    /**
+     * @brief Specify the phase of the frame in which the System is run by Manager::updateFrame().
+     *
+     * @param[in] aPhase    Phase of the frame (eUpdate by default).
+     */
+    inline void setPhase(Phase aPhase) {
+        mPhase = aPhase;
+    }
+
+    /**
+     * @brief Get the period between two runs of the System, in seconds (0 when run at each call to tick()).
+     */
+    inline float getTickPeriod() const {
+        return mTickPeriod;
+    }
+
+    /**
+     * @brief Limit the rate at which the System is run by tick(), with an optional stagger.
+     *
+     *  Systems sharing the same tick rate can be given different staggers (for instance 0, 1/3 and 2/3)
+     * so that their costs are spread across frames instead of all firing in the same frame.
+     *
+     * @param[in] aTickRate Number of runs per second (0 to run at each call to tick()).
+     * @param[in] aStagger  Fraction of the period [0;1[ already elapsed before the first call to tick().
+     */
+    void setTickRate(float aTickRate, float aStagger = 0.0f);
+
+    /**
+     * @brief Run the System if its tick period has elapsed, else only accumulate the elapsed time.
+     *
+     * @param[in] aElapsedTime  Elapsed time since last call, in seconds.
+     *
+     * @return Number of updated Entities (0 if the System did not run).
+     */
+    size_t tick(float aElapsedTime);
+
+    /**
+     * @brief Spread the update of the active Entities over multiple calls to updateEntities(), with a budget per call.
+     *
+     *  Each call then resumes the current sweep from a persistent cursor, updating each active Entity at most
+     * once per sweep, until a budget is exhausted (at least one Entity is updated per call). Each Entity is given
+     * the time elapsed since its own previous update. Entities registered, woken up, or moved by a swap during
+     * a sweep are still updated exactly once by this sweep; unregistered or sleeping ones are skipped.
+     *
+     *  Restarts the current sweep.
+     *
+     * @param[in] aMaxEntities  Maximum number of Entities updated per call (0 for no limit).
+     * @param[in] aMaxTime      Maximum time spent per call, in seconds (0 for no limit).
+     */
+    void setTimeSlice(size_t aMaxEntities, float aMaxTime = 0.0f);
+
+    /**
+     * @brief Test if the updates of the System are time-sliced (see setTimeSlice()).
+     */
+    inline bool isTimeSliced() const {
+        return (0 < mSliceMaxEntities) || (0.0f < mSliceMaxTime);
+    }
+
+    /**
+     * @brief Get the number of active Entities not yet updated by the current sweep (when time-sliced).
+     */
+    inline size_t getNbPendingEntities() const {
+        return mNbPendingEntities;
+    }
+
+    /**
+     * @brief Get the number of calls to updateEntities() taken by the last complete sweep (when time-sliced).
+     */
+    inline size_t getNbFramesPerSweep() const {
+        return mNbFramesPerSweep;
+    }
+
+    /**
+     * @brief Update function - for all matching Entities, or for the next time slice of them (see setTimeSlice()).
      *
      * @param[in] aElapsedTime  Elapsed time since last update call, in seconds.
      *
@@ -97,6 +334,13 @@ public:
      */
     size_t updateEntities(float aElapsedTime);
 
+    /**
+     * @brief Get the allocations made by the last call to updateEntities() (see AllocationTracker).
+     */
+    inline const AllocationTracker::Counters& getAllocations() const {
+        return mAllocations;
+    }
+
     /**
      * @brief Update function - for a given matching Entity - virtual pure.
      *
@@ -105,6 +349,30 @@ public:
      */
     virtual void updateEntity(float aElapsedTime, Entity aEntity) = 0;
 
+    /**
+     * @brief Called at the end of updateEntities(), once all active Entities have been updated (does nothing).
+     *
+     *  Can be specialized to finish work started by updateEntity(), for instance to launch a last partial batch.
+     *
+     * @param[in] aElapsedTime  Elapsed time since last update call, in seconds.
+     */
+    virtual void endUpdateEntities(float aElapsedTime);
+
+    /**
+     * @brief Save the registered Entities, with their sleeping state, the tick timer, and the current sweep.
+     *
+     * @param[out] aState   State receiving a copy (reusing its memory).
+     */
+    void saveState(State& aState) const;
+
+    /**
+     * @brief Restore the registered Entities, with their sleeping state, the tick timer, and the current sweep
+     *        (without matching).
+     *
+     * @param[in] aState    State saved by saveState().
+     */
+    void restoreState(const State& aState);
+
 protected:
     /**
      * @brief Specify what are required Components of te System.
@@ -112,7 +380,29 @@ protected:
      * @param[in] aRequiredComponents   List the Types of all the Components required by the System.
      */
     inline void setRequiredComponents(ComponentTypeSet&& aRequiredComponents) {
-        mRequiredComponents = std::move(aRequiredComponents);
+        mFilter.setRequiredComponents(std::move(aRequiredComponents));
+    }
+
+    /**
+     * @brief Specify what are excluded Components of the System.
+     *
+     *  An Entity having any of those Components is never registered to the System.
+     *
+     * @param[in] aExcludedComponents   List the Types of all the Components excluded by the System.
+     */
+    inline void setExcludedComponents(ComponentTypeSet&& aExcludedComponents) {
+        mFilter.setExcludedComponents(std::move(aExcludedComponents));
+    }
+
+    /**
+     * @brief Specify what are optional Components of the System.
+     *
+     *  Optional Components are not used to match Entities; they are accessed with ComponentStore::find() if present.
+     *
+     * @param[in] aOptionalComponents   List the Types of all the Components optionally accessed by the System.
+     */
+    inline void setOptionalComponents(ComponentTypeSet&& aOptionalComponents) {
+        mFilter.setOptionalComponents(std::move(aOptionalComponents));
     }
 
     /**
@@ -122,14 +412,47 @@ protected:
 
 private:
     /**
-     * @brief List the Types of all the Components required by the System.
+     * @brief Filter listing the Types of all the Components required, excluded and optional for the System.
      */
-    ComponentTypeSet    mRequiredComponents;
+    ComponentFilter     mFilter;
+
+    /// Swap two registered Entities in the packed array.
+    void swapEntities(size_t aIndex1, size_t aIndex2);
+
+    /// Update the active Entities from the cursor, until the budget of the time slice is exhausted.
+    size_t updateSlice(float aElapsedTime);
+
+    /// Start a new sweep over all the active Entities.
+    void startSweep();
 
     /**
-     * @brief List all the matching Entities having required Components for the System.
+     * @brief Packed array of all the matching Entities having required Components for the System, active first.
      */
-    std::set<Entity>    mMatchingEntities;
+    std::vector<Entity>                 mEntities;
+    std::vector<unsigned int>           mIdleFrames;        ///< Number of idle frames of each Entity
+    std::vector<uint32_t>               mSweeps;            ///< Last sweep in which each Entity was updated
+    std::vector<double>                 mUpdateTimes;       ///< Time of the last update of each Entity (time-sliced)
+    std::unordered_map<Entity, size_t>  mIndexes;           ///< Index of each Entity in the packed array
+    size_t                              mNbActiveEntities;  ///< Number of active Entities, at the beginning
+
+    ComponentType       mSleepComponentType;    ///< Type of the Components watched by the sleep policy
+    unsigned int        mSleepIdleFrames;       ///< Number of idle frames before sleeping (0 to disable)
+
+    Phase               mPhase;         ///< Phase of the frame in which the System is run
+    float               mTickPeriod;    ///< Period between two runs of the System, in seconds (0 for each tick)
+    float               mTickTimer;     ///< Time accumulated toward the next run (including the initial stagger)
+    float               mTickElapsed;   ///< Time really elapsed since the last run of the System
+
+    size_t              mSliceMaxEntities;  ///< Maximum number of Entities updated per call (0 for no limit)
+    float               mSliceMaxTime;      ///< Maximum time spent per call, in seconds (0 for no limit)
+    size_t              mCursor;            ///< Position of the cursor, moving backward in the active Entities
+    uint32_t            mSweep;             ///< Number of the current sweep (0 is never a current sweep)
+    size_t              mNbPendingEntities; ///< Active Entities not yet updated by the current sweep
+    size_t              mNbSweepFrames;     ///< Calls to updateEntities() in the current sweep
+    size_t              mNbFramesPerSweep;  ///< Calls to updateEntities() taken by the last complete sweep
+    double              mSliceTime;         ///< Time accumulated by time-sliced updates, in seconds
+
+    AllocationTracker::Counters mAllocations;   ///< Allocations made by the last call to updateEntities()
 };
 
 } // namespace ecs
@@ -0,0 +1,188 @@
+/**
+ * @file    World.h
+ * @ingroup ecs
+ * @brief   A ecs::World runs multiple independent ecs::Manager shards in parallel.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/Manager.h>
+
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+
+namespace ecs {
+
+/**
+ * @brief   A World runs multiple independent Manager shards in parallel, each on its own thread.
+ * @ingroup ecs
+ *
+ *  Each shard (for instance one per map region) is a complete Manager, with its own Entities, ComponentStores
+ * and Systems, so that Systems never need any lock. Entity Ids hold the Id of the shard that created them,
+ * so they stay globally unique when an Entity migrates to another shard.
+ *
+ *  Migrations are requested by Systems during an update, and applied at the following sync point,
+ * when all shards are done.
+ *
+ *  The first shard is updated by the calling thread, and each other shard by its own worker thread, started once
+ * by the constructor and woken up at each frame, so that a frame neither creates threads nor allocates memory.
+ */
+class World {
+public:
+    /**
+     * @brief Constructor, starting a worker thread for each shard but the first one.
+     *
+     * @param[in] aNbShards Number of Manager shards (at least one, at most 2^_entityShardBits).
+     */
+    explicit World(size_t aNbShards);
+
+    /// Destructor, stopping and joining the worker threads.
+    ~World();
+
+    /**
+     * @brief Get the number of Manager shards.
+     */
+    inline size_t getNbShards() const {
+        return mShards.size();
+    }
+
+    /**
+     * @brief Get (access to) a Manager shard, to create its ComponentStores, Systems and Entities.
+     *
+     * @param[in] aShard    Index of the shard, in [0; getNbShards()[.
+     *
+     * @return  Reference to the Manager shard.
+     */
+    inline Manager& getShard(size_t aShard) {
+        return *(mShards.at(aShard));
+    }
+
+    /**
+     * @brief Find the index of the shard currently holding an Entity.
+     *
+     * @param[in] aEntity   Id of the Entity to find.
+     *
+     * @return  Index of the shard holding the Entity (the shard that created it, unless it has migrated).
+     */
+    size_t findShard(const Entity aEntity) const;
+
+    /**
+     * @brief Request the migration of an Entity from a shard to another, applied at the next sync point.
+     *
+     *  Can be called by a System of the source shard during an update: each shard only appends
+     * to its own list of requests, so no lock is needed.
+     *
+     * @param[in] aFromShard    Index of the shard currently holding the Entity.
+     * @param[in] aEntity       Id of the Entity to migrate.
+     * @param[in] aToShard      Index of the shard to migrate the Entity to.
+     */
+    void requestMigration(size_t aFromShard, const Entity aEntity, size_t aToShard);
+
+    /**
+     * @brief Destroy an Entity in the shard currently holding it, forgetting where it has migrated.
+     *
+     *  Must be called when no shard is being updated. An Entity destroyed away from the shard that created it
+     * gives its index back to this shard, to be reused with the next generation (see Manager::releaseEntity()).
+     *
+     *  Throws std::runtime_error if the Entity does not exist.
+     *
+     * @param[in] aEntity   Id of the Entity to destroy.
+     */
+    void destroyEntity(const Entity aEntity);
+
+    /**
+     * @brief Apply all requested migrations (sync point), in order of shards, then in order of requests.
+     *
+     *  Must be called when no shard is being updated; this is done at the end of updateEntities()/updateFrame().
+     * Requests for Entities no longer held by their source shard (destroyed, or already migrated) are skipped.
+     *
+     *  Throws std::runtime_error if an Entity cannot migrate (see Manager::migrateEntity()): the requests applied
+     * before, and the failed one, are dropped, while the following ones are kept for the next call.
+     *
+     * @return  Number of migrated Entities.
+     */
+    size_t migrateEntities();
+
+    /**
+     * @brief Update all Entities of all Systems of all shards in parallel (see Manager::updateEntities()),
+     *        then apply requested migrations.
+     *
+     * @param[in] aElapsedTime  Elapsed time since last update call, in seconds.
+     *
+     * @return  Number update of Entities of all shards.
+     */
+    size_t updateEntities(float aElapsedTime);
+
+    /**
+     * @brief Run a frame of all shards in parallel (see Manager::updateFrame()), then apply requested migrations.
+     *
+     * @param[in] aElapsedTime  Elapsed time since last frame, in seconds.
+     *
+     * @return  Number update of Entities of all shards.
+     */
+    size_t updateFrame(float aElapsedTime);
+
+private:
+    /// Non copyable
+    World(const World&);
+    /// Non copyable
+    World& operator=(const World&);
+
+    /// Update method of a Manager (updateEntities() or updateFrame()).
+    typedef size_t (Manager::*UpdateMethod)(float);
+
+    /**
+     * @brief Run the update method on all shards in parallel, one thread per shard, then apply migrations.
+     */
+    size_t updateShards(UpdateMethod aUpdateMethod, float aElapsedTime);
+
+    /**
+     * @brief Loop of the worker thread of a shard, running the update method once per frame.
+     *
+     * @param[in] aShard    Index of the shard, in [1; getNbShards()[.
+     */
+    void run(size_t aShard);
+
+    /// A migration request, recorded by the source shard.
+    struct Migration {
+        Entity  mEntity;    ///< Id of the Entity to migrate
+        size_t  mToShard;   ///< Index of the shard to migrate the Entity to
+    };
+
+    /// All Manager shards (never moved in memory, since Systems keep a reference to their Manager).
+    std::vector<std::unique_ptr<Manager> >      mShards;
+
+    /// Per shard list of migration requests, written only by the thread of the source shard.
+    std::vector<std::vector<Migration> >        mMigrations;
+
+    /// Shard currently holding each Entity that has migrated away from the shard that created it.
+    std::unordered_map<Entity, size_t>          mMigratedEntities;
+
+    /// Per shard number of updated Entities of the last frame, written only by the thread of the shard.
+    std::vector<size_t>                         mNbUpdatedEntities;
+
+    /// Per shard exception thrown by the last frame, written only by the thread of the shard.
+    std::vector<std::exception_ptr>             mExceptions;
+
+    std::vector<std::thread>    mThreads;           ///< Worker threads of the shards [1; getNbShards()[
+    std::mutex                  mMutex;             ///< Protects all following members
+    std::condition_variable     mStartCondition;    ///< Signals a new frame, or stopping, to the worker threads
+    std::condition_variable     mDoneCondition;     ///< Signals the end of the frame of a shard to the calling thread
+    UpdateMethod                mUpdateMethod;      ///< Update method of the current frame
+    float                       mElapsedTime;       ///< Elapsed time of the current frame
+    size_t                      mFrame;             ///< Number of the current frame, to wake up the worker threads
+    size_t                      mNbPendingShards;   ///< Number of worker threads still updating the current frame
+    bool                        mbStopping;         ///< Are the worker threads stopping?
+};
+
+} // namespace ecs
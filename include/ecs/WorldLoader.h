@@ -0,0 +1,262 @@
+/**
+ * @file    WorldLoader.h
+ * @ingroup ecs
+ * @brief   A ecs::WorldLoader streams chunked world files, decoded on background threads, into a ecs::Manager.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Entity.h>
+#include <ecs/Component.h>
+#include <ecs/ComponentType.h>
+#include <ecs/Manager.h>
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <unordered_map>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <type_traits>
+#include <cstring>
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A column of decoded Components of a chunk, ready to be added to the Manager.
+ * @ingroup ecs
+ */
+class IComponentBatch {
+public:
+    /// Unique pointer
+    typedef std::unique_ptr<IComponentBatch> Ptr;
+
+    /// Destructor.
+    virtual ~IComponentBatch() {
+    }
+
+    /**
+     * @brief Add (move) the Components to the Manager, one to each Entity of the chunk.
+     *
+     * @param[in] aManager      Manager receiving the Components.
+     * @param[in] apEntities    List of new Entities of the chunk.
+     */
+    virtual void commit(Manager& aManager, const Entity* apEntities) = 0;
+};
+
+/**
+ * @brief   A column of decoded trivially copyable Components of a type.
+ * @ingroup ecs
+ *
+ * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+ */
+template<typename C>
+class ComponentBatch : public IComponentBatch {
+    static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+    static_assert(std::is_trivially_copyable<C>::value, "C must be trivially copyable to be stored in a file");
+
+public:
+    /**
+     * @brief Decode an array of raw Components.
+     *
+     * @param[in] apData        Raw array of Components.
+     * @param[in] aNbComponents Number of Components.
+     */
+    ComponentBatch(const uint8_t* apData, size_t aNbComponents) :
+        mComponents() {
+        mComponents.reserve(aNbComponents);
+        for (size_t i = 0; i < aNbComponents; ++i) {
+            // Copy the raw bytes to an aligned storage, since C may not be default constructible
+            typename std::aligned_storage<sizeof(C), std::alignment_of<C>::value>::type storage;
+            std::memcpy(&storage, apData + (i * sizeof(C)), sizeof(C));
+            mComponents.push_back(*reinterpret_cast<const C*>(&storage));
+        }
+    }
+
+    /// Destructor.
+    virtual ~ComponentBatch() {
+    }
+
+    /// Add (move) the Components to the Manager, one to each Entity of the chunk.
+    virtual void commit(Manager& aManager, const Entity* apEntities) {
+        for (size_t i = 0; i < mComponents.size(); ++i) {
+            aManager.addComponent(apEntities[i], std::move(mComponents[i]));
+        }
+    }
+
+private:
+    std::vector<C>  mComponents;    ///< Decoded Components
+};
+
+/**
+ * @brief   A WorldLoader streams chunked world files (see WorldWriter), decoded on background threads, into a Manager.
+ * @ingroup ecs
+ *
+ *  Each loaded file is a region: its chunks are read and decoded into batches of Components by a pool of
+ * background threads, without touching the Manager. At a sync point of each frame, the main thread calls commit()
+ * to create the Entities of the decoded chunks, add their Components and register them, within a time budget,
+ * so that regions stream in during play without long frames. unload() destroys all Entities of a region.
+ *
+ *  All methods are to be called by the thread owning the Manager.
+ */
+class WorldLoader {
+public:
+    /// Identifies a region, that is a loaded world file.
+    typedef size_t RegionId;
+
+    /**
+     * @brief Constructor, starting the background threads.
+     *
+     * @param[in] aNbThreads    Number of background threads reading and decoding chunks (at least one).
+     */
+    explicit WorldLoader(size_t aNbThreads = 1);
+
+    /// Destructor, discarding all pending chunks and joining the background threads.
+    ~WorldLoader();
+
+    /**
+     * @brief Register a type of Component that can be decoded from world files (before loading any file).
+     *
+     *  Throws std::runtime_error if a file has already been loaded.
+     *
+     * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+     */
+    template<typename C>
+    inline void registerComponent() {
+        static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+        static_assert(std::is_trivially_copyable<C>::value, "C must be trivially copyable to be stored in a file");
+        if (0 != mNextRegionId) {
+            throw std::runtime_error("Types of Component shall be registered before loading any file");
+        }
+        const Decoder decoder = {&decode<C>, sizeof(C)};
+        mDecoders[C::_mType] = decoder;
+    }
+
+    /**
+     * @brief Start loading a world file in the background, as a new region.
+     *
+     * @param[in] aPath     Path of the world file.
+     *
+     * @return  Id of the new region.
+     */
+    RegionId load(const std::string& aPath);
+
+    /**
+     * @brief Commit decoded chunks into the Manager, until the time budget is spent (sync point).
+     *
+     *  At least one decoded chunk is committed (if any), so that loading always progresses.
+     * Each chunk creates its Entities, adds their Components, and registers them to the Systems.
+     *
+     *  Throws std::runtime_error if a chunk could not be read or decoded (the rest of the region goes on loading).
+     *
+     * @param[in] aManager  Manager receiving the Entities.
+     * @param[in] aBudget   Time budget, in seconds.
+     *
+     * @return  Number of created Entities.
+     */
+    size_t commit(Manager& aManager, float aBudget);
+
+    /**
+     * @brief Unload a region: destroy all its committed Entities, and discard its pending chunks.
+     *
+     * @param[in] aRegionId Id of the region.
+     * @param[in] aManager  Manager holding the Entities.
+     *
+     * @return  Number of destroyed Entities.
+     */
+    size_t unload(RegionId aRegionId, Manager& aManager);
+
+    /**
+     * @brief Test if all chunks of a region have been committed.
+     */
+    bool isLoaded(RegionId aRegionId) const;
+
+    /**
+     * @brief Get the number of chunks not yet committed, of all regions (including chunks not yet read).
+     */
+    size_t getNbPendingChunks() const;
+
+    /**
+     * @brief Get the Entities committed for a region (empty for an unknown region).
+     *
+     *  The reference is valid until the next call to commit() or unload().
+     */
+    const std::vector<Entity>& getEntities(RegionId aRegionId) const;
+
+private:
+    /// Non copyable
+    WorldLoader(const WorldLoader&);
+    /// Non copyable
+    WorldLoader& operator=(const WorldLoader&);
+
+    /// Function decoding an array of raw Components into a new batch.
+    typedef IComponentBatch* (*DecodeFunction)(const uint8_t* apData, size_t aNbComponents);
+
+    /// Decoder of a type of Component.
+    struct Decoder {
+        DecodeFunction  mDecode;        ///< Decoding function
+        size_t          mComponentSize; ///< Expected size of a Component
+    };
+
+    /// Decode an array of raw Components of a type into a new batch.
+    template<typename C>
+    static IComponentBatch* decode(const uint8_t* apData, size_t aNbComponents) {
+        return new ComponentBatch<C>(apData, aNbComponents);
+    }
+
+    /// Work for the background threads: read the table of chunks of a file, or read and decode one chunk.
+    struct Task {
+        RegionId    mRegionId;  ///< Region of the file
+        std::string mPath;      ///< Path of the file
+        uint64_t    mOffset;    ///< Offset of the chunk, or 0 for the table of chunks
+        uint64_t    mSize;      ///< Size of the chunk
+    };
+
+    /// A decoded chunk, ready to be committed.
+    struct Chunk {
+        RegionId                        mRegionId;      ///< Region of the chunk
+        size_t                          mNbEntities;    ///< Number of Entities of the chunk
+        std::vector<IComponentBatch::Ptr> mColumns;     ///< One batch of Components per type
+        std::exception_ptr              mError;         ///< Error while reading or decoding the chunk, if any
+    };
+
+    /// A loaded world file.
+    struct Region {
+        size_t              mNbPendingChunks;   ///< Number of chunks (or table of chunks) not yet committed
+        bool                mbUnloaded;         ///< Has the region been unloaded (while chunks were pending)?
+        std::vector<Entity> mEntities;          ///< Committed Entities
+    };
+
+    /// Loop of the background threads.
+    void run();
+
+    /// Read the table of chunks of a file, queuing a Task for each chunk.
+    void readTable(const Task& aTask);
+
+    /// Read and decode a chunk.
+    std::unique_ptr<Chunk> readChunk(const Task& aTask) const;
+
+    /// Account for a chunk that will never be committed (called with the mutex locked).
+    void discardChunk(RegionId aRegionId);
+
+    std::map<ComponentType, Decoder>            mDecoders;      ///< Decoders by type of Component
+    std::vector<std::thread>                    mThreads;       ///< Background threads
+    mutable std::mutex                          mMutex;         ///< Protects all following members
+    std::condition_variable                     mCondition;     ///< Signals new tasks, or stopping
+    bool                                        mbStopping;     ///< Are the background threads stopping?
+    std::deque<Task>                            mTasks;         ///< Tasks of the background threads
+    std::deque<std::unique_ptr<Chunk> >         mChunks;        ///< Decoded chunks, ready to be committed
+    std::unordered_map<RegionId, Region>        mRegions;       ///< Loaded regions
+    RegionId                                    mNextRegionId;  ///< Id of the next region
+};
+
+} // namespace ecs
@@ -0,0 +1,103 @@
+/**
+ * @file    WorldWriter.h
+ * @ingroup ecs
+ * @brief   A ecs::WorldWriter builds a chunked world file, loaded by a ecs::WorldLoader.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+#pragma once
+
+#include <ecs/Component.h>
+#include <ecs/ComponentType.h>
+
+#include <string>
+#include <vector>
+#include <type_traits>
+#include <cstddef>   // size_t
+#include <cstdint>
+
+namespace ecs {
+
+/**
+ * @brief   A WorldWriter builds a chunked world file, loaded by a WorldLoader.
+ * @ingroup ecs
+ *
+ *  A world file is a list of independent chunks (for instance one per cell of a region), each holding
+ * a number of new Entities, with one column of trivially copyable Components for each type:
+ * - header: uint32 magic "ECSW", uint32 version, uint32 number of chunks, uint32 reserved,
+ *   then a table of uint64 offset and uint64 size of each chunk;
+ * - chunk: uint32 number of Entities, uint32 number of columns,
+ *   then for each column: uint32 ComponentType, uint32 size of a Component, and the raw array of Components.
+ *
+ *  Values are stored with the endianness of the writer.
+ */
+class WorldWriter {
+public:
+    /// Identifies a world file ("ECSW" in little endian)
+    static const uint32_t _mMagic = 0x57534345;
+    /// Version of the layout of world files
+    static const uint32_t _mVersion = 1;
+
+    /// Constructor.
+    WorldWriter();
+
+    /// Destructor.
+    ~WorldWriter();
+
+    /**
+     * @brief Begin a new chunk of new Entities.
+     *
+     * @param[in] aNbEntities   Number of Entities of the chunk (each column holds one Component for each of them).
+     */
+    void beginChunk(size_t aNbEntities);
+
+    /**
+     * @brief Add a column of Components of a type to the current chunk, one for each Entity.
+     *
+     *  Throws std::runtime_error if no chunk has begun.
+     *
+     * @tparam C    A trivially copyable structure derived from Component, of a certain type of Component.
+     *
+     * @param[in] apComponents  Array of Components, one for each Entity of the chunk.
+     */
+    template<typename C>
+    inline void addColumn(const C* apComponents) {
+        static_assert(std::is_base_of<Component, C>::value, "C must derived from the Component struct");
+        static_assert(std::is_trivially_copyable<C>::value, "C must be trivially copyable to be stored in a file");
+        addColumn(C::_mType, sizeof(C), apComponents);
+    }
+
+    /**
+     * @brief Add a column of raw Components of a type to the current chunk, one for each Entity.
+     *
+     *  Throws std::runtime_error if no chunk has begun.
+     *
+     * @param[in] aComponentType    Type of the Components.
+     * @param[in] aComponentSize    Size of a Component, in bytes.
+     * @param[in] apComponents      Raw array of Components, one for each Entity of the chunk.
+     */
+    void addColumn(ComponentType aComponentType, size_t aComponentSize, const void* apComponents);
+
+    /// Get the number of chunks.
+    inline size_t getNbChunks() const {
+        return mChunks.size();
+    }
+
+    /**
+     * @brief Write all chunks to a file.
+     *
+     *  Throws std::runtime_error if the file cannot be written.
+     *
+     * @param[in] aPath     Path of the file.
+     */
+    void write(const std::string& aPath) const;
+
+private:
+    std::vector<std::vector<uint8_t> >  mChunks;        ///< Encoded chunks
+    size_t                              mNbEntities;    ///< Number of Entities of the current chunk
+};
+
+} // namespace ecs
@@ -0,0 +1,106 @@
+/**
+ * @file    AllocationTracker.cpp
+ * @ingroup ecs
+ * @brief   The ecs::AllocationTracker counts the dynamic memory allocations of each thread.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/AllocationTracker.h>
+
+#include <cstdlib>
+#include <new>
+
+namespace ecs {
+
+/// Counters of the allocations of each thread (trivial, so usable by operator new at any time).
+static thread_local AllocationTracker::Counters _counters = {0, 0};
+
+// Test if allocations are counted (library built with ECS_TRACK_ALLOCATIONS).
+bool AllocationTracker::isEnabled() {
+#ifdef ECS_TRACK_ALLOCATIONS
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Get the counters of all allocations of the calling thread since its start.
+AllocationTracker::Counters AllocationTracker::getCounters() {
+    return _counters;
+}
+
+// Count an allocation of the calling thread.
+void AllocationTracker::recordAllocation(size_t aSize) {
+    ++_counters.mNbAllocations;
+    _counters.mNbBytes += aSize;
+}
+
+} // namespace ecs
+
+#ifdef ECS_TRACK_ALLOCATIONS
+
+/// Allocate memory with malloc(), calling the new handler until it succeeds.
+static void* allocate(std::size_t aSize) {
+    ecs::AllocationTracker::recordAllocation(aSize);
+    if (0 == aSize) {
+        aSize = 1;
+    }
+    void* pMemory = std::malloc(aSize);
+    while (nullptr == pMemory) {
+        std::new_handler handler = std::get_new_handler();
+        if (nullptr == handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+        pMemory = std::malloc(aSize);
+    }
+    return pMemory;
+}
+
+// Replacements of the global operator new and operator delete, counting allocations.
+
+void* operator new(std::size_t aSize) {
+    return allocate(aSize);
+}
+
+void* operator new[](std::size_t aSize) {
+    return allocate(aSize);
+}
+
+void* operator new(std::size_t aSize, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(aSize);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](std::size_t aSize, const std::nothrow_t&) noexcept {
+    try {
+        return allocate(aSize);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void operator delete(void* apMemory) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete[](void* apMemory) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete(void* apMemory, const std::nothrow_t&) noexcept {
+    std::free(apMemory);
+}
+
+void operator delete[](void* apMemory, const std::nothrow_t&) noexcept {
+    std::free(apMemory);
+}
+
+#endif // ECS_TRACK_ALLOCATIONS
@@ -0,0 +1,63 @@
+/**
+ * @file    AsyncSystem.cpp
+ * @ingroup ecs
+ * @brief   A ecs::AsyncSystem launches asynchronous work on a ecs::Executor, applied back at a later sync point.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/AsyncSystem.h>
+
+#include <chrono>
+
+namespace ecs {
+
+AsyncSystem::AsyncSystem(Manager& aManager, Executor& aExecutor) :
+    System(aManager),
+    mExecutor(aExecutor),
+    mPendingWorks() {
+}
+
+AsyncSystem::~AsyncSystem() {
+    for (auto work  = mPendingWorks.begin();
+              work != mPendingWorks.end();
+            ++work) {
+        work->wait();
+    }
+}
+
+// Apply the Completions of finished work, in order of launch (sync point).
+size_t AsyncSystem::applyCompletions() {
+    size_t nbApplied = 0;
+    while (!mPendingWorks.empty() &&
+           (std::future_status::ready == mPendingWorks.front().wait_for(std::chrono::seconds(0)))) {
+        std::future<Completion> work = std::move(mPendingWorks.front());
+        mPendingWorks.pop_front();
+        const Completion completion = work.get(); // rethrows the exception of the work, if any
+        if (completion) {
+            completion(mManager);
+        }
+        ++nbApplied;
+    }
+    return nbApplied;
+}
+
+// Wait for all pending work, and apply their Completions, in order of launch (sync point).
+size_t AsyncSystem::waitCompletions() {
+    size_t nbApplied = 0;
+    while (!mPendingWorks.empty()) {
+        mPendingWorks.front().wait();
+        nbApplied += applyCompletions();
+    }
+    return nbApplied;
+}
+
+// Launch asynchronous work on the Executor.
+void AsyncSystem::launch(Work&& aWork) {
+    mPendingWorks.push_back(mExecutor.submit(std::move(aWork)));
+}
+
+} // namespace ecs
@@ -0,0 +1,200 @@
+/**
+ * @file    BlobComponentStore.cpp
+ * @ingroup ecs
+ * @brief   A ecs::BlobComponentStore keeps the raw data of a type of ecs::Component defined at runtime.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/BlobComponentStore.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace ecs {
+
+BlobComponentStore::BlobComponentStore(ComponentType aType, const ComponentLayout& aLayout) :
+    IComponentStore(eBlobStore),
+    mType(aType),
+    mLayout(aLayout),
+    mData(),
+    mEntities(),
+    mIndexes(),
+    mbSorted(true) {
+    if (0 == aLayout.getSize()) {
+        throw std::runtime_error("The layout of the Component is empty");
+    }
+}
+
+BlobComponentStore::~BlobComponentStore() {
+}
+
+// Add a zero-initialized Component associated to an Entity.
+void* BlobComponentStore::add(const Entity aEntity) {
+    if (has(aEntity)) {
+        return nullptr;
+    }
+    const size_t index = append(aEntity);
+    markAdded(aEntity);
+    return getAt(index);
+}
+
+// Remove (destroy) the Component associated to an Entity.
+bool BlobComponentStore::remove(Entity aEntity) {
+    auto index = mIndexes.find(aEntity);
+    if (mIndexes.end() == index) {
+        return false;
+    }
+    erase(index);
+    markRemoved(aEntity);
+    return true;
+}
+
+// Test if another store is a BlobComponentStore of the same layout, able to receive the Components.
+bool BlobComponentStore::canMoveTo(const IComponentStore& aTargetStore) const {
+    return (eBlobStore == aTargetStore.getKind()) &&
+           mLayout.isSameAs(static_cast<const BlobComponentStore&>(aTargetStore).getLayout());
+}
+
+// Test if the Components can be copied by clone(): always, as raw bytes.
+bool BlobComponentStore::isCopyable() const {
+    return true;
+}
+
+// Move the Component associated to an Entity into another BlobComponentStore of the same layout.
+bool BlobComponentStore::moveTo(Entity aEntity, IComponentStore& aTargetStore) {
+    if (!canMoveTo(aTargetStore)) {
+        throw std::runtime_error("The target store does not have the same layout");
+    }
+    BlobComponentStore& targetStore = static_cast<BlobComponentStore&>(aTargetStore);
+    auto index = mIndexes.find(aEntity);
+    if (mIndexes.end() == index) {
+        return false;
+    }
+    void* pTarget = targetStore.add(aEntity);
+    const bool bMoved = (nullptr != pTarget);
+    if (bMoved) {
+        std::memcpy(pTarget, getAt(index->second), getStride());
+    }
+    erase(index);
+    markRemoved(aEntity);
+    return bMoved;
+}
+
+// Copy the Component associated to an Entity to a list of Entities (without any Component of this type).
+size_t BlobComponentStore::clone(Entity aEntity, const Entity* apEntities, size_t aNbEntities) {
+    auto index = mIndexes.find(aEntity);
+    if (mIndexes.end() == index) {
+        return 0;
+    }
+    for (size_t i = 0; i < aNbEntities; ++i) {
+        if (has(apEntities[i])) {
+            throw std::runtime_error("The Entity already has a Component of this type");
+        }
+    }
+    const size_t source = index->second;
+    mEntities.reserve(mEntities.size() + aNbEntities);
+    mIndexes.reserve(mIndexes.size() + aNbEntities);
+    for (size_t i = 0; i < aNbEntities; ++i) {
+        const size_t target = append(apEntities[i]);
+        std::memcpy(getAt(target), getAt(source), getStride());
+        markAdded(apEntities[i]);
+    }
+    return aNbEntities;
+}
+
+// Sort the packed arrays by increasing Entities (if not already sorted).
+void BlobComponentStore::sortByEntity() {
+    if (!mbSorted) {
+        touch();
+        std::vector<size_t> order(mEntities.size());
+        for (size_t index = 0; index < order.size(); ++index) {
+            order[index] = index;
+        }
+        const std::vector<Entity>& entities = mEntities;
+        std::sort(order.begin(), order.end(), [&entities](size_t aIndex1, size_t aIndex2) {
+            return entities[aIndex1] < entities[aIndex2];
+        });
+        std::vector<uint64_t>   data(mData.size());
+        std::vector<Entity>     sortedEntities;
+        sortedEntities.reserve(mEntities.size());
+        for (size_t index = 0; index < order.size(); ++index) {
+            std::memcpy(reinterpret_cast<uint8_t*>(data.data()) + (index * getStride()),
+                        getAt(order[index]), getStride());
+            sortedEntities.push_back(mEntities[order[index]]);
+            mIndexes[sortedEntities.back()] = index;
+        }
+        mData.swap(data);
+        mEntities.swap(sortedEntities);
+        mbSorted = true;
+    }
+}
+
+// Reserve memory for a number of Components.
+void BlobComponentStore::reserve(size_t aNbComponents) {
+    mData.reserve(((aNbComponents * getStride()) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+    mEntities.reserve(aNbComponents);
+    mIndexes.reserve(aNbComponents);
+    reserveChanges(aNbComponents);
+}
+
+// Create an empty State, to save the content of the store.
+IComponentStore::State::Ptr BlobComponentStore::createState() const {
+    return IComponentStore::State::Ptr(new State());
+}
+
+// Save the content of the store (a block copy of the packed arrays).
+void BlobComponentStore::saveState(IComponentStore::State& aState) const {
+    State& state = static_cast<State&>(aState);
+    state.mData = mData;
+    state.mEntities = mEntities;
+    state.mIndexes = mIndexes;
+    state.mbSorted = mbSorted;
+}
+
+// Restore the content of the store from a saved State.
+void BlobComponentStore::restoreState(const IComponentStore::State& aState) {
+    touch();
+    const State& state = static_cast<const State&>(aState);
+    mData = state.mData;
+    mEntities = state.mEntities;
+    mIndexes = state.mIndexes;
+    mbSorted = state.mbSorted;
+}
+
+// Append a zero-initialized blob for a new Entity, returning its index.
+size_t BlobComponentStore::append(const Entity aEntity) {
+    touch();
+    const size_t index = mEntities.size();
+    mbSorted = mbSorted && (mEntities.empty() || (mEntities.back() < aEntity));
+    mEntities.push_back(aEntity);
+    mIndexes.insert(std::make_pair(aEntity, index));
+    // The layout alignment is at most 8 bytes: the blobs are stored in an array of 64 bits words
+    const size_t nbWords = (((index + 1) * getStride()) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+    if (mData.size() < nbWords) {
+        mData.resize(nbWords, 0);
+    }
+    std::memset(getAt(index), 0, getStride());
+    return index;
+}
+
+// Remove the Component at an index, moving the last one in its place.
+void BlobComponentStore::erase(std::unordered_map<Entity, size_t>::iterator aIndex) {
+    touch();
+    const size_t index = aIndex->second;
+    const size_t last = mEntities.size() - 1;
+    if (index != last) {
+        mbSorted = false;
+        std::memcpy(getAt(index), getAt(last), getStride());
+        mEntities[index] = mEntities[last];
+        mIndexes[mEntities[index]] = index;
+    }
+    mEntities.pop_back();
+    mIndexes.erase(aIndex);
+    mData.resize(((mEntities.size() * getStride()) + sizeof(uint64_t) - 1) / sizeof(uint64_t));
+}
+
+} // namespace ecs
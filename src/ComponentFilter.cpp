@@ -0,0 +1,42 @@
+/**
+ * @file    ComponentFilter.cpp
+ * @ingroup ecs
+ * @brief   A ecs::ComponentFilter selects ecs::Entity by the types of their ecs::Component.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/ComponentFilter.h>
+
+namespace ecs {
+
+ComponentFilter::ComponentFilter() :
+    mRequiredComponents(),
+    mExcludedComponents(),
+    mOptionalComponents(),
+    mRequiredSignature(),
+    mExcludedSignature() {
+}
+
+ComponentFilter::ComponentFilter(ComponentTypeSet&& aRequiredComponents,
+                                 ComponentTypeSet&& aExcludedComponents /* = ComponentTypeSet() */,
+                                 ComponentTypeSet&& aOptionalComponents /* = ComponentTypeSet() */) :
+    mRequiredComponents(std::move(aRequiredComponents)),
+    mExcludedComponents(std::move(aExcludedComponents)),
+    mOptionalComponents(std::move(aOptionalComponents)),
+    mRequiredSignature(mRequiredComponents),
+    mExcludedSignature(mExcludedComponents) {
+}
+
+ComponentFilter::~ComponentFilter() {
+}
+
+// Test if the Components of an Entity match the filter.
+bool ComponentFilter::matches(const ComponentTypeSet& aEntityComponents) const {
+    return matches(Signature(aEntityComponents));
+}
+
+} // namespace ecs
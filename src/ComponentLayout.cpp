@@ -0,0 +1,117 @@
+/**
+ * @file    ComponentLayout.cpp
+ * @ingroup ecs
+ * @brief   A ecs::ComponentLayout describes the fields of a type of ecs::Component defined at runtime.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/ComponentLayout.h>
+
+#include <stdexcept>
+
+namespace ecs {
+
+ComponentLayout::ComponentLayout(const std::string& aName) :
+    mName(aName),
+    mFields(),
+    mSize(0),
+    mAlignment(1) {
+}
+
+ComponentLayout::~ComponentLayout() {
+}
+
+// Add a field at the next free offset respecting its alignment.
+size_t ComponentLayout::addField(const std::string& aName, FieldType aType) {
+    // Place the field after the end of the fields (the size may include some tail padding)
+    size_t end = 0;
+    for (auto field  = mFields.begin();
+              field != mFields.end();
+            ++field) {
+        const size_t fieldEnd = field->mOffset + getFieldSize(field->mType);
+        if (end < fieldEnd) {
+            end = fieldEnd;
+        }
+    }
+    const size_t alignment = getFieldSize(aType);
+    return addField(aName, aType, ((end + alignment - 1) / alignment) * alignment);
+}
+
+// Add a field at an explicit offset.
+size_t ComponentLayout::addField(const std::string& aName, FieldType aType, size_t aOffset) {
+    const size_t fieldSize = getFieldSize(aType);
+    if (0 != (aOffset % fieldSize)) {
+        throw std::runtime_error("The offset of the field is not aligned for its type");
+    }
+    for (auto field  = mFields.begin();
+              field != mFields.end();
+            ++field) {
+        if (field->mName == aName) {
+            throw std::runtime_error("A field of the same name already exists");
+        }
+        if ((aOffset < (field->mOffset + getFieldSize(field->mType))) && (field->mOffset < (aOffset + fieldSize))) {
+            throw std::runtime_error("The field overlaps another field");
+        }
+    }
+
+    Field field = {aName, aType, aOffset};
+    mFields.push_back(field);
+
+    // Round the size up to the alignment of the Component
+    if (mAlignment < fieldSize) {
+        mAlignment = fieldSize;
+    }
+    if (mSize < (aOffset + fieldSize)) {
+        mSize = aOffset + fieldSize;
+    }
+    mSize = ((mSize + mAlignment - 1) / mAlignment) * mAlignment;
+
+    return (mFields.size() - 1);
+}
+
+// Find a field by name.
+size_t ComponentLayout::findField(const std::string& aName) const {
+    for (size_t index = 0; index < mFields.size(); ++index) {
+        if (mFields[index].mName == aName) {
+            return index;
+        }
+    }
+    throw std::runtime_error("The field does not exist");
+}
+
+// Test if another layout describes the same type of Component: same name, size, and fields.
+bool ComponentLayout::isSameAs(const ComponentLayout& aLayout) const {
+    if ((mName != aLayout.mName) || (mSize != aLayout.mSize) || (mFields.size() != aLayout.mFields.size())) {
+        return false;
+    }
+    for (size_t index = 0; index < mFields.size(); ++index) {
+        if ((mFields[index].mName != aLayout.mFields[index].mName) ||
+            (mFields[index].mType != aLayout.mFields[index].mType) ||
+            (mFields[index].mOffset != aLayout.mFields[index].mOffset)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Get the size (and alignment) of a type of field, in bytes.
+size_t ComponentLayout::getFieldSize(FieldType aType) {
+    size_t size = 0;
+    switch (aType) {
+    case eBool:     size = sizeof(bool);        break;
+    case eInt32:    size = sizeof(int32_t);     break;
+    case eUInt32:   size = sizeof(uint32_t);    break;
+    case eInt64:    size = sizeof(int64_t);     break;
+    case eFloat:    size = sizeof(float);       break;
+    case eDouble:   size = sizeof(double);      break;
+    case eEntity:   size = sizeof(Entity);      break;
+    default:        throw std::runtime_error("Unknown type of field");
+    }
+    return size;
+}
+
+} // namespace ecs
@@ -0,0 +1,51 @@
+/**
+ * @file    EventBus.cpp
+ * @ingroup ecs
+ * @brief   A ecs::EventBus holds typed ecs::EventChannel, sending ecs::Event between ecs::System for one frame.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/EventBus.h>
+
+namespace ecs {
+
+EventBus::EventBus(size_t aNbSlots /* = 1 */) :
+    mArenas(),
+    mChannels(),
+    mFrame(0) {
+    setNbSlots(aNbSlots);
+}
+
+EventBus::~EventBus() {
+}
+
+// Change the number of slots (only before any EventChannel is created).
+void EventBus::setNbSlots(size_t aNbSlots) {
+    if (0 == aNbSlots) {
+        throw std::runtime_error("The EventBus needs at least one slot");
+    }
+    if (!mChannels.empty()) {
+        throw std::runtime_error("The number of slots cannot change once an EventChannel exists");
+    }
+    mArenas.clear();
+    for (size_t slot = 0; slot < aNbSlots; ++slot) {
+        mArenas.push_back(std::unique_ptr<FrameArena>(new FrameArena()));
+    }
+}
+
+// Clear all Events of all EventChannels at once, in O(1) (sync point).
+void EventBus::clear() {
+    // EventChannels lazily forget the batches of the previous frame
+    ++mFrame;
+    for (auto arena  = mArenas.begin();
+              arena != mArenas.end();
+            ++arena) {
+        (*arena)->reset();
+    }
+}
+
+} // namespace ecs
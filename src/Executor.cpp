@@ -0,0 +1,66 @@
+/**
+ * @file    Executor.cpp
+ * @ingroup ecs
+ * @brief   A ecs::Executor runs asynchronous work on a pool of threads, returning futures.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Executor.h>
+
+namespace ecs {
+
+Executor::Executor(size_t aNbThreads /* = 1 */) :
+    mThreads(),
+    mMutex(),
+    mCondition(),
+    mbStopping(false),
+    mTasks() {
+    if (0 == aNbThreads) {
+        aNbThreads = 1;
+    }
+    mThreads.reserve(aNbThreads);
+    for (size_t thread = 0; thread < aNbThreads; ++thread) {
+        mThreads.push_back(std::thread([this]() {
+            run();
+        }));
+    }
+}
+
+Executor::~Executor() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mCondition.notify_all();
+    for (auto thread  = mThreads.begin();
+              thread != mThreads.end();
+            ++thread) {
+        thread->join();
+    }
+}
+
+// Loop of the threads.
+void Executor::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (!mbStopping && mTasks.empty()) {
+                mCondition.wait(lock);
+            }
+            if (mTasks.empty()) {
+                return; // stopping, once all work is done
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+        }
+        // Exceptions are caught by the packaged_task, and stored in its future
+        task();
+    }
+}
+
+} // namespace ecs
@@ -0,0 +1,66 @@
+/**
+ * @file    FrameArena.cpp
+ * @ingroup ecs
+ * @brief   A ecs::FrameArena is a bump allocator for data valid for one frame.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/FrameArena.h>
+
+namespace ecs {
+
+FrameArena::FrameArena(size_t aBlockSize /* = 64 * 1024 */) :
+    mBlockSize(aBlockSize),
+    mBlocks(),
+    mCurrentBlock(0),
+    mOffset(0) {
+}
+
+FrameArena::~FrameArena() {
+    for (auto block  = mBlocks.begin();
+              block != mBlocks.end();
+            ++block) {
+        delete[] block->mpData;
+    }
+}
+
+// Allocate some memory, valid until the next reset().
+void* FrameArena::allocate(size_t aSize, size_t aAlignment) {
+    // Try the current block, then the next ones kept from previous frames, before allocating a new one
+    for (; mCurrentBlock < mBlocks.size(); ++mCurrentBlock, mOffset = 0) {
+        Block& block = mBlocks[mCurrentBlock];
+        const size_t address = reinterpret_cast<size_t>(block.mpData) + mOffset;
+        const size_t padding = (aAlignment - (address & (aAlignment - 1))) & (aAlignment - 1);
+        if (mOffset + padding + aSize <= block.mSize) {
+            mOffset += padding + aSize;
+            return (block.mpData + mOffset - aSize);
+        }
+    }
+
+    // Allocate a new block, large enough for the (aligned) allocation
+    Block block;
+    block.mSize = (aSize + aAlignment > mBlockSize) ? (aSize + aAlignment) : mBlockSize;
+    mBlocks.reserve(mBlocks.size() + 1); // so that push_back cannot throw after the allocation of the block
+    block.mpData = new char[block.mSize];
+    mBlocks.push_back(block);
+    mCurrentBlock = mBlocks.size() - 1;
+    mOffset = 0;
+    return allocate(aSize, aAlignment);
+}
+
+// Get the total size of the blocks of memory allocated from the heap, in bytes.
+size_t FrameArena::getCapacity() const {
+    size_t capacity = 0;
+    for (auto block  = mBlocks.begin();
+              block != mBlocks.end();
+            ++block) {
+        capacity += block->mSize;
+    }
+    return capacity;
+}
+
+} // namespace ecs
@@ -0,0 +1,195 @@
+/**
+ * @file    Hierarchy.cpp
+ * @ingroup ecs
+ * @brief   A ecs::Hierarchy links parent and children ecs::Entity, stored by depth level.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Hierarchy.h>
+
+#include <stdexcept>
+
+namespace ecs {
+
+Hierarchy::Hierarchy() :
+    mNodes(),
+    mLevels() {
+}
+
+Hierarchy::~Hierarchy() {
+}
+
+// Attach an Entity (with its subtree) as the first child of a parent Entity.
+void Hierarchy::attach(const Entity aEntity, const Entity aParent) {
+    if ((_invalidEntity == aEntity) || (_invalidEntity == aParent)) {
+        throw std::runtime_error("Invalid Entity");
+    }
+    // Check that the parent is not in the subtree of the Entity
+    for (Entity ancestor = aParent; _invalidEntity != ancestor; ancestor = getParent(ancestor)) {
+        if (ancestor == aEntity) {
+            throw std::runtime_error("An Entity cannot be attached to itself or to one of its descendants");
+        }
+    }
+
+    Node& parentNode = getOrAddNode(aParent);
+    Node& node = getOrAddNode(aEntity);
+    unlink(node);
+
+    // Link the Entity as the first child of its new parent
+    node.mParent = aParent;
+    node.mNextSibling = parentNode.mFirstChild;
+    if (_invalidEntity != parentNode.mFirstChild) {
+        mNodes[parentNode.mFirstChild].mPrevSibling = aEntity;
+    }
+    parentNode.mFirstChild = aEntity;
+
+    moveSubtree(aEntity, node, parentNode.mDepth + 1);
+}
+
+// Detach an Entity (with its subtree) from its parent, making it a root.
+void Hierarchy::detach(const Entity aEntity) {
+    auto node = mNodes.find(aEntity);
+    if (mNodes.end() == node) {
+        throw std::runtime_error("The Entity is not in the Hierarchy");
+    }
+    unlink(node->second);
+    moveSubtree(aEntity, node->second, 0);
+}
+
+// Remove an Entity from the Hierarchy, its children becoming roots.
+bool Hierarchy::remove(const Entity aEntity) {
+    auto node = mNodes.find(aEntity);
+    if (mNodes.end() == node) {
+        return false;
+    }
+
+    // Detach all children, making them roots
+    Entity child = node->second.mFirstChild;
+    while (_invalidEntity != child) {
+        Node& childNode = mNodes[child];
+        const Entity nextSibling = childNode.mNextSibling;
+        childNode.mParent = _invalidEntity;
+        childNode.mPrevSibling = _invalidEntity;
+        childNode.mNextSibling = _invalidEntity;
+        moveSubtree(child, childNode, 0);
+        child = nextSibling;
+    }
+    node->second.mFirstChild = _invalidEntity;
+
+    unlink(node->second);
+    removeFromLevel(node->second);
+    mNodes.erase(node);
+
+    return true;
+}
+
+// Remove an Entity with its whole subtree from the Hierarchy.
+size_t Hierarchy::removeSubtree(const Entity aEntity, std::vector<Entity>& aRemovedEntities) {
+    auto node = mNodes.find(aEntity);
+    if (mNodes.end() == node) {
+        return 0;
+    }
+    unlink(node->second);
+
+    // List the Entities of the subtree in depth order, using the output list as the queue
+    const size_t first = aRemovedEntities.size();
+    aRemovedEntities.push_back(aEntity);
+    for (size_t index = first; index < aRemovedEntities.size(); ++index) {
+        for (Entity child  = mNodes[aRemovedEntities[index]].mFirstChild;
+                    child != _invalidEntity;
+                    child  = mNodes[child].mNextSibling) {
+            aRemovedEntities.push_back(child);
+        }
+    }
+
+    for (size_t index = first; index < aRemovedEntities.size(); ++index) {
+        auto removedNode = mNodes.find(aRemovedEntities[index]);
+        removeFromLevel(removedNode->second);
+        mNodes.erase(removedNode);
+    }
+
+    return (aRemovedEntities.size() - first);
+}
+
+// Get the depth of an Entity (0 for a root).
+size_t Hierarchy::getDepth(const Entity aEntity) const {
+    auto node = mNodes.find(aEntity);
+    if (mNodes.end() == node) {
+        throw std::runtime_error("The Entity is not in the Hierarchy");
+    }
+    return node->second.mDepth;
+}
+
+// Get the Node of an Entity, adding it as a root if needed.
+Hierarchy::Node& Hierarchy::getOrAddNode(const Entity aEntity) {
+    auto node = mNodes.find(aEntity);
+    if (mNodes.end() == node) {
+        const Node root = {_invalidEntity, _invalidEntity, _invalidEntity, _invalidEntity, 0, 0};
+        node = mNodes.insert(std::make_pair(aEntity, root)).first;
+        addToLevel(aEntity, node->second, 0);
+    }
+    return node->second;
+}
+
+// Unlink an Entity from its parent and siblings (without changing its depth).
+void Hierarchy::unlink(Node& aNode) {
+    if (_invalidEntity != aNode.mParent) {
+        if (_invalidEntity != aNode.mPrevSibling) {
+            mNodes[aNode.mPrevSibling].mNextSibling = aNode.mNextSibling;
+        } else {
+            mNodes[aNode.mParent].mFirstChild = aNode.mNextSibling;
+        }
+        if (_invalidEntity != aNode.mNextSibling) {
+            mNodes[aNode.mNextSibling].mPrevSibling = aNode.mPrevSibling;
+        }
+        aNode.mParent = _invalidEntity;
+        aNode.mPrevSibling = _invalidEntity;
+        aNode.mNextSibling = _invalidEntity;
+    }
+}
+
+// Move an Entity with its whole subtree to a new depth level.
+void Hierarchy::moveSubtree(const Entity aEntity, Node& aNode, size_t aDepth) {
+    if (aDepth == aNode.mDepth) {
+        // Same level: only the parent may have changed, and the subtree stays in place
+        mLevels[aDepth][aNode.mIndex].mParent = aNode.mParent;
+    } else {
+        removeFromLevel(aNode);
+        addToLevel(aEntity, aNode, aDepth);
+        for (Entity child  = aNode.mFirstChild;
+                    child != _invalidEntity;
+                    child  = mNodes[child].mNextSibling) {
+            moveSubtree(child, mNodes[child], aDepth + 1);
+        }
+    }
+}
+
+// Remove an Entity from the array of its level (swap with the last one).
+void Hierarchy::removeFromLevel(const Node& aNode) {
+    std::vector<Link>& level = mLevels[aNode.mDepth];
+    const size_t index = aNode.mIndex;
+    level[index] = level.back();
+    mNodes[level[index].mEntity].mIndex = index;
+    level.pop_back();
+    // Forget the empty deepest levels
+    while (!mLevels.empty() && mLevels.back().empty()) {
+        mLevels.pop_back();
+    }
+}
+
+// Add an Entity at the end of the array of a level.
+void Hierarchy::addToLevel(const Entity aEntity, Node& aNode, size_t aDepth) {
+    if (aDepth >= mLevels.size()) {
+        mLevels.resize(aDepth + 1);
+    }
+    aNode.mDepth = aDepth;
+    aNode.mIndex = mLevels[aDepth].size();
+    const Link link = {aEntity, aNode.mParent};
+    mLevels[aDepth].push_back(link);
+}
+
+} // namespace ecs
@@ -0,0 +1,190 @@
+/**
+ * @file    Join.cpp
+ * @ingroup ecs
+ * @brief   A ecs::Join intersects the packed ecs::Entity arrays of several ecs::ComponentStore.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Join.h>
+
+#include <algorithm>
+
+// SSE2 is always available on x86-64; define ECS_NO_SIMD to use only the scalar code
+#if !defined(ECS_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+#define ECS_JOIN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ecs {
+
+/// Minimal ratio between the sizes of two arrays to use a galloping search instead of a linear merge.
+static const size_t _gallopingRatio = 32;
+
+// Search each Entity of the smallest array into the biggest one, with an exponential then a binary search.
+static void intersectGalloping(const Entity* apSmall, size_t aSmallSize,
+                               const Entity* apLarge, size_t aLargeSize,
+                               std::vector<size_t>& aSmallIndexes, std::vector<size_t>& aLargeIndexes) {
+    size_t low = 0;
+    for (size_t index = 0; (index < aSmallSize) && (low < aLargeSize); ++index) {
+        const Entity entity = apSmall[index];
+        size_t bound = 1;
+        while (((low + bound) < aLargeSize) && (apLarge[low + bound] < entity)) {
+            bound *= 2;
+        }
+        const Entity* pFound = std::lower_bound(apLarge + low + (bound / 2),
+                                                apLarge + std::min(low + bound + 1, aLargeSize),
+                                                entity);
+        low = static_cast<size_t>(pFound - apLarge);
+        if ((low < aLargeSize) && (entity == *pFound)) {
+            aSmallIndexes.push_back(index);
+            aLargeIndexes.push_back(low);
+            ++low;
+        }
+    }
+}
+
+// Merge both arrays linearly, comparing blocks of 4 Entities at once when SSE2 is available.
+static void intersectMerge(const Entity* apEntities1, size_t aSize1,
+                           const Entity* apEntities2, size_t aSize2,
+                           std::vector<size_t>& aIndexes1, std::vector<size_t>& aIndexes2) {
+    size_t index1 = 0;
+    size_t index2 = 0;
+
+#ifdef ECS_JOIN_SSE2
+    static_assert(sizeof(Entity) == 4, "SSE2 blocks hold 4 Entities of 32 bits");
+    while (((index1 + 4) <= aSize1) && ((index2 + 4) <= aSize2)) {
+        const __m128i block1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apEntities1 + index1));
+        const __m128i block2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(apEntities2 + index2));
+        // Compare each Entity of the first block with all 4 rotations of the second block (all 16 pairs)
+        int masks[4];
+        masks[0] = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block1, block2)));
+        masks[1] = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block1,
+                                   _mm_shuffle_epi32(block2, _MM_SHUFFLE(0, 3, 2, 1)))));
+        masks[2] = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block1,
+                                   _mm_shuffle_epi32(block2, _MM_SHUFFLE(1, 0, 3, 2)))));
+        masks[3] = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(block1,
+                                   _mm_shuffle_epi32(block2, _MM_SHUFFLE(2, 1, 0, 3)))));
+        if (0 != (masks[0] | masks[1] | masks[2] | masks[3])) {
+            // Bit k of the mask of rotation r means that Entity k of block1 is Entity (k + r) % 4 of block2
+            for (size_t lane = 0; lane < 4; ++lane) {
+                for (size_t rotation = 0; rotation < 4; ++rotation) {
+                    if (0 != (masks[rotation] & (1 << lane))) {
+                        aIndexes1.push_back(index1 + lane);
+                        aIndexes2.push_back(index2 + ((lane + rotation) % 4));
+                    }
+                }
+            }
+        }
+        // Move past the block(s) ending with the smallest Entity
+        const Entity last1 = apEntities1[index1 + 3];
+        const Entity last2 = apEntities2[index2 + 3];
+        if (last1 <= last2) {
+            index1 += 4;
+        }
+        if (last2 <= last1) {
+            index2 += 4;
+        }
+    }
+#endif
+
+    while ((index1 < aSize1) && (index2 < aSize2)) {
+        if (apEntities1[index1] < apEntities2[index2]) {
+            ++index1;
+        } else if (apEntities2[index2] < apEntities1[index1]) {
+            ++index2;
+        } else {
+            aIndexes1.push_back(index1++);
+            aIndexes2.push_back(index2++);
+        }
+    }
+}
+
+// Intersect two arrays of strictly increasing Entities.
+size_t intersectEntities(const Entity* apEntities1, size_t aSize1,
+                         const Entity* apEntities2, size_t aSize2,
+                         std::vector<size_t>& aIndexes1, std::vector<size_t>& aIndexes2) {
+    const size_t nbIndexes = aIndexes1.size();
+
+    if ((aSize1 * _gallopingRatio) < aSize2) {
+        intersectGalloping(apEntities1, aSize1, apEntities2, aSize2, aIndexes1, aIndexes2);
+    } else if ((aSize2 * _gallopingRatio) < aSize1) {
+        intersectGalloping(apEntities2, aSize2, apEntities1, aSize1, aIndexes2, aIndexes1);
+    } else {
+        intersectMerge(apEntities1, aSize1, apEntities2, aSize2, aIndexes1, aIndexes2);
+    }
+
+    return (aIndexes1.size() - nbIndexes);
+}
+
+Join::Join() :
+    mNbStores(0),
+    mEntities(),
+    mIndexes(),
+    mNextEntities(),
+    mNextIndexes(),
+    mMatches(),
+    mStoreMatches(),
+    mOrder() {
+}
+
+Join::~Join() {
+}
+
+// Compute the Entities having a Component in each ComponentStore.
+size_t Join::compute(IComponentStore* const* apStores, size_t aNbStores) {
+    mNbStores = aNbStores;
+    mEntities.clear();
+    mIndexes.clear();
+    if (0 == aNbStores) {
+        return 0;
+    }
+
+    // Intersect the stores from the smallest to the biggest
+    mOrder.clear();
+    for (size_t store = 0; store < aNbStores; ++store) {
+        apStores[store]->sortByEntity();
+        mOrder.push_back(store);
+    }
+    std::sort(mOrder.begin(), mOrder.end(), [apStores](size_t aStore1, size_t aStore2) {
+        return apStores[aStore1]->getEntities().size() < apStores[aStore2]->getEntities().size();
+    });
+
+    // Start with all the Entities of the smallest store
+    const std::vector<Entity>& smallestEntities = apStores[mOrder[0]]->getEntities();
+    mEntities.assign(smallestEntities.begin(), smallestEntities.end());
+    mIndexes.assign(mEntities.size() * aNbStores, 0);
+    for (size_t row = 0; row < mEntities.size(); ++row) {
+        mIndexes[(row * aNbStores) + mOrder[0]] = row;
+    }
+
+    // Then keep only the rows with an Entity in each next store
+    for (size_t step = 1; (step < aNbStores) && !mEntities.empty(); ++step) {
+        const size_t store = mOrder[step];
+        const std::vector<Entity>& storeEntities = apStores[store]->getEntities();
+        mMatches.clear();
+        mStoreMatches.clear();
+        intersectEntities(mEntities.data(), mEntities.size(), storeEntities.data(), storeEntities.size(),
+                          mMatches, mStoreMatches);
+
+        mNextEntities.clear();
+        mNextIndexes.clear();
+        for (size_t match = 0; match < mMatches.size(); ++match) {
+            const size_t row = mMatches[match];
+            mNextEntities.push_back(mEntities[row]);
+            mNextIndexes.insert(mNextIndexes.end(),
+                                mIndexes.begin() + static_cast<std::ptrdiff_t>(row * aNbStores),
+                                mIndexes.begin() + static_cast<std::ptrdiff_t>((row + 1) * aNbStores));
+            mNextIndexes[(match * aNbStores) + store] = mStoreMatches[match];
+        }
+        mEntities.swap(mNextEntities);
+        mIndexes.swap(mNextIndexes);
+    }
+
+    return mEntities.size();
+}
+
+} // namespace ecs
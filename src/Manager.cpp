@@ -10,21 +10,342 @@
  */
 
 #include <ecs/Manager.h>
+#include <ecs/AsyncSystem.h>
 
 #include <algorithm>
+#include <cmath>
 
 namespace ecs {
 
-Manager::Manager() :
-    mLastEntity(_invalidEntity),
+Manager::Manager(unsigned int aShardId /* = 0 */) :
+    mFirstEntity(getShardBaseEntity(aShardId)),
+    mLastEntity(getShardBaseEntity(aShardId)),
+    mLastCreatedEntity(getShardBaseEntity(aShardId)),
+    mFreeEntities(),
     mEntities(),
     mComponentStores(),
-    mSystems() {
+    mResources(),
+    mSystems(),
+    mAsyncSystems(),
+    mWatchedComponentTypes(),
+    mTagSystems(),
+    mTagQueries(),
+    mFixedTimeStep(1.0f / 60),
+    mMaxFixedSteps(5),
+    mFixedTimeAccumulator(0.0f),
+    mEventBus(),
+    mBlobComponentTypes(),
+    mQueries(),
+    mHierarchy(),
+    mObservers(),
+    mSnapshotFunctions(),
+    mSnapshot(),
+    mAllocationCheck(eAllocationIgnored),
+    mNbWarmupFrames(0),
+    mNbAllocatingFrames(0),
+    mFrameAllocations() {
+    if (static_cast<uint64_t>(aShardId) >= (static_cast<uint64_t>(1) << _entityShardBits)) {
+        throw std::runtime_error("The Id of the shard shall be lower than 2^_entityShardBits");
+    }
 }
 
 Manager::~Manager() {
 }
 
+// Create a BlobComponentStore for a type of Component defined at runtime by its layout.
+ComponentType Manager::createBlobComponentStore(const ComponentLayout& aLayout) {
+    if (mBlobComponentTypes.end() != mBlobComponentTypes.find(aLayout.getName())) {
+        throw std::runtime_error("The runtime type of Component already exists");
+    }
+    // Allocate the highest free ComponentType of the range reserved to runtime Components
+    ComponentType componentType = _maxComponentTypes;
+    do {
+        if (_firstRuntimeComponentType == componentType) {
+            throw std::runtime_error("All the ComponentTypes reserved to runtime Components are used");
+        }
+        --componentType;
+    } while (mComponentStores.end() != mComponentStores.find(componentType));
+
+    mComponentStores.insert(std::make_pair(componentType,
+                                           IComponentStore::Ptr(new BlobComponentStore(componentType, aLayout))));
+    mBlobComponentTypes.insert(std::make_pair(aLayout.getName(), componentType));
+    return componentType;
+}
+
+// Get the ComponentType of a runtime type of Component, by name.
+ComponentType Manager::getBlobComponentType(const std::string& aName) const {
+    auto componentType = mBlobComponentTypes.find(aName);
+    if (mBlobComponentTypes.end() == componentType) {
+        throw std::runtime_error("The runtime type of Component does not exist");
+    }
+    return componentType->second;
+}
+
+// Get (access to) the BlobComponentStore of a runtime type of Component.
+BlobComponentStore& Manager::getBlobComponentStore(ComponentType aComponentType) {
+    auto iComponentStore = mComponentStores.find(aComponentType);
+    BlobComponentStore* pStore = nullptr;
+    if (mComponentStores.end() != iComponentStore) {
+        pStore = dynamic_cast<BlobComponentStore*>(iComponentStore->second.get());
+    }
+    if (nullptr == pStore) {
+        throw std::runtime_error("The BlobComponentStore does not exist");
+    }
+    return *pStore;
+}
+
+// Add a zero-initialized Component of a runtime type associated to an Entity.
+void* Manager::addComponent(const Entity aEntity, ComponentType aComponentType) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr == pRecord) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    BlobComponentStore& componentStore = getBlobComponentStore(aComponentType);
+    pRecord->mSignature.set(aComponentType);
+    return componentStore.add(aEntity);
+}
+
+// Reserve memory for a number of Entities, in the table of Entities, all Systems and all Queries.
+void Manager::reserveEntities(size_t aNbEntities) {
+    mEntities.reserve(aNbEntities);
+    mFreeEntities.reserve(aNbEntities);
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        (*system)->reserveEntities(aNbEntities);
+    }
+    for (auto query  = mQueries.begin();
+              query != mQueries.end();
+            ++query) {
+        query->second->reserve(aNbEntities);
+    }
+}
+
+// Materialize all reserved Entities up to the specified one.
+size_t Manager::createReservedEntities(const Entity aLastEntity) {
+    size_t nbCreatedEntities = 0;
+
+    for (; mLastCreatedEntity < aLastEntity; ++nbCreatedEntities) {
+        ++mLastCreatedEntity;
+        if (!mEntities.has(mLastCreatedEntity)) { // may have been adopted from a persistent store
+            mEntities.insert(mLastCreatedEntity, EntityRecord()); // can trow std::bad_alloc
+        }
+    }
+
+    return nbCreatedEntities;
+}
+
+// Create a new Entity reusing the index of the last destroyed Entity (there shall be some).
+Entity Manager::recycleEntity() {
+    createReservedEntities();
+    const Entity entity = mFreeEntities.back();
+    mEntities.insert(entity, EntityRecord()); // can trow std::bad_alloc
+    mFreeEntities.pop_back();
+    return entity;
+}
+
+// Get the record of an Entity found in a persistent store, creating it if needed.
+Manager::EntityRecord& Manager::adoptEntity(const Entity aEntity) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr != pRecord) {
+        return *pRecord;
+    }
+    // Never allocate again the index of an Entity of this shard
+    const Entity lastEntity = mLastEntity.load(std::memory_order_relaxed);
+    if ((getEntityShard(aEntity) == getShardId()) && (getEntityIndex(aEntity) > getEntityIndex(lastEntity))) {
+        createReservedEntities(lastEntity);
+        mLastEntity.store(mFirstEntity + getEntityIndex(aEntity), std::memory_order_relaxed);
+        mLastCreatedEntity = mFirstEntity + getEntityIndex(aEntity);
+    } else if ((getEntityShard(aEntity) == getShardId()) && !mFreeEntities.empty()) {
+        // Never reuse the index of the adopted Entity
+        for (auto entity  = mFreeEntities.begin();
+                  entity != mFreeEntities.end();
+                ++entity) {
+            if (getEntityIndex(*entity) == getEntityIndex(aEntity)) {
+                mFreeEntities.erase(entity);
+                break;
+            }
+        }
+    }
+    return mEntities.insert(aEntity, EntityRecord());
+}
+
+// Instantiate a prefab: create new Entities, each with a copy of all Components and Tags of the prefab.
+size_t Manager::instantiate(const Entity aPrefab, size_t aNbInstances, std::vector<Entity>& aInstances) {
+    const EntityRecord* pPrefab = mEntities.find(aPrefab);
+    if (nullptr == pPrefab) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    const Signature signature = pPrefab->mSignature; // copy, since mEntities may grow
+
+    // Check that all Components can be copied before creating anything, so that a failure leaves no partial instance
+    bool bCopyable = true;
+    signature.forEach([&](ComponentType aComponentType) {
+        auto componentStore = mComponentStores.find(aComponentType);
+        if ((mComponentStores.end() != componentStore) && !componentStore->second->isCopyable()) {
+            bCopyable = false;
+        }
+    });
+    if (!bCopyable) {
+        throw std::runtime_error("A Component of the prefab is not copyable");
+    }
+
+    // Create all new Entities at once, with the Signature of the prefab
+    const size_t first = aInstances.size();
+    aInstances.reserve(first + aNbInstances);
+    mEntities.reserve(mEntities.size() + aNbInstances);
+    for (size_t i = 0; i < aNbInstances; ++i) {
+        const Entity entity = createEntity();
+        EntityRecord& record = *mEntities.find(entity);
+        record.mSignature = signature;
+        record.mbRegistered = true;
+        aInstances.push_back(entity);
+    }
+    if (0 == aNbInstances) {
+        return 0;
+    }
+    const Entity* pInstances = &aInstances[first];
+
+    // Copy each Component of the prefab to all instances at once (Tags have no ComponentStore)
+    signature.forEach([&](ComponentType aComponentType) {
+        auto componentStore = mComponentStores.find(aComponentType);
+        if (mComponentStores.end() != componentStore) {
+            componentStore->second->clone(aPrefab, pInstances, aNbInstances);
+        }
+    });
+
+    // Match the Signature against the Systems once for the whole batch
+    size_t nbAssociatedSystems = 0;
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        if ((*system)->getFilter().matches(signature)) {
+            (*system)->registerEntities(pInstances, aNbInstances);
+            ++nbAssociatedSystems;
+        }
+    }
+    for (auto query  = mQueries.begin();
+              query != mQueries.end();
+            ++query) {
+        if (query->second->getFilter().matches(signature)) {
+            for (size_t i = 0; i < aNbInstances; ++i) {
+                query->second->registerEntity(pInstances[i]);
+            }
+        }
+    }
+
+    return nbAssociatedSystems;
+}
+
+// Destroy an Entity: unregister it from all Systems, and remove all its Components.
+void Manager::destroyEntity(const Entity aEntity) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr == pRecord) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+
+    unregisterEntity(aEntity);
+    mHierarchy.remove(aEntity);
+
+    // Remove all Components (Tags have no ComponentStore)
+    pRecord->mSignature.forEach([&](ComponentType aComponentType) {
+        auto componentStore = mComponentStores.find(aComponentType);
+        if (mComponentStores.end() != componentStore) {
+            componentStore->second->remove(aEntity);
+        }
+    });
+
+    mEntities.erase(aEntity);
+
+    // Reuse the index of the Entity, unless it has been created by another shard
+    if (getEntityShard(aEntity) == getShardId()) {
+        mFreeEntities.push_back(getNextGenerationEntity(aEntity));
+    }
+}
+
+// Reuse the index of an Entity created by this Manager, but destroyed by another shard it migrated to.
+void Manager::releaseEntity(const Entity aEntity) {
+    const Entity lastEntity = mLastEntity.load(std::memory_order_relaxed);
+    if ((getEntityShard(aEntity) != getShardId()) || (getEntityIndex(aEntity) > getEntityIndex(lastEntity))) {
+        throw std::runtime_error("The Entity has not been created by this Manager");
+    }
+    if (nullptr != mEntities.find(aEntity)) {
+        throw std::runtime_error("The Entity still exists");
+    }
+    mFreeEntities.push_back(getNextGenerationEntity(aEntity));
+}
+
+// Destroy an Entity with all its descendants in the Hierarchy.
+size_t Manager::destroySubtree(const Entity aEntity) {
+    if (!hasEntity(aEntity)) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+
+    std::vector<Entity> subtree;
+    if (0 == mHierarchy.removeSubtree(aEntity, subtree)) {
+        subtree.push_back(aEntity);
+    }
+    for (auto entity  = subtree.begin();
+              entity != subtree.end();
+            ++entity) {
+        destroyEntity(*entity);
+    }
+
+    return subtree.size();
+}
+
+// Migrate an Entity, with all its Components, into another Manager (shard).
+size_t Manager::migrateEntity(const Entity aEntity, Manager& aTarget) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr == pRecord) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    if (aTarget.hasEntity(aEntity)) {
+        throw std::runtime_error("The Entity already exists in the target Manager");
+    }
+    if (mHierarchy.has(aEntity)) {
+        throw std::runtime_error("An Entity of the Hierarchy cannot migrate");
+    }
+    // Check that all ComponentStores exist in the target, of the same kind and type (or layout), before moving
+    // anything (Tags have no ComponentStore)
+    const Signature entitySignature = pRecord->mSignature; // copy, since the record moves when erased
+    bool bMissingStore = false;
+    bool bDifferentStore = false;
+    entitySignature.forEach([&](ComponentType aComponentType) {
+        auto componentStore = mComponentStores.find(aComponentType);
+        if (mComponentStores.end() != componentStore) {
+            auto targetStore = aTarget.mComponentStores.find(aComponentType);
+            if (aTarget.mComponentStores.end() == targetStore) {
+                bMissingStore = true;
+            } else if (!componentStore->second->canMoveTo(*(targetStore->second))) {
+                bDifferentStore = true;
+            }
+        }
+    });
+    if (bMissingStore) {
+        throw std::runtime_error("The ComponentStore does not exist in the target Manager");
+    }
+    if (bDifferentStore) {
+        throw std::runtime_error("The ComponentStore of the target Manager is of a different type or layout");
+    }
+
+    unregisterEntity(aEntity);
+
+    // Move the Components from each store to the corresponding store of the target
+    entitySignature.forEach([&](ComponentType aComponentType) {
+        auto componentStore = mComponentStores.find(aComponentType);
+        if (mComponentStores.end() != componentStore) {
+            componentStore->second->moveTo(aEntity, *(aTarget.mComponentStores[aComponentType]));
+        }
+    });
+
+    // Move the Entity itself (with the Signature of its Components and Tags) and register it to the target Systems
+    aTarget.mEntities.insert(aEntity, EntityRecord(entitySignature));
+    mEntities.erase(aEntity);
+
+    return aTarget.registerEntity(aEntity);
+}
+
 // Add a System.
 /// @todo Register the System with existing matching Entities? Or only allow Systems to be added during init?
 void Manager::addSystem(const System::Ptr& aSystemPtr) {
@@ -34,32 +355,93 @@ void Manager::addSystem(const System::Ptr& aSystemPtr) {
     }
     // Simply copy the pointer (instead of moving it) to allow for multiple insertion of the same shared pointer.
     mSystems.push_back(aSystemPtr);
+    AsyncSystem* pAsyncSystem = dynamic_cast<AsyncSystem*>(aSystemPtr.get());
+    if (nullptr != pAsyncSystem) {
+        mAsyncSystems.push_back(pAsyncSystem);
+    }
+    mWatchedComponentTypes.reserve(mSystems.size());
+    mTagSystems.reserve(mSystems.size());
+}
+
+// Add an observer of the Components of a certain type, enabling the tracking of changes of the store.
+void Manager::addObserver(ComponentType aComponentType, const ComponentObserver::Ptr& aObserverPtr) {
+    auto componentStore = mComponentStores.find(aComponentType);
+    if (mComponentStores.end() == componentStore) {
+        throw std::runtime_error("The ComponentStore does not exist");
+    }
+    if (!aObserverPtr) {
+        throw std::runtime_error("The ComponentObserver shall not be null");
+    }
+    componentStore->second->setTrackChanges(true);
+    mObservers[aComponentType].push_back(aObserverPtr);
+}
+
+// Deliver all changes recorded by ComponentStores to their observers, as one batch per type (sync point).
+size_t Manager::notifyObservers() {
+    size_t nbBatches = 0;
+
+    for (auto observers  = mObservers.begin();
+              observers != mObservers.end();
+            ++observers) {
+        IComponentStore& componentStore = *(mComponentStores[observers->first]);
+        // Changed Components are recorded each time they are marked: sort and remove duplicates once per batch
+        std::vector<Entity>& changedEntities = componentStore.getChangedEntities();
+        std::sort(changedEntities.begin(), changedEntities.end());
+        changedEntities.erase(std::unique(changedEntities.begin(), changedEntities.end()), changedEntities.end());
+
+        for (auto observer  = observers->second.begin();
+                  observer != observers->second.end();
+                ++observer) {
+            if (!componentStore.getAddedEntities().empty()) {
+                (*observer)->onAdded(observers->first, componentStore.getAddedEntities());
+                ++nbBatches;
+            }
+            if (!componentStore.getRemovedEntities().empty()) {
+                (*observer)->onRemoved(observers->first, componentStore.getRemovedEntities());
+                ++nbBatches;
+            }
+            if (!changedEntities.empty()) {
+                (*observer)->onChanged(observers->first, changedEntities);
+                ++nbBatches;
+            }
+        }
+        componentStore.clearChanges();
+    }
+
+    return nbBatches;
 }
 
 // Register an Entity to all matching Systems.
 size_t Manager::registerEntity(const Entity aEntity) {
     size_t nbAssociatedSystems = 0;
 
-    auto entity = mEntities.find(aEntity);
-    if (mEntities.end() == entity) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr == pRecord) {
         throw std::runtime_error("The Entity does not exist");
     }
-    auto entityComponents = (*entity).second;
+    const Signature& entitySignature = pRecord->mSignature;
+    pRecord->mbRegistered = true;
 
     // Cycle through all Systems to check which ones can be interested by the Entity
     for (auto system  = mSystems.begin();
               system != mSystems.end();
             ++system) {
-        auto systemRequiredComponents = (*system)->getRequiredComponents();
-        // Check if all Components Required by the System are in the Entity (use sorted sets)
-        if (std::includes(entityComponents.begin(), entityComponents.end(),
-                          systemRequiredComponents.begin(), systemRequiredComponents.end())) {
+        // Check if all Components required by the System are in the Entity, and none of the excluded ones
+        if ((*system)->getFilter().matches(entitySignature)) {
             // Register the matching Entity
             // TODO(SRombauts) shall throw in case of failure!
             (*system)->registerEntity(aEntity);
             ++nbAssociatedSystems;
         }
     }
+    // Feed the Queries the same way
+    for (auto query  = mQueries.begin();
+              query != mQueries.end();
+            ++query) {
+        if (query->second->getFilter().matches(entitySignature)) {
+            query->second->registerEntity(aEntity);
+        }
+    }
 
     return nbAssociatedSystems;
 }
@@ -68,11 +450,11 @@ size_t Manager::registerEntity(const Entity aEntity) {
 size_t Manager::unregisterEntity(const Entity aEntity) {
     size_t nbAssociatedSystems = 0;
 
-    auto entity = mEntities.find(aEntity);
-    if (mEntities.end() == entity) {
+    EntityRecord* pRecord = mEntities.find(aEntity);
+    if (nullptr == pRecord) {
         throw std::runtime_error("The Entity does not exist");
     }
-    auto entityComponents = (*entity).second;
+    pRecord->mbRegistered = false;
 
     // Cycle through all Systems to unregister the Entity
     for (auto system  = mSystems.begin();
@@ -81,13 +463,209 @@ size_t Manager::unregisterEntity(const Entity aEntity) {
         // Simply try to unregister the matching Entity
         nbAssociatedSystems += (*system)->unregisterEntity(aEntity);
     }
+    for (auto query  = mQueries.begin();
+              query != mQueries.end();
+            ++query) {
+        query->second->unregisterEntity(aEntity);
+    }
 
     return nbAssociatedSystems;
 }
 
+// Add or remove a Tag to a list of Entities, updating the Systems of registered Entities.
+size_t Manager::setTag(ComponentType aTagType, const Entity* apEntities, size_t aNbEntities, bool abTag) {
+    size_t nbChangedEntities = 0;
+
+    if (mComponentStores.end() != mComponentStores.find(aTagType)) {
+        throw std::runtime_error("The Tag type shall not have a ComponentStore");
+    }
+    if (aTagType >= _firstRuntimeComponentType) {
+        throw std::runtime_error("The Tag type shall be lower than the ComponentTypes reserved to runtime Components");
+    }
+
+    // Only the Systems (and Queries) filtering on this Tag can be affected: find them once for the whole batch,
+    // in buffers reserved by addSystem() and createQuery()
+    mTagSystems.clear();
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        if ((*system)->getFilter().isFiltering(aTagType)) {
+            mTagSystems.push_back(system->get());
+        }
+    }
+    mTagQueries.clear();
+    for (auto query  = mQueries.begin();
+              query != mQueries.end();
+            ++query) {
+        if (query->second->getFilter().isFiltering(aTagType)) {
+            mTagQueries.push_back(query->second.get());
+        }
+    }
+
+    for (size_t i = 0; i < aNbEntities; ++i) {
+        EntityRecord* pRecord = mEntities.find(apEntities[i]);
+        if (nullptr == pRecord) {
+            throw std::runtime_error("The Entity does not exist");
+        }
+        EntityRecord& record = *pRecord;
+        if (abTag == record.mSignature.test(aTagType)) {
+            continue;
+        }
+        if (abTag) {
+            record.mSignature.set(aTagType);
+        } else {
+            record.mSignature.reset(aTagType);
+        }
+        ++nbChangedEntities;
+
+        // Update the membership of the Entity in the affected Systems
+        if (record.mbRegistered) {
+            for (auto system  = mTagSystems.begin();
+                      system != mTagSystems.end();
+                    ++system) {
+                if ((*system)->getFilter().matches(record.mSignature)) {
+                    (*system)->registerEntity(apEntities[i]);
+                } else {
+                    (*system)->unregisterEntity(apEntities[i]);
+                }
+            }
+            for (auto query  = mTagQueries.begin();
+                      query != mTagQueries.end();
+                    ++query) {
+                if ((*query)->getFilter().matches(record.mSignature)) {
+                    (*query)->registerEntity(apEntities[i]);
+                } else {
+                    (*query)->unregisterEntity(apEntities[i]);
+                }
+            }
+        }
+    }
+
+    return nbChangedEntities;
+}
+
+// Put an Entity to sleep in all its Systems.
+size_t Manager::sleepEntity(const Entity aEntity) {
+    size_t nbSystems = 0;
+
+    if (!hasEntity(aEntity)) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        if ((*system)->sleepEntity(aEntity)) {
+            ++nbSystems;
+        }
+    }
+
+    return nbSystems;
+}
+
+// Wake up an Entity in all its Systems.
+size_t Manager::wakeEntity(const Entity aEntity) {
+    size_t nbSystems = 0;
+
+    if (!hasEntity(aEntity)) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        if ((*system)->wakeEntity(aEntity)) {
+            ++nbSystems;
+        }
+    }
+
+    return nbSystems;
+}
+
+// Apply the sleep policies of all Systems, using the changes tracked by the watched ComponentStores.
+size_t Manager::applySleepPolicies() {
+    size_t nbSleepingEntities = 0;
+    mWatchedComponentTypes.clear();
+
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        const ComponentType componentType = (*system)->getSleepComponentType();
+        auto componentStore = mComponentStores.find(componentType);
+        if (mComponentStores.end() != componentStore) {
+            IComponentStore& store = *(componentStore->second);
+            if (!store.isTrackingChanges()) {
+                // Start tracking changes for the next frames
+                store.setTrackChanges(true);
+            }
+            nbSleepingEntities += (*system)->applySleepPolicy(store.getAddedEntities(), store.getChangedEntities());
+            if (mWatchedComponentTypes.end() ==
+                std::find(mWatchedComponentTypes.begin(), mWatchedComponentTypes.end(), componentType)) {
+                mWatchedComponentTypes.push_back(componentType);
+            }
+        }
+    }
+
+    // Forget the changes of the frame, unless they are still to be delivered to observers
+    for (auto componentType  = mWatchedComponentTypes.begin();
+              componentType != mWatchedComponentTypes.end();
+            ++componentType) {
+        if (mObservers.end() == mObservers.find(*componentType)) {
+            mComponentStores[*componentType]->clearChanges();
+        }
+    }
+
+    return nbSleepingEntities;
+}
+
+// Create a named Query, keeping the list of all registered Entities matching a filter.
+const Query& Manager::createQuery(const std::string& aName, ComponentFilter&& aFilter) {
+    if (mQueries.end() != mQueries.find(aName)) {
+        throw std::runtime_error("The Query already exists");
+    }
+    Query::Ptr queryPtr(new Query(aName, std::move(aFilter)));
+
+    // Fill the Query with the registered Entities matching its filter
+    for (size_t index = 0; index < mEntities.size(); ++index) {
+        const EntityRecord& record = mEntities.getAt(index);
+        if (record.mbRegistered && queryPtr->getFilter().matches(record.mSignature)) {
+            queryPtr->registerEntity(mEntities.getEntities()[index]);
+        }
+    }
+
+    const Query& query = *queryPtr;
+    mQueries.insert(std::make_pair(aName, std::move(queryPtr)));
+    mTagQueries.reserve(mQueries.size());
+    return query;
+}
+
+// Get (access to) a named Query.
+const Query& Manager::getQuery(const std::string& aName) const {
+    auto query = mQueries.find(aName);
+    if (mQueries.end() == query) {
+        throw std::runtime_error("The Query does not exist");
+    }
+    return *(query->second);
+}
+
+// Find all Entities matching a filter (ad-hoc query, scanning all Entities).
+size_t Manager::queryEntities(const ComponentFilter& aFilter, std::vector<Entity>& aEntities) const {
+    size_t nbMatchingEntities = 0;
+
+    for (size_t index = 0; index < mEntities.size(); ++index) {
+        if (aFilter.matches(mEntities.getAt(index).mSignature)) {
+            aEntities.push_back(mEntities.getEntities()[index]);
+            ++nbMatchingEntities;
+        }
+    }
+
+    return nbMatchingEntities;
+}
+
 // Update all Entities of all Systems.
 size_t Manager::updateEntities(float abElapsedTime) {
     size_t nbUpdatedEntities = 0;
+    const AllocationTracker::Counters start = AllocationTracker::getCounters();
+
+    applyCompletions();
 
     for (auto system  = mSystems.begin();
               system != mSystems.end();
@@ -95,10 +673,131 @@ size_t Manager::updateEntities(float abElapsedTime) {
         nbUpdatedEntities += (*system)->updateEntities(abElapsedTime);
     }
 
+    checkFrameAllocations(start);
+    if (!mSnapshotFunctions.empty()) {
+        publishSnapshot();
+    }
+
     return nbUpdatedEntities;
 }
 
-} // namespace ecs
+// Specify the fixed time step of the eFixedUpdate phase of updateFrame().
+void Manager::setFixedTimeStep(float aFixedTimeStep, unsigned int aMaxFixedSteps) {
+    if ((aFixedTimeStep <= 0.0f) || (0 == aMaxFixedSteps)) {
+        throw std::runtime_error("The fixed time step and the max number of steps shall be strictly positive");
+    }
+    mFixedTimeStep = aFixedTimeStep;
+    mMaxFixedSteps = aMaxFixedSteps;
+    mFixedTimeAccumulator = 0.0f;
+}
+
+// Run a frame: all Systems of each phase, in order, honoring their tick rate.
+size_t Manager::updateFrame(float aElapsedTime) {
+    size_t nbUpdatedEntities = 0;
+    const AllocationTracker::Counters start = AllocationTracker::getCounters();
+
+    // Clear all Events of the previous frame, then apply the results of finished asynchronous work
+    mEventBus.clear();
+    applyCompletions();
+
+    nbUpdatedEntities += updatePhase(System::ePreUpdate, aElapsedTime);
+
+    // Catch-up with the elapsed time by fixed steps, dropping the time left over after the maximum number of steps
+    mFixedTimeAccumulator += aElapsedTime;
+    unsigned int nbFixedSteps = 0;
+    while ((mFixedTimeAccumulator >= mFixedTimeStep) && (nbFixedSteps < mMaxFixedSteps)) {
+        nbUpdatedEntities += updatePhase(System::eFixedUpdate, mFixedTimeStep);
+        mFixedTimeAccumulator -= mFixedTimeStep;
+        ++nbFixedSteps;
+    }
+    if (mFixedTimeAccumulator >= mFixedTimeStep) {
+        mFixedTimeAccumulator = std::fmod(mFixedTimeAccumulator, mFixedTimeStep);
+    }
+
+    nbUpdatedEntities += updatePhase(System::eUpdate, aElapsedTime);
+    nbUpdatedEntities += updatePhase(System::ePostUpdate, aElapsedTime);
+
+    // Put idle Entities to sleep, then deliver all changes of Components of the frame to their observers
+    applySleepPolicies();
+    notifyObservers();
+
+    checkFrameAllocations(start);
+    if (!mSnapshotFunctions.empty()) {
+        publishSnapshot();
+    }
+
+    return nbUpdatedEntities;
+}
+
+// Apply the Completions of the finished asynchronous work of all AsyncSystems (sync point).
+size_t Manager::applyCompletions() {
+    size_t nbApplied = 0;
+    for (auto asyncSystem  = mAsyncSystems.begin();
+              asyncSystem != mAsyncSystems.end();
+            ++asyncSystem) {
+        nbApplied += (*asyncSystem)->applyCompletions();
+    }
+    return nbApplied;
+}
+
+// Check the allocations made by each frame (updateFrame() or updateEntities()) after a warm-up.
+void Manager::setAllocationCheck(AllocationCheck aCheck, unsigned int aNbWarmupFrames /* = 0 */) {
+    mAllocationCheck = aCheck;
+    mNbWarmupFrames = aNbWarmupFrames;
+    mNbAllocatingFrames = 0;
+}
+
+// Publish a new Snapshot of all enabled ComponentStores.
+void Manager::publishSnapshot() {
+    // Only this thread publishes Snapshots: the previous one can be read without atomic access
+    const Snapshot* pPrevious = mSnapshot.get();
+    std::map<ComponentType, IComponentSnapshot::Ptr> views;
+    for (auto function  = mSnapshotFunctions.begin();
+              function != mSnapshotFunctions.end();
+            ++function) {
+        const IComponentStore& store = *(mComponentStores[function->first]);
+        IComponentSnapshot::Ptr previousView;
+        if (nullptr != pPrevious) {
+            previousView = pPrevious->find(function->first);
+        }
+        if (previousView && (previousView->getVersion() == store.getVersion())) {
+            // Unchanged store: share the whole previous view, without comparing its chunks
+            views.insert(std::make_pair(function->first, std::move(previousView)));
+        } else {
+            views.insert(std::make_pair(function->first, function->second(store, previousView.get())));
+        }
+    }
+    const uint64_t number = (nullptr != pPrevious) ? (pPrevious->getNumber() + 1) : 1;
+    std::atomic_store(&mSnapshot, Snapshot::Ptr(new Snapshot(number, std::move(views))));
+}
 
+// Run all Systems of a phase, in order of insertion.
+size_t Manager::updatePhase(System::Phase aPhase, float aElapsedTime) {
+    size_t nbUpdatedEntities = 0;
+
+    for (auto system  = mSystems.begin();
+              system != mSystems.end();
+            ++system) {
+        if (aPhase == (*system)->getPhase()) {
+            nbUpdatedEntities += (*system)->tick(aElapsedTime);
+        }
+    }
 
+    return nbUpdatedEntities;
+}
 
+// Account for the allocations made by a frame, and check them after the warm-up.
+void Manager::checkFrameAllocations(const AllocationTracker::Counters& aStart) {
+    mFrameAllocations = AllocationTracker::getCounters() - aStart;
+    if (0 < mNbWarmupFrames) {
+        --mNbWarmupFrames;
+    } else if ((eAllocationIgnored != mAllocationCheck) && (0 < mFrameAllocations.mNbAllocations)) {
+        ++mNbAllocatingFrames;
+        if (eAllocationForbidden == mAllocationCheck) {
+            throw std::runtime_error("The frame allocated " + std::to_string(mFrameAllocations.mNbAllocations) +
+                                     " times (" + std::to_string(mFrameAllocations.mNbBytes) + " bytes)");
+        }
+    }
+}
+
+} // namespace ecs
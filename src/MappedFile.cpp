@@ -0,0 +1,200 @@
+/**
+ * @file    MappedFile.cpp
+ * @ingroup ecs
+ * @brief   A ecs::MappedFile maps a whole file in memory, shared with the file on disk.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/MappedFile.h>
+
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace ecs {
+
+#if defined(_WIN32)
+
+MappedFile::MappedFile() :
+    mFile(INVALID_HANDLE_VALUE),
+    mMapping(nullptr),
+    mpData(nullptr),
+    mSize(0) {
+}
+
+// Open (or create) a file and map it in memory, growing it to a minimum size if needed.
+void MappedFile::open(const std::string& aPath, size_t aMinSize) {
+    close();
+    mFile = CreateFileA(aPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_ALWAYS,
+                        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (INVALID_HANDLE_VALUE == mFile) {
+        throw std::runtime_error("Cannot open the file " + aPath);
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(mFile, &size)) {
+        close();
+        throw std::runtime_error("Cannot get the size of the file " + aPath);
+    }
+    mSize = static_cast<size_t>(size.QuadPart);
+    if (mSize < aMinSize) {
+        resize(aMinSize);
+    } else {
+        map();
+    }
+}
+
+// Resize the file, and remap it.
+void MappedFile::resize(size_t aSize) {
+    unmap();
+    LARGE_INTEGER size;
+    size.QuadPart = static_cast<LONGLONG>(aSize);
+    if (!SetFilePointerEx(mFile, size, nullptr, FILE_BEGIN) || !SetEndOfFile(mFile)) {
+        throw std::runtime_error("Cannot resize the file");
+    }
+    mSize = aSize;
+    map();
+}
+
+// Write all modified pages to disk, waiting for completion.
+void MappedFile::flush() {
+    if (isOpen()) {
+        if (!FlushViewOfFile(mpData, 0) || !FlushFileBuffers(mFile)) {
+            throw std::runtime_error("Cannot flush the file");
+        }
+    }
+}
+
+// Unmap and close the file.
+void MappedFile::close() {
+    unmap();
+    if (INVALID_HANDLE_VALUE != mFile) {
+        CloseHandle(mFile);
+        mFile = INVALID_HANDLE_VALUE;
+    }
+    mSize = 0;
+}
+
+// Map the whole file in memory.
+void MappedFile::map() {
+    if (0 == mSize) {
+        throw std::runtime_error("Cannot map an empty file");
+    }
+    mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READWRITE, 0, 0, nullptr);
+    if (nullptr == mMapping) {
+        throw std::runtime_error("Cannot map the file");
+    }
+    mpData = MapViewOfFile(mMapping, FILE_MAP_ALL_ACCESS, 0, 0, mSize);
+    if (nullptr == mpData) {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+        throw std::runtime_error("Cannot map the file");
+    }
+}
+
+// Unmap the file.
+void MappedFile::unmap() {
+    if (nullptr != mpData) {
+        UnmapViewOfFile(mpData);
+        mpData = nullptr;
+    }
+    if (nullptr != mMapping) {
+        CloseHandle(mMapping);
+        mMapping = nullptr;
+    }
+}
+
+#else // POSIX
+
+MappedFile::MappedFile() :
+    mFile(-1),
+    mpData(nullptr),
+    mSize(0) {
+}
+
+// Open (or create) a file and map it in memory, growing it to a minimum size if needed.
+void MappedFile::open(const std::string& aPath, size_t aMinSize) {
+    close();
+    mFile = ::open(aPath.c_str(), O_RDWR | O_CREAT, 0644);
+    if (mFile < 0) {
+        throw std::runtime_error("Cannot open the file " + aPath);
+    }
+    struct stat status;
+    if (0 != fstat(mFile, &status)) {
+        close();
+        throw std::runtime_error("Cannot get the size of the file " + aPath);
+    }
+    mSize = static_cast<size_t>(status.st_size);
+    if (mSize < aMinSize) {
+        resize(aMinSize);
+    } else {
+        map();
+    }
+}
+
+// Resize the file, and remap it.
+void MappedFile::resize(size_t aSize) {
+    unmap();
+    if (0 != ftruncate(mFile, static_cast<off_t>(aSize))) {
+        throw std::runtime_error("Cannot resize the file");
+    }
+    mSize = aSize;
+    map();
+}
+
+// Write all modified pages to disk, waiting for completion.
+void MappedFile::flush() {
+    if (isOpen()) {
+        if (0 != msync(mpData, mSize, MS_SYNC)) {
+            throw std::runtime_error("Cannot flush the file");
+        }
+    }
+}
+
+// Unmap and close the file.
+void MappedFile::close() {
+    unmap();
+    if (mFile >= 0) {
+        ::close(mFile);
+        mFile = -1;
+    }
+    mSize = 0;
+}
+
+// Map the whole file in memory.
+void MappedFile::map() {
+    if (0 == mSize) {
+        throw std::runtime_error("Cannot map an empty file");
+    }
+    void* pData = mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, 0);
+    if (MAP_FAILED == pData) {
+        throw std::runtime_error("Cannot map the file");
+    }
+    mpData = pData;
+}
+
+// Unmap the file.
+void MappedFile::unmap() {
+    if (nullptr != mpData) {
+        munmap(mpData, mSize);
+        mpData = nullptr;
+    }
+}
+
+#endif // _WIN32
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+} // namespace ecs
@@ -0,0 +1,67 @@
+/**
+ * @file    Query.cpp
+ * @ingroup ecs
+ * @brief   A ecs::Query keeps the list of all registered ecs::Entity matching a ecs::ComponentFilter.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Query.h>
+
+namespace ecs {
+
+Query::Query(const std::string& aName, ComponentFilter&& aFilter) :
+    mName(aName),
+    mFilter(std::move(aFilter)),
+    mEntities(),
+    mIndexes() {
+}
+
+Query::~Query() {
+}
+
+// Register a matching Entity.
+bool Query::registerEntity(Entity aEntity) {
+    const bool bInserted = mIndexes.insert(std::make_pair(aEntity, mEntities.size())).second;
+    if (bInserted) {
+        mEntities.push_back(aEntity);
+    }
+    return bInserted;
+}
+
+// Unregister an Entity (moving the last Entity of the result in its place).
+size_t Query::unregisterEntity(Entity aEntity) {
+    auto index = mIndexes.find(aEntity);
+    if (mIndexes.end() == index) {
+        return 0;
+    }
+    const Entity last = mEntities.back();
+    mEntities[index->second] = last;
+    mIndexes[last] = index->second;
+    mEntities.pop_back();
+    mIndexes.erase(aEntity);
+    return 1;
+}
+
+// Reserve memory for a number of matching Entities.
+void Query::reserve(size_t aNbEntities) {
+    mEntities.reserve(aNbEntities);
+    mIndexes.reserve(aNbEntities);
+}
+
+// Save the result of the Query.
+void Query::saveState(State& aState) const {
+    aState.mEntities = mEntities;
+    aState.mIndexes = mIndexes;
+}
+
+// Restore the result of the Query (without matching).
+void Query::restoreState(const State& aState) {
+    mEntities = aState.mEntities;
+    mIndexes = aState.mIndexes;
+}
+
+} // namespace ecs
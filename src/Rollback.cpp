@@ -0,0 +1,208 @@
+/**
+ * @file    Rollback.cpp
+ * @ingroup ecs
+ * @brief   A ecs::Rollback keeps a ring buffer of saved states of a ecs::Manager, to restore any recent tick.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Rollback.h>
+
+#include <stdexcept>
+
+namespace ecs {
+
+Rollback::Rollback(Manager& aManager, size_t aNbSlots /* = 8 */) :
+    mManager(aManager),
+    mSlots((0 < aNbSlots) ? aNbSlots : 1),
+    mNextSlot(0),
+    mStores(),
+    mSystems(),
+    mQueries(),
+    mVersions(),
+    mLastSources(),
+    mbSaved(false),
+    mLastTick(0),
+    mNbCopiedStores(0) {
+    for (auto store  = aManager.mComponentStores.begin();
+              store != aManager.mComponentStores.end();
+            ++store) {
+        mStores.push_back(store->second.get());
+    }
+    for (auto system  = aManager.mSystems.begin();
+              system != aManager.mSystems.end();
+            ++system) {
+        mSystems.push_back(system->get());
+    }
+    for (auto query  = aManager.mQueries.begin();
+              query != aManager.mQueries.end();
+            ++query) {
+        mQueries.push_back(query->second.get());
+    }
+    mVersions.resize(mStores.size(), 0);
+    mLastSources.resize(mStores.size(), mSlots.size());
+
+    // Preallocate all the slots, with the current size of the Manager
+    for (auto slot  = mSlots.begin();
+              slot != mSlots.end();
+            ++slot) {
+        slot->mbValid = false;
+        slot->mTick = 0;
+        slot->mLastEntity = _invalidEntity;
+        slot->mLastCreatedEntity = _invalidEntity;
+        slot->mFixedTimeAccumulator = 0.0f;
+        slot->mFreeEntities.reserve(aManager.mFreeEntities.capacity());
+        slot->mEntities.reserve(aManager.mEntities.size());
+        slot->mSystems.resize(mSystems.size());
+        slot->mQueries.resize(mQueries.size());
+        slot->mSources.resize(mStores.size(), mSlots.size());
+        for (size_t store = 0; store < mStores.size(); ++store) {
+            slot->mStores.push_back(mStores[store]->createState());
+        }
+    }
+}
+
+Rollback::~Rollback() {
+}
+
+// Save the state of the Manager for a tick, overwriting the oldest saved tick.
+void Rollback::save(uint64_t aTick) {
+    if (mbSaved && (aTick <= mLastTick)) {
+        throw std::runtime_error("The tick shall be after the last saved tick");
+    }
+    checkManager();
+
+    releaseSlot(mNextSlot);
+    Slot& slot = mSlots[mNextSlot];
+    slot.mbValid = false; // until completely saved
+
+    // Copy the stores modified since the previous save, else reference the slot holding their content
+    mNbCopiedStores = 0;
+    for (size_t store = 0; store < mStores.size(); ++store) {
+        if ((mSlots.size() != mLastSources[store]) && (mStores[store]->getVersion() == mVersions[store])) {
+            slot.mSources[store] = mLastSources[store];
+        } else {
+            mStores[store]->saveState(*slot.mStores[store]);
+            slot.mSources[store] = mNextSlot;
+            mVersions[store] = mStores[store]->getVersion();
+            mLastSources[store] = mNextSlot;
+            ++mNbCopiedStores;
+        }
+    }
+
+    slot.mLastEntity = mManager.mLastEntity.load(std::memory_order_relaxed);
+    slot.mLastCreatedEntity = mManager.mLastCreatedEntity;
+    slot.mFreeEntities = mManager.mFreeEntities;
+    slot.mFixedTimeAccumulator = mManager.mFixedTimeAccumulator;
+    slot.mEntities = mManager.mEntities;
+    for (size_t system = 0; system < mSystems.size(); ++system) {
+        mSystems[system]->saveState(slot.mSystems[system]);
+    }
+    for (size_t query = 0; query < mQueries.size(); ++query) {
+        mQueries[query]->saveState(slot.mQueries[query]);
+    }
+
+    slot.mTick = aTick;
+    slot.mbValid = true;
+    mbSaved = true;
+    mLastTick = aTick;
+    mNextSlot = (mNextSlot + 1) % mSlots.size();
+}
+
+// Restore the state of the Manager saved for a tick, forgetting all the ticks saved after this one.
+bool Rollback::restore(uint64_t aTick) {
+    const size_t index = findSlot(aTick);
+    if (mSlots.size() == index) {
+        return false;
+    }
+    checkManager();
+    const Slot& slot = mSlots[index];
+
+    // Only copy back the stores modified since they were saved
+    mNbCopiedStores = 0;
+    for (size_t store = 0; store < mStores.size(); ++store) {
+        const size_t source = slot.mSources[store];
+        if ((source != mLastSources[store]) || (mStores[store]->getVersion() != mVersions[store])) {
+            mStores[store]->restoreState(*mSlots[source].mStores[store]);
+            mVersions[store] = mStores[store]->getVersion();
+            mLastSources[store] = source;
+            ++mNbCopiedStores;
+        }
+    }
+
+    mManager.mLastEntity.store(slot.mLastEntity, std::memory_order_relaxed);
+    mManager.mLastCreatedEntity = slot.mLastCreatedEntity;
+    mManager.mFreeEntities = slot.mFreeEntities;
+    mManager.mFixedTimeAccumulator = slot.mFixedTimeAccumulator;
+    mManager.mEntities = slot.mEntities;
+    for (size_t system = 0; system < mSystems.size(); ++system) {
+        mSystems[system]->restoreState(slot.mSystems[system]);
+    }
+    for (size_t query = 0; query < mQueries.size(); ++query) {
+        mQueries[query]->restoreState(slot.mQueries[query]);
+    }
+
+    // The following ticks are to be simulated again
+    for (auto other  = mSlots.begin();
+              other != mSlots.end();
+            ++other) {
+        if (other->mbValid && (other->mTick > aTick)) {
+            other->mbValid = false;
+        }
+    }
+    mLastTick = aTick;
+    mNextSlot = (index + 1) % mSlots.size();
+
+    return true;
+}
+
+// Test if a tick is saved.
+bool Rollback::has(uint64_t aTick) const {
+    return (mSlots.size() != findSlot(aTick));
+}
+
+// Find the slot of a saved tick, or return getNbSlots().
+size_t Rollback::findSlot(uint64_t aTick) const {
+    for (size_t index = 0; index < mSlots.size(); ++index) {
+        if (mSlots[index].mbValid && (aTick == mSlots[index].mTick)) {
+            return index;
+        }
+    }
+    return mSlots.size();
+}
+
+// Before overwriting a slot, hand over the content of stores it holds to another slot referencing it.
+void Rollback::releaseSlot(size_t aSlot) {
+    for (size_t store = 0; store < mStores.size(); ++store) {
+        size_t heir = mSlots.size();
+        for (size_t index = 0; index < mSlots.size(); ++index) {
+            Slot& other = mSlots[index];
+            if ((index != aSlot) && other.mbValid && (aSlot == other.mSources[store])) {
+                if (mSlots.size() == heir) {
+                    // Swap the contents, so that the released slot keeps an allocated State to reuse
+                    heir = index;
+                    mSlots[aSlot].mStores[store].swap(other.mStores[store]);
+                }
+                other.mSources[store] = heir;
+            }
+        }
+        // Without heir, the content stays in the released slot, to be referenced again if the store is unchanged
+        if ((mSlots.size() != heir) && (aSlot == mLastSources[store])) {
+            mLastSources[store] = heir;
+        }
+    }
+}
+
+// Throw if the ComponentStores, Systems or Queries of the Manager have changed.
+void Rollback::checkManager() const {
+    if ((mManager.mComponentStores.size() != mStores.size()) ||
+        (mManager.mSystems.size() != mSystems.size()) ||
+        (mManager.mQueries.size() != mQueries.size())) {
+        throw std::runtime_error("The ComponentStores, Systems or Queries have changed since the Rollback was created");
+    }
+}
+
+} // namespace ecs
@@ -12,34 +12,348 @@
 #include <ecs/System.h>
 #include <ecs/Manager.h>
 
+#include <cmath>
+#include <chrono>
+#include <algorithm>
+#include <utility>  // std::swap
+
 namespace ecs {
 
 System::System(Manager& aManager) :
-    mManager(aManager) {
+    mManager(aManager),
+    mFilter(),
+    mEntities(),
+    mIdleFrames(),
+    mSweeps(),
+    mUpdateTimes(),
+    mIndexes(),
+    mNbActiveEntities(0),
+    mSleepComponentType(_invalidComponentType),
+    mSleepIdleFrames(0),
+    mPhase(eUpdate),
+    mTickPeriod(0.0f),
+    mTickTimer(0.0f),
+    mTickElapsed(0.0f),
+    mSliceMaxEntities(0),
+    mSliceMaxTime(0.0f),
+    mCursor(0),
+    mSweep(1),
+    mNbPendingEntities(0),
+    mNbSweepFrames(0),
+    mNbFramesPerSweep(0),
+    mSliceTime(0.0),
+    mAllocations() {
 }
 
 System::~System() {
 }
 
+// Register a matching Entity, having all required Components, as active.
+bool System::registerEntity(Entity aEntity) {
+    const bool bInserted = mIndexes.insert(std::make_pair(aEntity, mEntities.size())).second;
+    if (bInserted) {
+        mEntities.push_back(aEntity);
+        mIdleFrames.push_back(0);
+        mSweeps.push_back(0);   // not yet updated by the current sweep
+        mUpdateTimes.push_back(mSliceTime);
+        // Move it at the end of the active Entities
+        swapEntities(mNbActiveEntities, mEntities.size() - 1);
+        ++mNbActiveEntities;
+        ++mNbPendingEntities;
+    }
+    return bInserted;
+}
+
+// Register a list of new matching Entities at once.
+void System::registerEntities(const Entity* apEntities, size_t aNbEntities) {
+    mEntities.reserve(mEntities.size() + aNbEntities);
+    mIdleFrames.reserve(mIdleFrames.size() + aNbEntities);
+    mSweeps.reserve(mSweeps.size() + aNbEntities);
+    mUpdateTimes.reserve(mUpdateTimes.size() + aNbEntities);
+    mIndexes.reserve(mIndexes.size() + aNbEntities);
+    for (size_t i = 0; i < aNbEntities; ++i) {
+        registerEntity(apEntities[i]);
+    }
+}
+
+// Reserve memory for a number of registered Entities.
+void System::reserveEntities(size_t aNbEntities) {
+    mEntities.reserve(aNbEntities);
+    mIdleFrames.reserve(aNbEntities);
+    mSweeps.reserve(aNbEntities);
+    mUpdateTimes.reserve(aNbEntities);
+    mIndexes.reserve(aNbEntities);
+}
+
+// Unregister an Entity.
+size_t System::unregisterEntity(Entity aEntity) {
+    auto index = mIndexes.find(aEntity);
+    if (mIndexes.end() == index) {
+        return 0;
+    }
+    size_t last = index->second;
+    if (last < mNbActiveEntities) {
+        if (mSweep != mSweeps[last]) {
+            --mNbPendingEntities;
+        }
+        // Move it at the end of the active Entities first
+        --mNbActiveEntities;
+        swapEntities(last, mNbActiveEntities);
+        last = mNbActiveEntities;
+    }
+    swapEntities(last, mEntities.size() - 1);
+    mEntities.pop_back();
+    mIdleFrames.pop_back();
+    mSweeps.pop_back();
+    mUpdateTimes.pop_back();
+    mIndexes.erase(aEntity);
+    return 1;
+}
+
+// Put a registered Entity to sleep: it is not updated anymore until woken up.
+bool System::sleepEntity(Entity aEntity) {
+    auto index = mIndexes.find(aEntity);
+    if ((mIndexes.end() == index) || (index->second >= mNbActiveEntities)) {
+        return false;
+    }
+    if (mSweep != mSweeps[index->second]) {
+        --mNbPendingEntities;
+    }
+    // Swap it with the last active Entity, and move the boundary
+    --mNbActiveEntities;
+    swapEntities(index->second, mNbActiveEntities);
+    return true;
+}
+
+// Wake up a sleeping Entity (and reset its count of idle frames).
+bool System::wakeEntity(Entity aEntity) {
+    auto index = mIndexes.find(aEntity);
+    if ((mIndexes.end() == index) || (index->second < mNbActiveEntities)) {
+        if (mIndexes.end() != index) {
+            mIdleFrames[index->second] = 0;
+        }
+        return false;
+    }
+    // Swap it with the first sleeping Entity, and move the boundary
+    mIdleFrames[index->second] = 0;
+    if (mSweep != mSweeps[index->second]) {
+        ++mNbPendingEntities;
+    }
+    swapEntities(index->second, mNbActiveEntities);
+    ++mNbActiveEntities;
+    return true;
+}
+
+// Apply the sleep policy for one frame: wake up the changed Entities, and age all other active ones.
+size_t System::applySleepPolicy(const std::vector<Entity>& aAddedEntities,
+                                const std::vector<Entity>& aChangedEntities) {
+    size_t nbSleepingEntities = 0;
+
+    if (0 < mSleepIdleFrames) {
+        for (auto entity  = aAddedEntities.begin();
+                  entity != aAddedEntities.end();
+                ++entity) {
+            wakeEntity(*entity);
+        }
+        for (auto entity  = aChangedEntities.begin();
+                  entity != aChangedEntities.end();
+                ++entity) {
+            wakeEntity(*entity);
+        }
+        // Backward, so that putting an Entity to sleep only swaps it with an already aged one
+        for (size_t index = mNbActiveEntities; 0 < index--; ) {
+            if (++mIdleFrames[index] > mSleepIdleFrames) {
+                sleepEntity(mEntities[index]);
+                ++nbSleepingEntities;
+            }
+        }
+    }
+
+    return nbSleepingEntities;
+}
+
+// Swap two registered Entities in the packed array.
+void System::swapEntities(size_t aIndex1, size_t aIndex2) {
+    if (aIndex1 != aIndex2) {
+        std::swap(mEntities[aIndex1], mEntities[aIndex2]);
+        std::swap(mIdleFrames[aIndex1], mIdleFrames[aIndex2]);
+        std::swap(mSweeps[aIndex1], mSweeps[aIndex2]);
+        std::swap(mUpdateTimes[aIndex1], mUpdateTimes[aIndex2]);
+        mIndexes[mEntities[aIndex1]] = aIndex1;
+        mIndexes[mEntities[aIndex2]] = aIndex2;
+    }
+}
+
+// Limit the rate at which the System is run by tick(), with an optional stagger.
+void System::setTickRate(float aTickRate, float aStagger /* = 0.0f */) {
+    mTickPeriod = (aTickRate > 0.0f) ? (1.0f / aTickRate) : 0.0f;
+    mTickTimer = aStagger * mTickPeriod;
+    mTickElapsed = 0.0f;
+}
+
+// Run the System if its tick period has elapsed, else only accumulate the elapsed time.
+size_t System::tick(float aElapsedTime) {
+    size_t nbUpdatedEntities = 0;
+
+    if (mTickPeriod > 0.0f) {
+        mTickTimer += aElapsedTime;
+        mTickElapsed += aElapsedTime;
+        if (mTickTimer >= mTickPeriod) {
+            // Run once with all the time elapsed since last run (no catch-up), keeping the stagger of the timer
+            mTickTimer = std::fmod(mTickTimer, mTickPeriod);
+            nbUpdatedEntities = updateEntities(mTickElapsed);
+            mTickElapsed = 0.0f;
+        }
+    } else {
+        nbUpdatedEntities = updateEntities(aElapsedTime);
+    }
+
+    return nbUpdatedEntities;
+}
+
+// Spread the update of the active Entities over multiple calls to updateEntities(), with a budget per call.
+void System::setTimeSlice(size_t aMaxEntities, float aMaxTime /* = 0.0f */) {
+    mSliceMaxEntities = aMaxEntities;
+    mSliceMaxTime = (aMaxTime > 0.0f) ? aMaxTime : 0.0f;
+    // Entities not updated since the last call are given the time elapsed since then
+    for (auto updateTime  = mUpdateTimes.begin();
+              updateTime != mUpdateTimes.end();
+            ++updateTime) {
+        *updateTime = mSliceTime;
+    }
+    startSweep();
+    mNbFramesPerSweep = 0;
+}
+
+// Start a new sweep over all the active Entities.
+void System::startSweep() {
+    ++mSweep;
+    if (0 == mSweep) {
+        // Wrapped around: forget the marks of old sweeps
+        mSweep = 1;
+        std::fill(mSweeps.begin(), mSweeps.end(), 0);
+    }
+    mNbPendingEntities = mNbActiveEntities;
+    mCursor = mNbActiveEntities;
+    mNbSweepFrames = 0;
+}
+
 /**
- * @brief Update function - for all matching Entities.
+ * @brief Update function - for all matching Entities, or for the next time slice of them.
  *
  * @param[in] aElapsedTime  Elapsed time since last update call, in seconds.
  */
 size_t System::updateEntities(float aElapsedTime) {
     size_t nbUpdatedEntities = 0;
+    const AllocationTracker::Counters start = AllocationTracker::getCounters();
+
+    if (isTimeSliced()) {
+        nbUpdatedEntities = updateSlice(aElapsedTime);
+    } else {
+        // Backward, so that updateEntity() can put Entities to sleep, or wake up another one, while iterating;
+        // each update is a complete sweep, so that an updated Entity swapped back below index is skipped.
+        startSweep();
+        for (size_t index = mNbActiveEntities; 0 < index--; ) {
+            if (mSweep != mSweeps[index]) {
+                // Marked before the update, which can put the Entity to sleep
+                mSweeps[index] = mSweep;
+                --mNbPendingEntities;
+                // For each active matching Entity, call the specialized System update method.
+                updateEntity(aElapsedTime, mEntities[index]);
+                ++nbUpdatedEntities;
+            }
+            // Never update a sleeping Entity, when updateEntity() has moved the end of the active range below index
+            if (index > mNbActiveEntities) {
+                index = mNbActiveEntities;
+            }
+        }
+    }
+
+    endUpdateEntities(aElapsedTime);
+
+    mAllocations = AllocationTracker::getCounters() - start;
+    return nbUpdatedEntities;
+}
+
+// Update the active Entities from the cursor, until the budget of the time slice is exhausted.
+size_t System::updateSlice(float aElapsedTime) {
+    typedef std::chrono::steady_clock Clock;
+    const Clock::time_point deadline = Clock::now() +
+        std::chrono::duration_cast<Clock::duration>(std::chrono::duration<float>(mSliceMaxTime));
+    size_t nbUpdatedEntities = 0;
 
-    for (auto entity  = mMatchingEntities.begin();
-              entity != mMatchingEntities.end();
-            ++entity) {
-        // For each matching Entity, call the specialized System update method.
-        updateEntity(aElapsedTime, *entity);
-        ++nbUpdatedEntities;
+    mSliceTime += aElapsedTime;
+    ++mNbSweepFrames;
+    if (mCursor > mNbActiveEntities) {
+        mCursor = mNbActiveEntities;
+    }
+    // Backward, like a full update; Entities swapped behind the cursor are caught by wrapping around,
+    // as long as the count of pending Entities says that some have not been updated by this sweep.
+    while ((0 < mNbPendingEntities) &&
+           ((0 == mSliceMaxEntities) || (nbUpdatedEntities < mSliceMaxEntities)) &&
+           ((0 == nbUpdatedEntities) || (mSliceMaxTime <= 0.0f) || (Clock::now() < deadline))) {
+        if (0 == mCursor) {
+            mCursor = mNbActiveEntities;
+        }
+        const size_t index = --mCursor;
+        if (mSweep != mSweeps[index]) {
+            // Marked before the update, which can put the Entity to sleep
+            mSweeps[index] = mSweep;
+            --mNbPendingEntities;
+            const float elapsedTime = static_cast<float>(mSliceTime - mUpdateTimes[index]);
+            mUpdateTimes[index] = mSliceTime;
+            updateEntity(elapsedTime, mEntities[index]);
+            ++nbUpdatedEntities;
+        }
+    }
+    if (0 == mNbPendingEntities) {
+        mNbFramesPerSweep = mNbSweepFrames;
+        startSweep();
     }
 
     return nbUpdatedEntities;
 }
 
+// Called at the end of updateEntities(), once all active Entities have been updated (does nothing).
+void System::endUpdateEntities(float /* aElapsedTime */) {
+}
+
+// Save the registered Entities, with their sleeping state, the tick timer, and the current sweep.
+void System::saveState(State& aState) const {
+    aState.mEntities = mEntities;
+    aState.mIdleFrames = mIdleFrames;
+    aState.mIndexes = mIndexes;
+    aState.mNbActiveEntities = mNbActiveEntities;
+    aState.mTickTimer = mTickTimer;
+    aState.mTickElapsed = mTickElapsed;
+    aState.mSweeps = mSweeps;
+    aState.mUpdateTimes = mUpdateTimes;
+    aState.mCursor = mCursor;
+    aState.mSweep = mSweep;
+    aState.mNbPendingEntities = mNbPendingEntities;
+    aState.mNbSweepFrames = mNbSweepFrames;
+    aState.mNbFramesPerSweep = mNbFramesPerSweep;
+    aState.mSliceTime = mSliceTime;
+}
+
+// Restore the registered Entities, with their sleeping state, the tick timer, and the current sweep (without matching).
+void System::restoreState(const State& aState) {
+    mEntities = aState.mEntities;
+    mIdleFrames = aState.mIdleFrames;
+    mIndexes = aState.mIndexes;
+    mNbActiveEntities = aState.mNbActiveEntities;
+    mTickTimer = aState.mTickTimer;
+    mTickElapsed = aState.mTickElapsed;
+    mSweeps = aState.mSweeps;
+    mUpdateTimes = aState.mUpdateTimes;
+    mCursor = aState.mCursor;
+    mSweep = aState.mSweep;
+    mNbPendingEntities = aState.mNbPendingEntities;
+    mNbSweepFrames = aState.mNbSweepFrames;
+    mNbFramesPerSweep = aState.mNbFramesPerSweep;
+    mSliceTime = aState.mSliceTime;
+}
+
 /* virtual pure method to be specialized by user classes
 void System::updateEntity(float aElapsedTime, Entity aEntity) {
 }
@@ -0,0 +1,212 @@
+/**
+ * @file    World.cpp
+ * @ingroup ecs
+ * @brief   A ecs::World runs multiple independent ecs::Manager shards in parallel.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/World.h>
+
+#include <stdexcept>
+
+namespace ecs {
+
+World::World(size_t aNbShards) :
+    mShards(),
+    mMigrations(aNbShards),
+    mMigratedEntities(),
+    mNbUpdatedEntities(aNbShards, 0),
+    mExceptions(aNbShards),
+    mThreads(),
+    mMutex(),
+    mStartCondition(),
+    mDoneCondition(),
+    mUpdateMethod(nullptr),
+    mElapsedTime(0.0f),
+    mFrame(0),
+    mNbPendingShards(0),
+    mbStopping(false) {
+    if ((0 == aNbShards) || (aNbShards > (static_cast<size_t>(1) << _entityShardBits))) {
+        throw std::runtime_error("The number of shards shall be in [1; 2^_entityShardBits]");
+    }
+    mShards.reserve(aNbShards);
+    for (size_t shard = 0; shard < aNbShards; ++shard) {
+        mShards.push_back(std::unique_ptr<Manager>(new Manager(static_cast<unsigned int>(shard))));
+    }
+    // The first shard is updated by the calling thread, while the others each get their own worker thread
+    mThreads.reserve(aNbShards - 1);
+    for (size_t shard = 1; shard < aNbShards; ++shard) {
+        mThreads.push_back(std::thread([this, shard]() {
+            run(shard);
+        }));
+    }
+}
+
+World::~World() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+    }
+    mStartCondition.notify_all();
+    for (auto thread  = mThreads.begin();
+              thread != mThreads.end();
+            ++thread) {
+        thread->join();
+    }
+}
+
+// Find the index of the shard currently holding an Entity.
+size_t World::findShard(const Entity aEntity) const {
+    auto migratedEntity = mMigratedEntities.find(aEntity);
+    if (mMigratedEntities.end() != migratedEntity) {
+        return migratedEntity->second;
+    }
+    return getEntityShard(aEntity);
+}
+
+// Request the migration of an Entity from a shard to another, applied at the next sync point.
+void World::requestMigration(size_t aFromShard, const Entity aEntity, size_t aToShard) {
+    if (aToShard >= mShards.size()) {
+        throw std::runtime_error("The target shard does not exist");
+    }
+    Migration migration = {aEntity, aToShard};
+    mMigrations.at(aFromShard).push_back(migration);
+}
+
+// Destroy an Entity in the shard currently holding it, forgetting where it has migrated.
+void World::destroyEntity(const Entity aEntity) {
+    const size_t shard = findShard(aEntity);
+    if (shard >= mShards.size()) {
+        throw std::runtime_error("The Entity does not exist");
+    }
+    mShards[shard]->destroyEntity(aEntity);
+    if (getEntityShard(aEntity) != shard) {
+        mMigratedEntities.erase(aEntity);
+        mShards[getEntityShard(aEntity)]->releaseEntity(aEntity);
+    }
+}
+
+// Apply all requested migrations (sync point), in order of shards, then in order of requests.
+size_t World::migrateEntities() {
+    size_t nbMigratedEntities = 0;
+
+    for (size_t shard = 0; shard < mShards.size(); ++shard) {
+        std::vector<Migration>& migrations = mMigrations[shard];
+        auto migration = migrations.begin();
+        try {
+            for (;
+                 migration != migrations.end();
+               ++migration) {
+                // Skip Entities destroyed (or already migrated) since the request
+                if ((shard != migration->mToShard) && mShards[shard]->hasEntity(migration->mEntity)) {
+                    mShards[shard]->migrateEntity(migration->mEntity, *(mShards[migration->mToShard]));
+                    // Only remember the location of Entities living away from the shard that created them
+                    if (getEntityShard(migration->mEntity) == migration->mToShard) {
+                        mMigratedEntities.erase(migration->mEntity);
+                    } else {
+                        mMigratedEntities[migration->mEntity] = migration->mToShard;
+                    }
+                    ++nbMigratedEntities;
+                }
+            }
+        } catch (...) {
+            // Drop the applied requests and the failed one, so that they are never applied again
+            migrations.erase(migrations.begin(), migration + 1);
+            throw;
+        }
+        migrations.clear(); // keep the capacity for next frames
+    }
+
+    return nbMigratedEntities;
+}
+
+// Update all Entities of all Systems of all shards in parallel, then apply requested migrations.
+size_t World::updateEntities(float aElapsedTime) {
+    return updateShards(&Manager::updateEntities, aElapsedTime);
+}
+
+// Run a frame of all shards in parallel, then apply requested migrations.
+size_t World::updateFrame(float aElapsedTime) {
+    return updateShards(&Manager::updateFrame, aElapsedTime);
+}
+
+// Run the update method on all shards in parallel, one thread per shard, then apply migrations.
+size_t World::updateShards(UpdateMethod aUpdateMethod, float aElapsedTime) {
+    // Wake up the worker threads of all other shards
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mUpdateMethod = aUpdateMethod;
+        mElapsedTime = aElapsedTime;
+        mNbPendingShards = mThreads.size();
+        ++mFrame;
+    }
+    mStartCondition.notify_all();
+
+    // The first shard is updated by the calling thread
+    try {
+        mNbUpdatedEntities[0] = (mShards[0].get()->*aUpdateMethod)(aElapsedTime);
+    } catch (...) {
+        mExceptions[0] = std::current_exception();
+    }
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        while (0 != mNbPendingShards) {
+            mDoneCondition.wait(lock);
+        }
+    }
+
+    // Sync point: all shards are done
+    size_t nbUpdatedEntitiesTotal = 0;
+    std::exception_ptr exception;
+    for (size_t shard = 0; shard < mShards.size(); ++shard) {
+        if (mExceptions[shard] && !exception) {
+            exception = mExceptions[shard];
+        }
+        mExceptions[shard] = std::exception_ptr(); // for next frames
+        nbUpdatedEntitiesTotal += mNbUpdatedEntities[shard];
+    }
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    migrateEntities();
+
+    return nbUpdatedEntitiesTotal;
+}
+
+// Loop of the worker thread of a shard, running the update method once per frame.
+void World::run(size_t aShard) {
+    Manager* pManager = mShards[aShard].get();
+    size_t frame = 0;
+    for (;;) {
+        UpdateMethod updateMethod;
+        float elapsedTime;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (!mbStopping && (frame == mFrame)) {
+                mStartCondition.wait(lock);
+            }
+            if (mbStopping) {
+                return;
+            }
+            frame = mFrame;
+            updateMethod = mUpdateMethod;
+            elapsedTime = mElapsedTime;
+        }
+        try {
+            mNbUpdatedEntities[aShard] = (pManager->*updateMethod)(elapsedTime);
+        } catch (...) {
+            mExceptions[aShard] = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            --mNbPendingShards;
+        }
+        mDoneCondition.notify_one();
+    }
+}
+
+} // namespace ecs
@@ -0,0 +1,313 @@
+/**
+ * @file    WorldLoader.cpp
+ * @ingroup ecs
+ * @brief   A ecs::WorldLoader streams chunked world files, decoded on background threads, into a ecs::Manager.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/WorldLoader.h>
+#include <ecs/WorldWriter.h>
+
+#include <chrono>
+#include <fstream>
+#include <stdexcept>
+
+namespace ecs {
+
+/// Read a 32 bits value from a buffer.
+static uint32_t readUInt32(const std::vector<uint8_t>& aBuffer, size_t aOffset) {
+    if (aOffset + sizeof(uint32_t) > aBuffer.size()) {
+        throw std::runtime_error("The chunk is truncated");
+    }
+    uint32_t value;
+    std::memcpy(&value, &aBuffer[aOffset], sizeof(value));
+    return value;
+}
+
+WorldLoader::WorldLoader(size_t aNbThreads /* = 1 */) :
+    mDecoders(),
+    mThreads(),
+    mMutex(),
+    mCondition(),
+    mbStopping(false),
+    mTasks(),
+    mChunks(),
+    mRegions(),
+    mNextRegionId(0) {
+    if (0 == aNbThreads) {
+        aNbThreads = 1;
+    }
+    mThreads.reserve(aNbThreads);
+    for (size_t thread = 0; thread < aNbThreads; ++thread) {
+        mThreads.push_back(std::thread([this]() {
+            run();
+        }));
+    }
+}
+
+WorldLoader::~WorldLoader() {
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbStopping = true;
+        mTasks.clear();
+    }
+    mCondition.notify_all();
+    for (auto thread  = mThreads.begin();
+              thread != mThreads.end();
+            ++thread) {
+        thread->join();
+    }
+}
+
+// Start loading a world file in the background, as a new region.
+WorldLoader::RegionId WorldLoader::load(const std::string& aPath) {
+    std::lock_guard<std::mutex> lock(mMutex);
+    const RegionId regionId = mNextRegionId++;
+    Region& region = mRegions[regionId];
+    region.mNbPendingChunks = 1; // the table of chunks
+    region.mbUnloaded = false;
+    const Task task = {regionId, aPath, 0, 0};
+    mTasks.push_back(task);
+    mCondition.notify_one();
+    return regionId;
+}
+
+// Commit decoded chunks into the Manager, until the time budget is spent (sync point).
+size_t WorldLoader::commit(Manager& aManager, float aBudget) {
+    size_t nbCreatedEntities = 0;
+    const auto start = std::chrono::steady_clock::now();
+    const auto budget = std::chrono::duration<float>(aBudget);
+
+    do {
+        std::unique_ptr<Chunk> chunk;
+        Region* pRegion = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if (mChunks.empty()) {
+                break;
+            }
+            chunk = std::move(mChunks.front());
+            mChunks.pop_front();
+            auto region = mRegions.find(chunk->mRegionId);
+            if (region->second.mbUnloaded || chunk->mError) {
+                discardChunk(chunk->mRegionId);
+                if (chunk->mError) {
+                    std::rethrow_exception(chunk->mError);
+                }
+                continue;
+            }
+            --region->second.mNbPendingChunks;
+            pRegion = &region->second; // stays valid: a region is only erased by unload(), or once unloaded
+        }
+
+        // Create all Entities of the chunk, then add each column of Components, and register the Entities
+        const size_t first = pRegion->mEntities.size();
+        pRegion->mEntities.reserve(first + chunk->mNbEntities);
+        for (size_t i = 0; i < chunk->mNbEntities; ++i) {
+            pRegion->mEntities.push_back(aManager.createEntity());
+        }
+        if (0 < chunk->mNbEntities) {
+            const Entity* pEntities = &pRegion->mEntities[first];
+            for (auto column  = chunk->mColumns.begin();
+                      column != chunk->mColumns.end();
+                    ++column) {
+                (*column)->commit(aManager, pEntities);
+            }
+            for (size_t i = 0; i < chunk->mNbEntities; ++i) {
+                aManager.registerEntity(pEntities[i]);
+            }
+        }
+        nbCreatedEntities += chunk->mNbEntities;
+    } while ((std::chrono::steady_clock::now() - start) < budget);
+
+    return nbCreatedEntities;
+}
+
+// Unload a region: destroy all its committed Entities, and discard its pending chunks.
+size_t WorldLoader::unload(RegionId aRegionId, Manager& aManager) {
+    std::vector<Entity> entities;
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        auto region = mRegions.find(aRegionId);
+        if ((mRegions.end() == region) || region->second.mbUnloaded) {
+            return 0;
+        }
+        entities.swap(region->second.mEntities);
+        if (0 == region->second.mNbPendingChunks) {
+            mRegions.erase(region);
+        } else {
+            // Forget the region once its pending chunks are discarded
+            region->second.mbUnloaded = true;
+        }
+    }
+
+    size_t nbDestroyedEntities = 0;
+    for (auto entity  = entities.begin();
+              entity != entities.end();
+            ++entity) {
+        if (aManager.hasEntity(*entity)) {
+            aManager.destroyEntity(*entity);
+            ++nbDestroyedEntities;
+        }
+    }
+    return nbDestroyedEntities;
+}
+
+// Test if all chunks of a region have been committed.
+bool WorldLoader::isLoaded(RegionId aRegionId) const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto region = mRegions.find(aRegionId);
+    return (mRegions.end() != region) && !region->second.mbUnloaded && (0 == region->second.mNbPendingChunks);
+}
+
+// Get the number of chunks not yet committed, of all regions.
+size_t WorldLoader::getNbPendingChunks() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    size_t nbPendingChunks = 0;
+    for (auto region  = mRegions.begin();
+              region != mRegions.end();
+            ++region) {
+        nbPendingChunks += region->second.mNbPendingChunks;
+    }
+    return nbPendingChunks;
+}
+
+// Get the Entities committed for a region.
+const std::vector<Entity>& WorldLoader::getEntities(RegionId aRegionId) const {
+    static const std::vector<Entity> _noEntities;
+    std::lock_guard<std::mutex> lock(mMutex);
+    auto region = mRegions.find(aRegionId);
+    return (mRegions.end() != region) ? region->second.mEntities : _noEntities;
+}
+
+// Loop of the background threads.
+void WorldLoader::run() {
+    for (;;) {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            while (!mbStopping && mTasks.empty()) {
+                mCondition.wait(lock);
+            }
+            if (mbStopping) {
+                return;
+            }
+            task = std::move(mTasks.front());
+            mTasks.pop_front();
+            auto region = mRegions.find(task.mRegionId);
+            if ((mRegions.end() == region) || region->second.mbUnloaded) {
+                discardChunk(task.mRegionId);
+                continue;
+            }
+        }
+
+        if (0 == task.mOffset) {
+            readTable(task);
+        } else {
+            std::unique_ptr<Chunk> chunk = readChunk(task);
+            std::lock_guard<std::mutex> lock(mMutex);
+            mChunks.push_back(std::move(chunk));
+        }
+    }
+}
+
+// Read the table of chunks of a file, queuing a Task for each chunk.
+void WorldLoader::readTable(const Task& aTask) {
+    std::vector<Task> tasks;
+    std::exception_ptr error;
+    try {
+        std::ifstream file(aTask.mPath.c_str(), std::ios::binary);
+        std::vector<uint8_t> header(4 * sizeof(uint32_t));
+        file.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        if (!file) {
+            throw std::runtime_error("Cannot read the world file " + aTask.mPath);
+        }
+        if ((WorldWriter::_mMagic != readUInt32(header, 0)) || (WorldWriter::_mVersion != readUInt32(header, 4))) {
+            throw std::runtime_error("The file is not a world file " + aTask.mPath);
+        }
+        const size_t nbChunks = readUInt32(header, 8);
+        std::vector<uint64_t> table(nbChunks * 2);
+        file.read(reinterpret_cast<char*>(table.data()), static_cast<std::streamsize>(table.size() * sizeof(uint64_t)));
+        if (!file) {
+            throw std::runtime_error("The world file is truncated " + aTask.mPath);
+        }
+        for (size_t chunk = 0; chunk < nbChunks; ++chunk) {
+            const Task task = {aTask.mRegionId, aTask.mPath, table[chunk * 2], table[(chunk * 2) + 1]};
+            tasks.push_back(task);
+        }
+    } catch (...) {
+        error = std::current_exception();
+    }
+
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (error) {
+        // Report the error as a chunk, replacing the table of chunks
+        std::unique_ptr<Chunk> chunk(new Chunk());
+        chunk->mRegionId = aTask.mRegionId;
+        chunk->mNbEntities = 0;
+        chunk->mError = error;
+        mChunks.push_back(std::move(chunk));
+    } else {
+        Region& region = mRegions[aTask.mRegionId];
+        region.mNbPendingChunks += tasks.size();
+        discardChunk(aTask.mRegionId); // the table of chunks itself
+        mTasks.insert(mTasks.end(), tasks.begin(), tasks.end());
+        mCondition.notify_all();
+    }
+}
+
+// Read and decode a chunk.
+std::unique_ptr<WorldLoader::Chunk> WorldLoader::readChunk(const Task& aTask) const {
+    std::unique_ptr<Chunk> chunk(new Chunk());
+    chunk->mRegionId = aTask.mRegionId;
+    chunk->mNbEntities = 0;
+    try {
+        std::ifstream file(aTask.mPath.c_str(), std::ios::binary);
+        std::vector<uint8_t> data(static_cast<size_t>(aTask.mSize));
+        file.seekg(static_cast<std::streamoff>(aTask.mOffset));
+        file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!file) {
+            throw std::runtime_error("Cannot read a chunk of the world file " + aTask.mPath);
+        }
+
+        const size_t nbEntities = readUInt32(data, 0);
+        const size_t nbColumns = readUInt32(data, 4);
+        size_t offset = 2 * sizeof(uint32_t);
+        for (size_t column = 0; column < nbColumns; ++column) {
+            const ComponentType componentType = readUInt32(data, offset);
+            const size_t componentSize = readUInt32(data, offset + 4);
+            offset += 2 * sizeof(uint32_t);
+            auto decoder = mDecoders.find(componentType);
+            if ((mDecoders.end() == decoder) || (decoder->second.mComponentSize != componentSize)) {
+                throw std::runtime_error("The type of Component of the chunk is not registered");
+            }
+            if (offset + (nbEntities * componentSize) > data.size()) {
+                throw std::runtime_error("The chunk is truncated");
+            }
+            chunk->mColumns.push_back(IComponentBatch::Ptr(decoder->second.mDecode(&data[offset], nbEntities)));
+            offset += nbEntities * componentSize;
+        }
+        chunk->mNbEntities = nbEntities;
+    } catch (...) {
+        chunk->mColumns.clear();
+        chunk->mError = std::current_exception();
+    }
+    return chunk;
+}
+
+// Account for a chunk that will never be committed (called with the mutex locked).
+void WorldLoader::discardChunk(RegionId aRegionId) {
+    auto region = mRegions.find(aRegionId);
+    if (mRegions.end() != region) {
+        --region->second.mNbPendingChunks;
+        if (region->second.mbUnloaded && (0 == region->second.mNbPendingChunks)) {
+            mRegions.erase(region);
+        }
+    }
+}
+
+} // namespace ecs
@@ -0,0 +1,90 @@
+/**
+ * @file    WorldWriter.cpp
+ * @ingroup ecs
+ * @brief   A ecs::WorldWriter builds a chunked world file, loaded by a ecs::WorldLoader.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/WorldWriter.h>
+
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+
+namespace ecs {
+
+/// Append a 32 bits value to a buffer.
+static void appendUInt32(std::vector<uint8_t>& aBuffer, uint32_t aValue) {
+    const uint8_t* pValue = reinterpret_cast<const uint8_t*>(&aValue);
+    aBuffer.insert(aBuffer.end(), pValue, pValue + sizeof(aValue));
+}
+
+WorldWriter::WorldWriter() :
+    mChunks(),
+    mNbEntities(0) {
+}
+
+WorldWriter::~WorldWriter() {
+}
+
+// Begin a new chunk of new Entities.
+void WorldWriter::beginChunk(size_t aNbEntities) {
+    mChunks.push_back(std::vector<uint8_t>());
+    mNbEntities = aNbEntities;
+    appendUInt32(mChunks.back(), static_cast<uint32_t>(aNbEntities));
+    appendUInt32(mChunks.back(), 0); // number of columns
+}
+
+// Add a column of raw Components of a type to the current chunk, one for each Entity.
+void WorldWriter::addColumn(ComponentType aComponentType, size_t aComponentSize, const void* apComponents) {
+    if (mChunks.empty()) {
+        throw std::runtime_error("No chunk has begun");
+    }
+    std::vector<uint8_t>& chunk = mChunks.back();
+    uint32_t nbColumns;
+    std::memcpy(&nbColumns, &chunk[sizeof(uint32_t)], sizeof(nbColumns));
+    ++nbColumns;
+    std::memcpy(&chunk[sizeof(uint32_t)], &nbColumns, sizeof(nbColumns));
+
+    appendUInt32(chunk, aComponentType);
+    appendUInt32(chunk, static_cast<uint32_t>(aComponentSize));
+    const uint8_t* pComponents = static_cast<const uint8_t*>(apComponents);
+    chunk.insert(chunk.end(), pComponents, pComponents + (mNbEntities * aComponentSize));
+}
+
+// Write all chunks to a file.
+void WorldWriter::write(const std::string& aPath) const {
+    std::vector<uint8_t> header;
+    appendUInt32(header, _mMagic);
+    appendUInt32(header, _mVersion);
+    appendUInt32(header, static_cast<uint32_t>(mChunks.size()));
+    appendUInt32(header, 0); // reserved
+
+    // Table of offsets and sizes of the chunks, following the header
+    uint64_t offset = header.size() + (mChunks.size() * 2 * sizeof(uint64_t));
+    for (auto chunk  = mChunks.begin();
+              chunk != mChunks.end();
+            ++chunk) {
+        const uint64_t entry[2] = {offset, chunk->size()};
+        const uint8_t* pEntry = reinterpret_cast<const uint8_t*>(entry);
+        header.insert(header.end(), pEntry, pEntry + sizeof(entry));
+        offset += chunk->size();
+    }
+
+    std::ofstream file(aPath.c_str(), std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    for (auto chunk  = mChunks.begin();
+              chunk != mChunks.end();
+            ++chunk) {
+        file.write(reinterpret_cast<const char*>(chunk->data()), static_cast<std::streamsize>(chunk->size()));
+    }
+    if (!file) {
+        throw std::runtime_error("Cannot write the file " + aPath);
+    }
+}
+
+} // namespace ecs
@@ -0,0 +1,194 @@
+/**
+ * @file    AllocationTracker_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the counting of allocations per frame and per System.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/AllocationTracker.h>
+#include <ecs/Manager.h>
+
+#include "../src/Utils.h" // defines the "override" identifier if needed (gcc < 4.7)
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+// A Component
+struct ComponentAllocation : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentAllocation(int aValue = 0) : mValue(aValue) {
+    }
+
+    int mValue;
+};
+const ecs::ComponentType ComponentAllocation::_mType = 13;
+
+// A System using a custom allocator (counting its allocations) for some Entities
+class SystemAllocation : public ecs::System {
+public:
+    explicit SystemAllocation(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mbAllocate(false) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentAllocation::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float, ecs::Entity aEntity) override {
+        ++mManager.getComponentStore<ComponentAllocation>().get(aEntity).mValue;
+        if (mbAllocate) {
+            ecs::AllocationTracker::recordAllocation(64);
+        }
+    }
+
+    bool mbAllocate; // Allocate for each Entity?
+};
+
+// Count allocations of the calling thread
+TEST(AllocationTracker, counters) {
+    const ecs::AllocationTracker::Counters start = ecs::AllocationTracker::getCounters();
+    ecs::AllocationTracker::recordAllocation(100);
+    ecs::AllocationTracker::recordAllocation(28);
+    const ecs::AllocationTracker::Counters recorded = ecs::AllocationTracker::getCounters() - start;
+    EXPECT_EQ(2U, recorded.mNbAllocations);
+    EXPECT_EQ(128U, recorded.mNbBytes);
+
+    // The global operator new is only counted when the library is built with ECS_TRACK_ALLOCATIONS
+    const ecs::AllocationTracker::Counters before = ecs::AllocationTracker::getCounters();
+    std::unique_ptr<int> value(new int(42));
+    const ecs::AllocationTracker::Counters allocated = ecs::AllocationTracker::getCounters() - before;
+    if (ecs::AllocationTracker::isEnabled()) {
+        EXPECT_EQ(1U, allocated.mNbAllocations);
+        EXPECT_EQ(sizeof(int), allocated.mNbBytes);
+    } else {
+        EXPECT_EQ(0U, allocated.mNbAllocations);
+    }
+}
+
+// Report the allocations of each frame and each System, and forbid allocations after the warm-up
+TEST(AllocationTracker, frames) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentAllocation>();
+    std::shared_ptr<SystemAllocation> system(new SystemAllocation(manager));
+    manager.addSystem(system);
+    manager.reserveEntities(100);
+    manager.getComponentStore<ComponentAllocation>().reserve(100);
+    const ComponentAllocation* pComponents = manager.getComponentStore<ComponentAllocation>().getComponents().data();
+    for (int i = 0; i < 100; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentAllocation(i));
+        manager.registerEntity(entity);
+    }
+    // The packed array did not grow
+    EXPECT_EQ(pComponents, manager.getComponentStore<ComponentAllocation>().getComponents().data());
+
+    // A steady-state frame does not allocate
+    manager.setAllocationCheck(ecs::Manager::eAllocationForbidden, 1);
+    manager.updateFrame(0.1f);
+    manager.updateFrame(0.1f);
+    EXPECT_EQ(0U, manager.getFrameAllocations().mNbAllocations);
+    EXPECT_EQ(0U, system->getAllocations().mNbAllocations);
+
+    // Allocations are reported per frame and per System
+    system->mbAllocate = true;
+    manager.setAllocationCheck(ecs::Manager::eAllocationReported);
+    manager.updateFrame(0.1f);
+    EXPECT_EQ(100U, system->getAllocations().mNbAllocations);
+    EXPECT_EQ(6400U, system->getAllocations().mNbBytes);
+    EXPECT_LE(100U, manager.getFrameAllocations().mNbAllocations);
+    EXPECT_EQ(1U, manager.getNbAllocatingFrames());
+
+    // Allocations are forbidden after the warm-up
+    manager.setAllocationCheck(ecs::Manager::eAllocationForbidden, 1);
+    manager.updateEntities(0.1f);
+    EXPECT_THROW(manager.updateEntities(0.1f), std::runtime_error);
+    EXPECT_EQ(1U, manager.getNbAllocatingFrames());
+}
+
+// A steady-state frame applying a sleep policy does not allocate
+TEST(AllocationTracker, sleepPolicy) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentAllocation>();
+    std::shared_ptr<SystemAllocation> system(new SystemAllocation(manager));
+    system->setSleepPolicy(ComponentAllocation::_mType, 5);
+    manager.addSystem(system);
+    manager.reserveEntities(10);
+    manager.getComponentStore<ComponentAllocation>().reserve(10);
+    for (int i = 0; i < 10; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentAllocation(i));
+        manager.registerEntity(entity);
+    }
+
+    manager.setAllocationCheck(ecs::Manager::eAllocationForbidden, 10);
+    for (size_t frame = 0; frame < 40; ++frame) {
+        // Keep the first Entity awake
+        ++manager.getComponentStore<ComponentAllocation>().modify(1).mValue;
+        EXPECT_NO_THROW(manager.updateFrame(0.1f));
+    }
+    EXPECT_EQ(0U, manager.getNbAllocatingFrames());
+    EXPECT_EQ(1U, system->getNbActiveEntities());
+}
+
+// A Tag
+struct TagAllocation : public ecs::Component {
+    static const ecs::ComponentType _mType;
+};
+const ecs::ComponentType TagAllocation::_mType = 16;
+
+// A System filtering out tagged Entities, toggling the Tag of an unregistered Entity at each update
+class SystemTagging : public ecs::System {
+public:
+    SystemTagging(ecs::Manager& aManager, ecs::Entity aTaggedEntity) :
+        ecs::System(aManager),
+        mTaggedEntity(aTaggedEntity) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentAllocation::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+        ecs::ComponentTypeSet excludedComponents;
+        excludedComponents.insert(TagAllocation::_mType);
+        setExcludedComponents(std::move(excludedComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float, ecs::Entity) override {
+        if (mManager.hasTag<TagAllocation>(mTaggedEntity)) {
+            mManager.removeTag<TagAllocation>(mTaggedEntity);
+        } else {
+            mManager.addTag<TagAllocation>(mTaggedEntity);
+        }
+    }
+
+    ecs::Entity mTaggedEntity; // Entity whose Tag is toggled
+};
+
+// Setting a Tag filtered by Systems and Queries does not allocate
+TEST(AllocationTracker, tags) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentAllocation>();
+    const ecs::Entity tagged = manager.createEntity();
+    manager.addSystem(ecs::System::Ptr(new SystemTagging(manager, tagged)));
+    ecs::ComponentTypeSet requiredComponents;
+    requiredComponents.insert(ComponentAllocation::_mType);
+    ecs::ComponentTypeSet excludedComponents;
+    excludedComponents.insert(TagAllocation::_mType);
+    manager.createQuery("untagged", ecs::ComponentFilter(std::move(requiredComponents),
+                                                         std::move(excludedComponents)));
+    const ecs::Entity entity = manager.createEntity();
+    manager.addComponent(entity, ComponentAllocation(0));
+    manager.registerEntity(entity);
+
+    manager.setAllocationCheck(ecs::Manager::eAllocationForbidden, 10);
+    for (size_t frame = 0; frame < 40; ++frame) {
+        EXPECT_NO_THROW(manager.updateFrame(0.1f));
+    }
+    EXPECT_EQ(0U, manager.getNbAllocatingFrames());
+    EXPECT_FALSE(manager.hasTag<TagAllocation>(tagged));
+}
@@ -0,0 +1,166 @@
+/**
+ * @file    AsyncSystem_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the asynchronous work of Systems, run on an Executor and applied at sync points.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/AsyncSystem.h>
+#include <ecs/Executor.h>
+#include <ecs/Manager.h>
+
+#include "../src/Utils.h" // defines the "override" identifier if needed (gcc < 4.7)
+
+#include <gtest/gtest.h>
+
+#include <future>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// A Component with the input of a slow request, and its result
+struct ComponentAsyncRequest : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentAsyncRequest(int aInput = 0) : mInput(aInput), mResult(0) {
+    }
+
+    int mInput;
+    int mResult;
+};
+const ecs::ComponentType ComponentAsyncRequest::_mType = 14;
+
+// A System sending requests by batches, the answers waiting for a gate to open
+class SystemAsyncRequest : public ecs::AsyncSystem {
+public:
+    SystemAsyncRequest(ecs::Manager& aManager, ecs::Executor& aExecutor, const std::shared_future<void>& aGate) :
+        ecs::AsyncSystem(aManager, aExecutor),
+        mGate(aGate),
+        mBatch() {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentAsyncRequest::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Copy the input of the Entity into the batch, launched when full.
+    virtual void updateEntity(float, ecs::Entity aEntity) override {
+        const int input = mManager.getComponentStore<ComponentAsyncRequest>().get(aEntity).mInput;
+        mBatch.push_back(std::make_pair(aEntity, input));
+        if (4 == mBatch.size()) {
+            launchBatch();
+        }
+    }
+
+    // Launch the last partial batch.
+    virtual void endUpdateEntities(float) override {
+        if (!mBatch.empty()) {
+            launchBatch();
+        }
+    }
+
+private:
+    typedef std::vector<std::pair<ecs::Entity, int> > Batch;
+
+    // Launch the request of a batch, on a thread of the Executor.
+    void launchBatch() {
+        std::shared_ptr<Batch> batch(new Batch());
+        batch->swap(mBatch);
+        std::shared_future<void> gate = mGate;
+        launch([batch, gate]() -> Completion {
+            gate.wait();
+            for (auto request  = batch->begin();
+                      request != batch->end();
+                    ++request) {
+                if (request->second < 0) {
+                    throw std::runtime_error("Invalid request");
+                }
+                request->second *= 2;
+            }
+            // Apply the answers to the Entities that still exist
+            return [batch](ecs::Manager& aManager) {
+                ecs::ComponentStore<ComponentAsyncRequest>& store = aManager.getComponentStore<ComponentAsyncRequest>();
+                for (auto request  = batch->begin();
+                          request != batch->end();
+                        ++request) {
+                    ComponentAsyncRequest* pComponent = store.find(request->first);
+                    if (nullptr != pComponent) {
+                        pComponent->mResult = request->second;
+                    }
+                }
+            };
+        });
+    }
+
+    std::shared_future<void>    mGate;  // Gate to open before answering requests
+    Batch                       mBatch; // Current batch of requests
+};
+
+// Run work on the threads of an Executor
+TEST(Executor, submit) {
+    ecs::Executor executor(2);
+    EXPECT_EQ(2U, executor.getNbThreads());
+    std::vector<std::future<int> > results;
+    for (int i = 0; i < 10; ++i) {
+        results.push_back(executor.submit([i]() {
+            return i * i;
+        }));
+    }
+    for (int i = 0; i < 10; ++i) {
+        EXPECT_EQ(i * i, results[static_cast<size_t>(i)].get());
+    }
+    std::future<void> failure = executor.submit([]() {
+        throw std::runtime_error("failure");
+    });
+    EXPECT_THROW(failure.get(), std::runtime_error);
+}
+
+// Launch batches of requests, overlapping with the frames, and apply their answers at later sync points
+TEST(AsyncSystem, completions) {
+    ecs::Executor executor(2);
+    std::promise<void> gate;
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentAsyncRequest>();
+    std::shared_ptr<SystemAsyncRequest> system(new SystemAsyncRequest(manager, executor, gate.get_future().share()));
+    manager.addSystem(system);
+    for (int i = 1; i <= 10; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentAsyncRequest(i));
+        manager.registerEntity(entity);
+    }
+
+    // The frame does not wait for the requests
+    EXPECT_EQ(10U, manager.updateEntities(0.1f));
+    EXPECT_EQ(3U, system->getNbPendingWorks());
+    EXPECT_EQ(0U, manager.applyCompletions());
+    EXPECT_EQ(0, manager.getComponentStore<ComponentAsyncRequest>().get(5).mResult);
+
+    // An Entity destroyed in the meantime is ignored by the Completion
+    manager.destroyEntity(5);
+    gate.set_value();
+    EXPECT_EQ(3U, system->waitCompletions());
+    EXPECT_EQ(0U, system->getNbPendingWorks());
+    EXPECT_EQ(2, manager.getComponentStore<ComponentAsyncRequest>().get(1).mResult);
+    EXPECT_EQ(20, manager.getComponentStore<ComponentAsyncRequest>().get(10).mResult);
+
+    // Completions are applied by the Manager at a later sync point
+    manager.getComponentStore<ComponentAsyncRequest>().get(1).mInput = 100;
+    manager.updateEntities(0.1f);
+    size_t nbApplied = 0;
+    while (nbApplied < 3) {
+        nbApplied += manager.applyCompletions();
+        std::this_thread::yield();
+    }
+    EXPECT_EQ(0U, system->getNbPendingWorks());
+    EXPECT_EQ(200, manager.getComponentStore<ComponentAsyncRequest>().get(1).mResult);
+
+    // The exception of a work is rethrown when applying its Completion, the following ones staying pending
+    const ecs::Entity first = system->getEntities().back(); // Entities are updated backward
+    manager.getComponentStore<ComponentAsyncRequest>().get(first).mInput = -1;
+    manager.updateEntities(0.1f);
+    EXPECT_THROW(system->waitCompletions(), std::runtime_error);
+    EXPECT_EQ(2U, system->waitCompletions());
+}
@@ -0,0 +1,191 @@
+/**
+ * @file    BlobComponentStore_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the Components of types defined at runtime.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/BlobComponentStore.h>
+#include <ecs/Manager.h>
+#include <ecs/Join.h>
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+// A static Component
+struct ComponentBlobTest : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentBlobTest(float aValue = 0.0f) : mValue(aValue) {
+    }
+
+    float mValue;
+};
+const ecs::ComponentType ComponentBlobTest::_mType = 1;
+
+// Describing the fields of a Component
+TEST(BlobComponentStore, layout) {
+    ecs::ComponentLayout layout("Health");
+    EXPECT_EQ("Health", layout.getName());
+    EXPECT_EQ(0U, layout.addField("alive", ecs::ComponentLayout::eBool));
+    EXPECT_EQ(1U, layout.addField("points", ecs::ComponentLayout::eFloat));
+    EXPECT_EQ(2U, layout.addField("regen", ecs::ComponentLayout::eDouble));
+    EXPECT_EQ(4U, layout.getField(1).mOffset);
+    EXPECT_EQ(8U, layout.getField(2).mOffset);
+    EXPECT_EQ(16U, layout.getSize());
+    EXPECT_EQ(8U, layout.getAlignment());
+    EXPECT_EQ(1U, layout.findField("points"));
+    EXPECT_THROW(layout.findField("unknown"), std::runtime_error);
+    EXPECT_THROW(layout.addField("points", ecs::ComponentLayout::eInt32), std::runtime_error);
+    EXPECT_THROW(layout.addField("misaligned", ecs::ComponentLayout::eInt32, 2), std::runtime_error);
+    EXPECT_THROW(layout.addField("overlap", ecs::ComponentLayout::eInt32, 12), std::runtime_error);
+    EXPECT_EQ(3U, layout.addField("owner", ecs::ComponentLayout::eEntity, 16));
+    EXPECT_EQ(24U, layout.getSize());
+}
+
+// Adding, accessing, removing and sorting Components
+TEST(BlobComponentStore, store) {
+    ecs::ComponentLayout layout("Score");
+    const size_t value = layout.addField("value", ecs::ComponentLayout::eInt32);
+    const size_t owner = layout.addField("owner", ecs::ComponentLayout::eEntity);
+    EXPECT_THROW(ecs::BlobComponentStore(100, ecs::ComponentLayout("Empty")), std::runtime_error);
+    ecs::BlobComponentStore store(100, layout);
+    EXPECT_EQ(8U, store.getStride());
+
+    for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+        void* pComponent = store.add(entity);
+        ASSERT_NE(nullptr, pComponent);
+        EXPECT_EQ(0, store.getField<int32_t>(pComponent, value));
+        store.getField<int32_t>(pComponent, value) = static_cast<int32_t>(entity) * 10;
+        store.getField<ecs::Entity>(pComponent, owner) = entity;
+    }
+    EXPECT_EQ(nullptr, store.add(1));
+    EXPECT_THROW(store.getField<float>(store.get(1), value), std::runtime_error);
+    EXPECT_EQ(10U, store.size());
+
+    EXPECT_TRUE(store.remove(2));
+    EXPECT_FALSE(store.remove(2));
+    EXPECT_FALSE(store.has(2));
+    EXPECT_FALSE(store.isSortedByEntity());
+    EXPECT_EQ(100, store.getField<int32_t>(store.get(10), value));
+    store.sortByEntity();
+    EXPECT_TRUE(store.isSortedByEntity());
+    EXPECT_EQ(3U, store.getEntities()[1]);
+    EXPECT_EQ(30, store.getField<int32_t>(store.getAt(1), value));
+    EXPECT_EQ(10U, store.getField<ecs::Entity>(store.get(10), owner));
+
+    const ecs::Entity clones[] = {20, 21};
+    EXPECT_EQ(2U, store.clone(5, clones, 2));
+    EXPECT_EQ(50, store.getField<int32_t>(store.get(21), value));
+
+    ecs::BlobComponentStore target(100, layout);
+    EXPECT_TRUE(store.moveTo(20, target));
+    EXPECT_FALSE(store.has(20));
+    EXPECT_EQ(50, target.getField<int32_t>(target.get(20), value));
+}
+
+// Using runtime Components alongside static ones
+TEST(BlobComponentStore, manager) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentBlobTest>());
+    ecs::ComponentLayout layout("Speed");
+    const size_t speed = layout.addField("speed", ecs::ComponentLayout::eFloat);
+    const ecs::ComponentType speedType = manager.createBlobComponentStore(layout);
+    EXPECT_EQ(ecs::_maxComponentTypes - 1, speedType);
+    EXPECT_EQ(speedType, manager.getBlobComponentType("Speed"));
+    EXPECT_THROW(manager.createBlobComponentStore(layout), std::runtime_error);
+    EXPECT_THROW(manager.getBlobComponentType("Unknown"), std::runtime_error);
+    EXPECT_THROW(manager.getBlobComponentStore(ComponentBlobTest::_mType), std::runtime_error);
+    ecs::BlobComponentStore& speedStore = manager.getBlobComponentStore(speedType);
+
+    for (int i = 0; i < 10; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        EXPECT_TRUE(manager.addComponent(entity, ComponentBlobTest(1.0f)));
+        if (0 == (i % 2)) {
+            speedStore.getField<float>(manager.addComponent(entity, speedType), speed) = static_cast<float>(i);
+        }
+    }
+    EXPECT_THROW(manager.addComponent(ecs::_invalidEntity, speedType), std::runtime_error);
+
+    // Querying runtime Components by their type
+    ecs::ComponentTypeSet requiredComponents;
+    requiredComponents.insert(speedType);
+    std::vector<ecs::Entity> entities;
+    EXPECT_EQ(5U, manager.queryEntities(ecs::ComponentFilter(std::move(requiredComponents)), entities));
+
+    // Joining runtime and static Components
+    ecs::IComponentStore* const stores[] = {&speedStore, &manager.getComponentStore<ComponentBlobTest>()};
+    ecs::Join join;
+    EXPECT_EQ(5U, join.compute(stores, 2));
+    float sum = 0.0f;
+    join.forEach([&](ecs::Entity, const size_t* apIndexes) {
+        sum += speedStore.getField<float>(speedStore.getAt(apIndexes[0]), speed) *
+               manager.getComponentStore<ComponentBlobTest>().getAt(apIndexes[1]).mValue;
+    });
+    EXPECT_FLOAT_EQ(20.0f, sum);
+
+    // Prefabs copy runtime Components too
+    std::vector<ecs::Entity> instances;
+    manager.instantiate(entities[0], 3, instances);
+    EXPECT_EQ(8U, speedStore.size());
+    manager.destroyEntity(instances[0]);
+    EXPECT_EQ(7U, speedStore.size());
+}
+
+// A Tag using a ComponentType reserved to runtime Components
+struct TagBlobReserved : public ecs::Component {
+    static const ecs::ComponentType _mType;
+};
+const ecs::ComponentType TagBlobReserved::_mType = ecs::_maxComponentTypes - 1;
+
+// Runtime Components only use the highest ComponentTypes, reserved to them
+TEST(BlobComponentStore, reservedTypes) {
+    ecs::Manager manager;
+    const ecs::Entity entity = manager.createEntity();
+    EXPECT_THROW(manager.addTag<TagBlobReserved>(entity), std::runtime_error);
+
+    for (unsigned int i = 0; i < ECS_RUNTIME_COMPONENT_TYPES; ++i) {
+        ecs::ComponentLayout layout("Runtime" + std::to_string(i));
+        layout.addField("value", ecs::ComponentLayout::eInt32);
+        const ecs::ComponentType componentType = manager.createBlobComponentStore(layout);
+        EXPECT_LE(ecs::_firstRuntimeComponentType, componentType);
+        EXPECT_GT(ecs::_maxComponentTypes, componentType);
+    }
+    ecs::ComponentLayout layout("Full");
+    layout.addField("value", ecs::ComponentLayout::eInt32);
+    EXPECT_THROW(manager.createBlobComponentStore(layout), std::runtime_error);
+    EXPECT_THROW(manager.getBlobComponentType("Full"), std::runtime_error);
+}
+
+// Migrating runtime Components between shards which gave the same ComponentType to different types
+TEST(BlobComponentStore, migrate) {
+    ecs::Manager manager1;
+    ecs::Manager manager2(2);
+    ecs::ComponentLayout speedLayout("Speed");
+    const size_t speed = speedLayout.addField("speed", ecs::ComponentLayout::eFloat);
+    ecs::ComponentLayout nameLayout("Name");
+    nameLayout.addField("id", ecs::ComponentLayout::eInt32);
+    const ecs::ComponentType speedType = manager1.createBlobComponentStore(speedLayout);
+    EXPECT_EQ(speedType, manager2.createBlobComponentStore(nameLayout));
+    EXPECT_TRUE(speedLayout.isSameAs(speedLayout));
+    EXPECT_FALSE(speedLayout.isSameAs(nameLayout));
+
+    const ecs::Entity entity = manager1.createEntity();
+    ecs::BlobComponentStore& speedStore1 = manager1.getBlobComponentStore(speedType);
+    speedStore1.getField<float>(manager1.addComponent(entity, speedType), speed) = 2.0f;
+    EXPECT_THROW(manager1.migrateEntity(entity, manager2), std::runtime_error);
+    EXPECT_TRUE(manager1.hasEntity(entity));
+    EXPECT_TRUE(speedStore1.has(entity));
+
+    // The same layout, under the same ComponentType
+    ecs::Manager manager3(3);
+    EXPECT_EQ(speedType, manager3.createBlobComponentStore(speedLayout));
+    EXPECT_EQ(0U, manager1.migrateEntity(entity, manager3));
+    ecs::BlobComponentStore& speedStore3 = manager3.getBlobComponentStore(speedType);
+    EXPECT_FLOAT_EQ(2.0f, speedStore3.getField<float>(speedStore3.get(entity), speed));
+}
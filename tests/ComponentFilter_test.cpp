@@ -0,0 +1,54 @@
+/**
+ * @file    ComponentFilter_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of a ComponentFilter.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/ComponentFilter.h>
+
+#include <gtest/gtest.h>
+
+// Matching required, excluded and optional Components
+TEST(ComponentFilter, matches) {
+    ecs::ComponentTypeSet entity12;
+    entity12.insert(1);
+    entity12.insert(2);
+    ecs::ComponentTypeSet entity123;
+    entity123.insert(1);
+    entity123.insert(2);
+    entity123.insert(3);
+
+    // An empty filter matches any Entity
+    ecs::ComponentFilter empty;
+    EXPECT_TRUE(empty.matches(ecs::ComponentTypeSet()));
+    EXPECT_TRUE(empty.matches(entity12));
+
+    // Require Components 1 & 2
+    ecs::ComponentTypeSet required;
+    required.insert(1);
+    required.insert(2);
+    ecs::ComponentFilter filter(std::move(required));
+    EXPECT_FALSE(filter.matches(ecs::ComponentTypeSet()));
+    EXPECT_TRUE(filter.matches(entity12));
+    EXPECT_TRUE(filter.matches(entity123));
+
+    // Exclude Component 3
+    ecs::ComponentTypeSet excluded;
+    excluded.insert(3);
+    filter.setExcludedComponents(std::move(excluded));
+    EXPECT_TRUE(filter.matches(entity12));
+    EXPECT_FALSE(filter.matches(entity123));
+
+    // Optional Components do not change the matching
+    ecs::ComponentTypeSet optional;
+    optional.insert(4);
+    filter.setOptionalComponents(std::move(optional));
+    EXPECT_TRUE(filter.matches(entity12));
+    EXPECT_FALSE(filter.matches(entity123));
+    EXPECT_EQ(1U, filter.getOptionalComponents().count(4));
+}
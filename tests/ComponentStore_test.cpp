@@ -90,3 +90,100 @@ TEST(ComponentStore, hasHadRemove) {
     EXPECT_FALSE(store.has(entity1));
     EXPECT_FALSE(store.has(entity2));
 }
+
+// Finding optional Components
+TEST(ComponentStore, find) {
+    ecs::ComponentStore<ComponentTest1> store;
+    ecs::Entity entity1 = 1;
+    ecs::Entity entity2 = 2;
+    EXPECT_EQ(nullptr, store.find(entity1));
+    EXPECT_TRUE(store.add(entity1, ComponentTest1(123)));
+    ASSERT_NE(nullptr, store.find(entity1));
+    EXPECT_EQ(123, store.find(entity1)->m);
+    EXPECT_EQ(nullptr, store.find(entity2));
+    // Modify the Component through the pointer
+    store.find(entity1)->m = 456;
+    EXPECT_EQ(456, store.get(entity1).m);
+    // Read-only access
+    const ecs::ComponentStore<ComponentTest1>& constStore = store;
+    ASSERT_NE(nullptr, constStore.find(entity1));
+    EXPECT_EQ(456, constStore.find(entity1)->m);
+    EXPECT_EQ(456, constStore.get(entity1).m);
+    EXPECT_EQ(nullptr, constStore.find(entity2));
+    EXPECT_THROW(constStore.get(entity2), std::out_of_range);
+    // Only a non-const access changes the version of the store
+    const uint64_t version = store.getVersion();
+    EXPECT_EQ(456, store.read(entity1).m);
+    EXPECT_THROW(store.read(entity2), std::out_of_range);
+    EXPECT_EQ(version, store.getVersion());
+    EXPECT_EQ(456, store.get(entity1).m);
+    EXPECT_NE(version, store.getVersion());
+    EXPECT_TRUE(store.remove(entity1));
+    EXPECT_EQ(nullptr, store.find(entity1));
+}
+
+// Tracking added, removed and changed Components
+TEST(ComponentStore, trackChanges) {
+    ecs::ComponentStore<ComponentTest1> store;
+    ecs::Entity entity1 = 1;
+    ecs::Entity entity2 = 2;
+    // Nothing is recorded until tracking is enabled
+    EXPECT_FALSE(store.isTrackingChanges());
+    EXPECT_TRUE(store.add(entity1, ComponentTest1(123)));
+    store.modify(entity1).m = 456;
+    EXPECT_TRUE(store.getAddedEntities().empty());
+    EXPECT_TRUE(store.getChangedEntities().empty());
+
+    store.setTrackChanges(true);
+    EXPECT_TRUE(store.add(entity2, ComponentTest1(789)));
+    EXPECT_FALSE(store.add(entity2, ComponentTest1(666))); // not added
+    EXPECT_EQ(789, store.modify(entity2).m);
+    store.markChanged(entity1);
+    EXPECT_TRUE(store.remove(entity1));
+    EXPECT_FALSE(store.remove(entity1)); // not removed
+    EXPECT_EQ(789, store.extract(entity2).m);
+    ASSERT_EQ(1U, store.getAddedEntities().size());
+    EXPECT_EQ(entity2, store.getAddedEntities()[0]);
+    ASSERT_EQ(2U, store.getRemovedEntities().size());
+    EXPECT_EQ(entity1, store.getRemovedEntities()[0]);
+    EXPECT_EQ(entity2, store.getRemovedEntities()[1]);
+    ASSERT_EQ(2U, store.getChangedEntities().size());
+    EXPECT_EQ(entity2, store.getChangedEntities()[0]);
+    EXPECT_EQ(entity1, store.getChangedEntities()[1]);
+
+    store.clearChanges();
+    EXPECT_TRUE(store.getAddedEntities().empty());
+    EXPECT_TRUE(store.getRemovedEntities().empty());
+    EXPECT_TRUE(store.getChangedEntities().empty());
+}
+
+// Packed arrays of Components and Entities, and cloning a Component
+TEST(ComponentStore, packedAndClone) {
+    ecs::ComponentStore<ComponentTest1> store;
+    EXPECT_TRUE(store.add(1, ComponentTest1(10)));
+    EXPECT_TRUE(store.add(2, ComponentTest1(20)));
+    EXPECT_TRUE(store.add(3, ComponentTest1(30)));
+    EXPECT_EQ(3U, store.size());
+
+    // Removing a Component moves the last one in its place
+    EXPECT_TRUE(store.remove(1));
+    ASSERT_EQ(2U, store.size());
+    EXPECT_EQ(3U, store.getEntities()[0]);
+    EXPECT_EQ(30, store.getComponents()[0].m);
+    EXPECT_EQ(2U, store.getEntities()[1]);
+    EXPECT_EQ(30, store.get(3).m);
+
+    const ecs::Entity clones[] = {4, 5, 6};
+    EXPECT_EQ(3U, store.clone(2, clones, 3));
+    EXPECT_EQ(5U, store.size());
+    EXPECT_EQ(20, store.get(6).m);
+    EXPECT_EQ(6U, store.getEntities()[4]);
+    EXPECT_EQ(0U, store.clone(1, clones, 3));
+
+    // Cloning to an Entity already having a Component fails without any change
+    const ecs::Entity clones2[] = {7, 4};
+    EXPECT_THROW(store.clone(3, clones2, 2), std::runtime_error);
+    EXPECT_EQ(5U, store.size());
+    EXPECT_FALSE(store.has(7));
+    EXPECT_EQ(20, store.get(4).m);
+}
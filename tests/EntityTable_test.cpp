@@ -0,0 +1,101 @@
+/**
+ * @file    EntityTable_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the flat open-addressing table of Entities.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/EntityTable.h>
+
+#include <gtest/gtest.h>
+
+// Insert, find and erase Entities, some of them from other shards colliding with the local ones
+TEST(EntityTable, insertFindErase) {
+    ecs::EntityTable<int> table;
+    EXPECT_EQ(0U, table.size());
+    EXPECT_FALSE(table.has(1));
+    EXPECT_FALSE(table.erase(1));
+    EXPECT_THROW(table.insert(ecs::_invalidEntity, 0), std::runtime_error);
+
+    const ecs::Entity otherShard = ecs::getShardBaseEntity(1);
+    for (ecs::Entity entity = 1; entity <= 100; ++entity) {
+        table.insert(entity, static_cast<int>(entity));
+        table.insert(otherShard + entity, -static_cast<int>(entity));
+    }
+    EXPECT_EQ(200U, table.size());
+    EXPECT_THROW(table.insert(50, 0), std::runtime_error);
+    ASSERT_NE(nullptr, table.find(42));
+    EXPECT_EQ(42, *table.find(42));
+    ASSERT_NE(nullptr, table.find(otherShard + 42));
+    EXPECT_EQ(-42, *table.find(otherShard + 42));
+    EXPECT_EQ(nullptr, table.find(101));
+
+    // Erasing keeps all other Entities reachable, and the records packed
+    for (ecs::Entity entity = 1; entity <= 100; entity += 2) {
+        EXPECT_TRUE(table.erase(entity));
+        EXPECT_TRUE(table.erase(otherShard + entity + 1));
+    }
+    EXPECT_FALSE(table.erase(1));
+    EXPECT_EQ(100U, table.size());
+    for (ecs::Entity entity = 1; entity <= 100; ++entity) {
+        EXPECT_EQ(0 == (entity % 2), table.has(entity));
+        EXPECT_EQ(1 == (entity % 2), table.has(otherShard + entity));
+    }
+    for (size_t index = 0; index < table.size(); ++index) {
+        EXPECT_EQ(table.getAt(index), *table.find(table.getEntities()[index]));
+    }
+}
+
+// Reserving memory beforehand
+TEST(EntityTable, reserve) {
+    ecs::EntityTable<int> table;
+    table.reserve(1000);
+    const ecs::Entity first = 1;
+    int& record = table.insert(first, 1);
+    for (ecs::Entity entity = 2; entity <= 1000; ++entity) {
+        table.insert(entity, static_cast<int>(entity));
+    }
+    EXPECT_EQ(&record, table.find(first)); // no reallocation
+    EXPECT_EQ(1000U, table.size());
+}
+
+// Spawning and despawning Entities continuously, some of them reusing the indexes of others
+TEST(EntityTable, churn) {
+    ecs::EntityTable<ecs::Entity> table;
+    const ecs::Entity nbEntities = 20000;
+    for (ecs::Entity entity = 1; entity <= nbEntities; ++entity) {
+        table.insert(entity, entity);
+    }
+
+    // Each frame destroys the oldest Entities and creates as many new ones
+    ecs::Entity oldest = 1;
+    ecs::Entity next = nbEntities + 1;
+    for (int frame = 0; frame < 100; ++frame) {
+        for (int i = 0; i < 1000; ++i) {
+            EXPECT_TRUE(table.erase(oldest));
+            table.insert(next, next);
+            ++oldest;
+            ++next;
+        }
+        EXPECT_EQ(static_cast<size_t>(nbEntities), table.size());
+    }
+    EXPECT_FALSE(table.has(oldest - 1));
+    for (ecs::Entity entity = oldest; entity < next; ++entity) {
+        ASSERT_NE(nullptr, table.find(entity));
+        EXPECT_EQ(entity, *table.find(entity));
+    }
+
+    // Reusing an index with the next generation
+    EXPECT_TRUE(table.erase(oldest));
+    const ecs::Entity reused = ecs::getNextGenerationEntity(oldest);
+    EXPECT_NE(oldest, reused);
+    EXPECT_EQ(ecs::getEntityIndex(oldest), ecs::getEntityIndex(reused));
+    EXPECT_EQ(1U, ecs::getEntityGeneration(reused));
+    table.insert(reused, reused);
+    EXPECT_FALSE(table.has(oldest));
+    EXPECT_TRUE(table.has(reused));
+}
@@ -0,0 +1,126 @@
+/**
+ * @file    EventBus_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the EventBus, its EventChannels and FrameArenas.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/EventBus.h>
+#include <ecs/Entity.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+// A test Event
+struct EventTest1 : public ecs::Event {
+    static const ecs::EventType _mType;
+
+    EventTest1(ecs::Entity aEntity, int aValue) : mEntity(aEntity), mValue(aValue) {
+    }
+
+    ecs::Entity mEntity;
+    int         mValue;
+};
+const ecs::EventType EventTest1::_mType = 1;
+
+// A test functor, summing the values of Events
+struct SumEventTest1 {
+    explicit SumEventTest1(long long& aSum) : mSum(aSum) {
+    }
+    void operator()(const EventTest1& aEvent) const {
+        mSum += aEvent.mValue;
+    }
+    long long& mSum;
+};
+
+// Allocating from a FrameArena
+TEST(FrameArena, allocateReset) {
+    ecs::FrameArena arena(1024);
+    EXPECT_EQ(0U, arena.getCapacity());
+    void* p1 = arena.allocate(10, 1);
+    void* p2 = arena.allocate(8, 8);
+    EXPECT_EQ(0U, reinterpret_cast<size_t>(p2) % 8);
+    EXPECT_LE(static_cast<char*>(p1) + 10, static_cast<char*>(p2));
+    EXPECT_EQ(1024U, arena.getCapacity());
+    // A large allocation gets its own block
+    EXPECT_NE(nullptr, arena.allocate(4096, 16));
+    EXPECT_LT(4096U, arena.getCapacity());
+    const size_t capacity = arena.getCapacity();
+    // After a reset, the same memory is reused without any new block
+    arena.reset();
+    EXPECT_EQ(p1, arena.allocate(10, 1));
+    EXPECT_EQ(p2, arena.allocate(8, 8));
+    EXPECT_NE(nullptr, arena.allocate(4096, 16));
+    EXPECT_EQ(capacity, arena.getCapacity());
+}
+
+// Emitting and consuming Events, cleared at each frame
+TEST(EventBus, emitForEachClear) {
+    ecs::EventBus bus;
+    EXPECT_THROW(bus.getChannel<EventTest1>(), std::runtime_error);
+    EXPECT_TRUE(bus.createChannel<EventTest1>());
+    EXPECT_FALSE(bus.createChannel<EventTest1>());
+    EXPECT_THROW(bus.setNbSlots(2), std::runtime_error);
+    ecs::EventChannel<EventTest1>& channel = bus.getChannel<EventTest1>();
+    EXPECT_EQ(0U, channel.size());
+
+    // Emit more Events than the capacity of the first batch
+    for (int i = 1; i <= 1000; ++i) {
+        channel.emit(EventTest1(static_cast<ecs::Entity>(i), i));
+    }
+    EXPECT_EQ(1000U, channel.size());
+    long long sum = 0;
+    int previous = 0;
+    channel.forEach([&](const EventTest1& aEvent) {
+        EXPECT_EQ(previous + 1, aEvent.mValue); // in order of emission
+        previous = aEvent.mValue;
+        sum += aEvent.mValue;
+    });
+    EXPECT_EQ(500500, sum);
+
+    // Clear all Events, and reuse the same memory for the next frame
+    const size_t capacity = bus.getArena(0).getCapacity();
+    bus.clear();
+    EXPECT_EQ(0U, channel.size());
+    for (int i = 1; i <= 1000; ++i) {
+        channel.emit(EventTest1(static_cast<ecs::Entity>(i), 2 * i));
+    }
+    sum = 0;
+    channel.forEach(SumEventTest1(sum));
+    EXPECT_EQ(1001000, sum);
+    EXPECT_EQ(capacity, bus.getArena(0).getCapacity());
+}
+
+// Emitting Events from multiple threads, one slot per thread
+TEST(EventBus, emitMultipleSlots) {
+    const size_t nbSlots = 4;
+    ecs::EventBus bus(nbSlots);
+    EXPECT_EQ(nbSlots, bus.getNbSlots());
+    EXPECT_TRUE(bus.createChannel<EventTest1>());
+    ecs::EventChannel<EventTest1>& channel = bus.getChannel<EventTest1>();
+
+    std::vector<std::thread> threads;
+    for (size_t slot = 0; slot < nbSlots; ++slot) {
+        threads.push_back(std::thread([slot, &channel]() {
+            for (int i = 1; i <= 10000; ++i) {
+                channel.emit(slot, EventTest1(static_cast<ecs::Entity>(slot), i));
+            }
+        }));
+    }
+    for (size_t slot = 0; slot < nbSlots; ++slot) {
+        threads[slot].join();
+    }
+
+    // Sync point: all Events are consumed, in order of slots
+    EXPECT_EQ(nbSlots * 10000, channel.size());
+    long long sum = 0;
+    channel.forEach(SumEventTest1(sum));
+    EXPECT_EQ(static_cast<long long>(nbSlots) * 50005000, sum);
+    bus.clear();
+    EXPECT_EQ(0U, channel.size());
+}
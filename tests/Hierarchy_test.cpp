@@ -0,0 +1,162 @@
+/**
+ * @file    Hierarchy_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of a Hierarchy of Entities.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Hierarchy.h>
+#include <ecs/ComponentStore.h>
+
+#include <gtest/gtest.h>
+
+#include <map>
+#include <stdexcept>
+
+// A Component propagated from parents to children
+struct ComponentHierarchyPosition : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    ComponentHierarchyPosition(float aLocal, float aWorld) : mLocal(aLocal), mWorld(aWorld) {
+    }
+
+    float mLocal;
+    float mWorld;
+};
+const ecs::ComponentType ComponentHierarchyPosition::_mType = 17;
+
+// Attaching and detaching Entities
+TEST(Hierarchy, attach) {
+    ecs::Hierarchy hierarchy;
+    EXPECT_EQ(0U, hierarchy.size());
+    EXPECT_EQ(0U, hierarchy.getNbLevels());
+
+    // 1 -> (3 -> 4, 2)
+    hierarchy.attach(2, 1);
+    hierarchy.attach(3, 1);
+    hierarchy.attach(4, 3);
+    EXPECT_EQ(4U, hierarchy.size());
+    EXPECT_EQ(3U, hierarchy.getNbLevels());
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getParent(1));
+    EXPECT_EQ(1U, hierarchy.getParent(2));
+    EXPECT_EQ(3U, hierarchy.getFirstChild(1));
+    EXPECT_EQ(2U, hierarchy.getNextSibling(3));
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getNextSibling(2));
+    EXPECT_EQ(2U, hierarchy.getDepth(4));
+    EXPECT_EQ(2U, hierarchy.getLevel(1).size());
+    ASSERT_EQ(1U, hierarchy.getLevel(2).size());
+    EXPECT_EQ(4U, hierarchy.getLevel(2)[0].mEntity);
+    EXPECT_EQ(3U, hierarchy.getLevel(2)[0].mParent);
+
+    // No cycle
+    EXPECT_THROW(hierarchy.attach(1, 4), std::runtime_error);
+    EXPECT_THROW(hierarchy.attach(3, 3), std::runtime_error);
+    EXPECT_THROW(hierarchy.getDepth(5), std::runtime_error);
+
+    // Moving the subtree of 3 under 2: 1 -> 2 -> 3 -> 4
+    hierarchy.attach(3, 2);
+    EXPECT_EQ(2U, hierarchy.getFirstChild(1));
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getNextSibling(2));
+    EXPECT_EQ(3U, hierarchy.getDepth(4));
+    EXPECT_EQ(4U, hierarchy.getNbLevels());
+
+    // Detaching 3: 1 -> 2, 3 -> 4
+    hierarchy.detach(3);
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getParent(3));
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getFirstChild(2));
+    EXPECT_EQ(1U, hierarchy.getDepth(4));
+    EXPECT_EQ(2U, hierarchy.getNbLevels());
+    EXPECT_EQ(2U, hierarchy.getLevel(0).size());
+}
+
+// Removing Entities and subtrees
+TEST(Hierarchy, remove) {
+    ecs::Hierarchy hierarchy;
+    // 1 -> 2 -> (3, 4 -> 5)
+    hierarchy.attach(2, 1);
+    hierarchy.attach(3, 2);
+    hierarchy.attach(4, 2);
+    hierarchy.attach(5, 4);
+
+    // Children of a removed Entity become roots
+    EXPECT_TRUE(hierarchy.remove(2));
+    EXPECT_FALSE(hierarchy.remove(2));
+    EXPECT_FALSE(hierarchy.has(2));
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getFirstChild(1));
+    EXPECT_EQ(ecs::_invalidEntity, hierarchy.getParent(4));
+    EXPECT_EQ(1U, hierarchy.getDepth(5));
+    EXPECT_EQ(3U, hierarchy.getLevel(0).size());
+
+    hierarchy.attach(4, 1);
+    std::vector<ecs::Entity> removedEntities;
+    EXPECT_EQ(3U, hierarchy.removeSubtree(1, removedEntities));
+    ASSERT_EQ(3U, removedEntities.size());
+    EXPECT_EQ(1U, removedEntities[0]);
+    EXPECT_EQ(4U, removedEntities[1]);
+    EXPECT_EQ(5U, removedEntities[2]);
+    EXPECT_EQ(1U, hierarchy.size());
+    EXPECT_EQ(1U, hierarchy.getNbLevels());
+    EXPECT_EQ(0U, hierarchy.removeSubtree(1, removedEntities));
+}
+
+// Propagating values from parents to children, level by level
+TEST(Hierarchy, propagate) {
+    ecs::Hierarchy hierarchy;
+    // 1 -> (2 -> 4, 3 -> 5 -> 6)
+    hierarchy.attach(5, 3);
+    hierarchy.attach(6, 5);
+    hierarchy.attach(2, 1);
+    hierarchy.attach(3, 1);
+    hierarchy.attach(4, 2);
+
+    std::map<ecs::Entity, float> local;
+    for (ecs::Entity entity = 1; entity <= 6; ++entity) {
+        local[entity] = static_cast<float>(entity);
+    }
+    std::map<ecs::Entity, float> world = local;
+    EXPECT_EQ(5U, hierarchy.propagate([&](ecs::Entity aEntity, ecs::Entity aParent) {
+        world[aEntity] = world[aParent] + local[aEntity];
+    }));
+    EXPECT_FLOAT_EQ(1.0f, world[1]);
+    EXPECT_FLOAT_EQ(3.0f, world[2]);
+    EXPECT_FLOAT_EQ(7.0f, world[4]);
+    EXPECT_FLOAT_EQ(9.0f, world[5]);
+    EXPECT_FLOAT_EQ(15.0f, world[6]);
+}
+
+// Propagating Components from parents to children, level by level
+TEST(Hierarchy, propagateStore) {
+    ecs::Hierarchy hierarchy;
+    // 1 -> (2 -> 4, 3 -> 5 -> 6)
+    hierarchy.attach(5, 3);
+    hierarchy.attach(6, 5);
+    hierarchy.attach(2, 1);
+    hierarchy.attach(3, 1);
+    hierarchy.attach(4, 2);
+
+    // Entity 4 has no position
+    ecs::ComponentStore<ComponentHierarchyPosition> store;
+    for (ecs::Entity entity = 1; entity <= 6; ++entity) {
+        if (4 != entity) {
+            const float position = static_cast<float>(entity);
+            EXPECT_TRUE(store.add(entity, ComponentHierarchyPosition(position, position)));
+        }
+    }
+    auto function = [](ComponentHierarchyPosition& aPosition, const ComponentHierarchyPosition& aParentPosition) {
+        aPosition.mWorld = aParentPosition.mWorld + aPosition.mLocal;
+    };
+    EXPECT_EQ(4U, hierarchy.propagate(store, function));
+    EXPECT_FLOAT_EQ(1.0f, store.read(1).mWorld);
+    EXPECT_FLOAT_EQ(3.0f, store.read(2).mWorld);
+    EXPECT_FLOAT_EQ(9.0f, store.read(5).mWorld);
+    EXPECT_FLOAT_EQ(15.0f, store.read(6).mWorld);
+
+    // Level by level
+    EXPECT_EQ(2U, hierarchy.propagateLevel(1, store, function));
+    EXPECT_EQ(1U, hierarchy.propagateLevel(2, store, function));
+    EXPECT_THROW(hierarchy.propagateLevel(4, store, function), std::out_of_range);
+}
@@ -0,0 +1,120 @@
+/**
+ * @file    Join_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the intersection of packed Entity arrays.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Join.h>
+#include <ecs/AllocationTracker.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <iterator>
+#include <cstdlib>
+
+// A Test Component
+struct ComponentJoin1 : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentJoin1(int aValue = 0) : mValue(aValue) {
+    }
+
+    int mValue;
+};
+const ecs::ComponentType ComponentJoin1::_mType = 1;
+// A second Component
+struct ComponentJoin2 : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentJoin2(int aValue = 0) : mValue(aValue) {
+    }
+
+    int mValue;
+};
+const ecs::ComponentType ComponentJoin2::_mType = 2;
+
+// Check intersectEntities() against std::set_intersection
+static void checkIntersection(const std::vector<ecs::Entity>& aEntities1, const std::vector<ecs::Entity>& aEntities2) {
+    std::vector<ecs::Entity> expected;
+    std::set_intersection(aEntities1.begin(), aEntities1.end(), aEntities2.begin(), aEntities2.end(),
+                          std::back_inserter(expected));
+    std::vector<size_t> indexes1;
+    std::vector<size_t> indexes2;
+    ASSERT_EQ(expected.size(), ecs::intersectEntities(aEntities1.data(), aEntities1.size(),
+                                                      aEntities2.data(), aEntities2.size(), indexes1, indexes2));
+    ASSERT_EQ(expected.size(), indexes1.size());
+    ASSERT_EQ(expected.size(), indexes2.size());
+    for (size_t match = 0; match < expected.size(); ++match) {
+        EXPECT_EQ(expected[match], aEntities1[indexes1[match]]);
+        EXPECT_EQ(expected[match], aEntities2[indexes2[match]]);
+    }
+}
+
+// Random strictly increasing Entities
+static std::vector<ecs::Entity> randomEntities(size_t aSize, unsigned int aMaxGap) {
+    std::vector<ecs::Entity> entities;
+    ecs::Entity entity = 0;
+    for (size_t index = 0; index < aSize; ++index) {
+        entity += 1 + static_cast<ecs::Entity>(std::rand()) % aMaxGap;
+        entities.push_back(entity);
+    }
+    return entities;
+}
+
+// Intersecting arrays of similar sizes (merge), and of very different sizes (galloping)
+TEST(Join, intersectEntities) {
+    std::srand(42);
+    checkIntersection(std::vector<ecs::Entity>(), randomEntities(10, 3));
+    checkIntersection(randomEntities(3, 2), randomEntities(3, 2));
+    for (int iteration = 0; iteration < 20; ++iteration) {
+        checkIntersection(randomEntities(1000, 3), randomEntities(1200, 3));
+        checkIntersection(randomEntities(17, 200), randomEntities(5000, 2));
+        checkIntersection(randomEntities(5000, 2), randomEntities(20, 200));
+    }
+    std::vector<ecs::Entity> identical = randomEntities(101, 5);
+    checkIntersection(identical, identical);
+}
+
+// Joining ComponentStores
+TEST(Join, compute) {
+    ecs::ComponentStore<ComponentJoin1> store1;
+    ecs::ComponentStore<ComponentJoin2> store2;
+    for (ecs::Entity entity = 1; entity <= 100; ++entity) {
+        EXPECT_TRUE(store1.add(entity, ComponentJoin1(static_cast<int>(entity))));
+        if (0 == (entity % 3)) {
+            EXPECT_TRUE(store2.add(entity, ComponentJoin2(-static_cast<int>(entity))));
+        }
+    }
+    // Removing Components breaks the order of the packed arrays, restored by the Join
+    EXPECT_TRUE(store1.remove(3));
+    EXPECT_TRUE(store2.remove(99));
+    EXPECT_FALSE(store1.isSortedByEntity());
+
+    ecs::Join join;
+    EXPECT_EQ(0U, join.compute(nullptr, 0));
+    EXPECT_EQ(31U, join.compute(store2, store1));
+    EXPECT_TRUE(store1.isSortedByEntity());
+    EXPECT_EQ(2U, join.getNbStores());
+    EXPECT_EQ(6U, join.getEntity(0));
+    int sum = 0;
+    EXPECT_EQ(31U, join.forEach([&](ecs::Entity aEntity, const size_t* apIndexes) {
+        EXPECT_EQ(-static_cast<int>(aEntity), store2.getAt(apIndexes[0]).mValue);
+        EXPECT_EQ(static_cast<int>(aEntity), store1.getAt(apIndexes[1]).mValue);
+        sum += store1.getAt(apIndexes[1]).mValue + store2.getAt(apIndexes[0]).mValue;
+    }));
+    EXPECT_EQ(0, sum);
+
+    // A store is always sorted, and only one row per Entity
+    EXPECT_EQ(99U, join.compute(store1, store1, store1));
+
+    // Computing again reuses all the buffers of the Join
+    const ecs::AllocationTracker::Counters before = ecs::AllocationTracker::getCounters();
+    EXPECT_EQ(99U, join.compute(store1, store1, store1));
+    EXPECT_EQ(0U, (ecs::AllocationTracker::getCounters() - before).mNbAllocations);
+}
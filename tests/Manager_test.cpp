@@ -15,6 +15,10 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+
 // A Test Component
 struct ComponentTest1a : public ecs::Component {
     static const ecs::ComponentType _mType;
@@ -46,6 +50,22 @@ struct ComponentTest3 : public ecs::Component {
     static const ecs::ComponentType _mType;
 };
 const ecs::ComponentType ComponentTest3::_mType = 3;
+// A Tag (empty Component without ComponentStore)
+struct TagTest4 : public ecs::Component {
+    static const ecs::ComponentType _mType;
+};
+const ecs::ComponentType TagTest4::_mType = 4;
+
+// A move-only Component
+struct ComponentTestMoveOnly : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentTestMoveOnly(int aValue = 0) : mpValue(new int(aValue)) {
+    }
+
+    std::unique_ptr<int> mpValue;
+};
+const ecs::ComponentType ComponentTestMoveOnly::_mType = 5;
 
 
 // A test System, requiring ComponentTest1a
@@ -84,6 +104,81 @@ public:
     }
 };
 
+// A test System, requiring ComponentTest1a but excluding ComponentTest2, with optional ComponentTest3
+class SystemTest3 : public ecs::System {
+public:
+    explicit SystemTest3(ecs::Manager& aManager) :
+        ecs::System(aManager) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentTest1a::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+        ecs::ComponentTypeSet excludedComponents;
+        excludedComponents.insert(ComponentTest2::_mType);
+        setExcludedComponents(std::move(excludedComponents));
+        ecs::ComponentTypeSet optionalComponents;
+        optionalComponents.insert(ComponentTest3::_mType);
+        setOptionalComponents(std::move(optionalComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        mManager.getComponentStore<ComponentTest1a>().get(aEntity).mValue += aElapsedTime;
+    }
+};
+
+// A test System, requiring ComponentTest1a but excluding TagTest4
+class SystemTest4 : public ecs::System {
+public:
+    explicit SystemTest4(ecs::Manager& aManager) :
+        ecs::System(aManager) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentTest1a::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+        ecs::ComponentTypeSet excludedComponents;
+        excludedComponents.insert(TagTest4::_mType);
+        setExcludedComponents(std::move(excludedComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        mManager.getComponentStore<ComponentTest1a>().get(aEntity).mValue += aElapsedTime;
+    }
+};
+
+// A test System, requiring ComponentTest1a, sleeping after 2 frames without change
+class SystemTestSleep : public ecs::System {
+public:
+    explicit SystemTestSleep(ecs::Manager& aManager) :
+        ecs::System(aManager) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentTest1a::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+        setSleepPolicy(ComponentTest1a::_mType, 2);
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float, ecs::Entity) override {
+    }
+};
+
+// A test observer, recording batches of changes
+class ObserverTest : public ecs::ComponentObserver {
+public:
+    virtual void onAdded(ecs::ComponentType, const std::vector<ecs::Entity>& aEntities) override {
+        mAdded = aEntities;
+    }
+    virtual void onRemoved(ecs::ComponentType, const std::vector<ecs::Entity>& aEntities) override {
+        mRemoved = aEntities;
+    }
+    virtual void onChanged(ecs::ComponentType, const std::vector<ecs::Entity>& aEntities) override {
+        mChanged = aEntities;
+    }
+
+    std::vector<ecs::Entity> mAdded;
+    std::vector<ecs::Entity> mRemoved;
+    std::vector<ecs::Entity> mChanged;
+};
+
 // Creating entities
 TEST(Manager, createEntity) {
     ecs::Manager manager;
@@ -195,3 +290,484 @@ TEST(Manager, registerEntityToSystems) {
     EXPECT_FLOAT_EQ(1*0.016667f, manager.getComponentStore<ComponentTest2>().get(entity3).mValue1);
     EXPECT_FLOAT_EQ(1*0.016667f, manager.getComponentStore<ComponentTest2>().get(entity3).mValue2);
 }
+
+// Registering Entity with Systems excluding some Components
+TEST(Manager, registerEntityWithFilters) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest2>());
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest3>());
+
+    ecs::System::Ptr system(new SystemTest3(manager));
+    manager.addSystem(system);
+
+    // First Entity matches (Component 1a, without Component 2)
+    ecs::Entity entity1 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_EQ(1U, manager.registerEntity(entity1));
+    EXPECT_TRUE(system->hasEntity(entity1));
+
+    // Second Entity does not match (having the excluded Component 2)
+    ecs::Entity entity2 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest2()));
+    EXPECT_EQ(0U, manager.registerEntity(entity2));
+    EXPECT_FALSE(system->hasEntity(entity2));
+
+    // Third Entity matches (with the optional Component 3)
+    ecs::Entity entity3 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity3, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity3, ComponentTest3()));
+    EXPECT_EQ(1U, manager.registerEntity(entity3));
+    EXPECT_TRUE(system->hasEntity(entity3));
+    EXPECT_EQ(nullptr, manager.getComponentStore<ComponentTest3>().find(entity1));
+    EXPECT_NE(nullptr, manager.getComponentStore<ComponentTest3>().find(entity3));
+
+    // Filtered Entities are never updated
+    EXPECT_EQ(2U, manager.updateEntities(0.016667f)); // 16.667ms
+    EXPECT_FLOAT_EQ(0.016667f, manager.getComponentStore<ComponentTest1a>().get(entity1).mValue);
+    EXPECT_FLOAT_EQ(0.0f, manager.getComponentStore<ComponentTest1a>().get(entity2).mValue);
+    EXPECT_FLOAT_EQ(0.016667f, manager.getComponentStore<ComponentTest1a>().get(entity3).mValue);
+
+    // Ad-hoc query of the same filter
+    std::vector<ecs::Entity> entities;
+    EXPECT_EQ(2U, manager.queryEntities(system->getFilter(), entities));
+    ASSERT_EQ(2U, entities.size());
+    EXPECT_NE(entities.end(), std::find(entities.begin(), entities.end(), entity1));
+    EXPECT_NE(entities.end(), std::find(entities.begin(), entities.end(), entity3));
+}
+
+// Running frames with phases, fixed time steps and tick rates
+TEST(Manager, updateFrame) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    EXPECT_THROW(manager.setFixedTimeStep(0.0f, 4), std::runtime_error);
+    manager.setFixedTimeStep(0.25f, 4);
+
+    ecs::System::Ptr systemPre(new SystemTest1(manager));
+    systemPre->setPhase(ecs::System::ePreUpdate);
+    manager.addSystem(systemPre);
+    ecs::System::Ptr systemFixed(new SystemTest1(manager));
+    systemFixed->setPhase(ecs::System::eFixedUpdate);
+    manager.addSystem(systemFixed);
+    ecs::System::Ptr systemSlow(new SystemTest1(manager));
+    systemSlow->setTickRate(1.0f);
+    manager.addSystem(systemSlow);
+
+    ecs::Entity entity1 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_EQ(3U, manager.registerEntity(entity1));
+
+    // Not enough time for a fixed step nor for the slow System
+    EXPECT_EQ(1U, manager.updateFrame(0.125f));
+    EXPECT_FLOAT_EQ(0.5f, manager.getFixedTimeAlpha());
+    // One fixed step
+    EXPECT_EQ(2U, manager.updateFrame(0.125f));
+    EXPECT_FLOAT_EQ(0.0f, manager.getFixedTimeAlpha());
+    // Three fixed steps, and the slow System runs with the 1s elapsed since the first frame
+    EXPECT_EQ(5U, manager.updateFrame(0.75f));
+    EXPECT_FLOAT_EQ(0.0f, manager.getFixedTimeAlpha());
+    EXPECT_FLOAT_EQ((0.125f + 0.125f + 0.75f) + (4 * 0.25f) + 1.0f,
+                    manager.getComponentStore<ComponentTest1a>().get(entity1).mValue);
+    // Catch-up is limited to 4 fixed steps, the time left over is dropped
+    EXPECT_EQ(1U + 4U + 1U, manager.updateFrame(2.125f));
+    EXPECT_FLOAT_EQ(0.5f, manager.getFixedTimeAlpha());
+}
+
+// Destroying Entities
+TEST(Manager, destroyEntity) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest2>());
+    ecs::System::Ptr system(new SystemTest2(manager));
+    manager.addSystem(system);
+
+    ecs::Entity entity1 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest2()));
+    EXPECT_EQ(1U, manager.registerEntity(entity1));
+    EXPECT_TRUE(manager.hasEntity(entity1));
+
+    manager.destroyEntity(entity1);
+    EXPECT_FALSE(manager.hasEntity(entity1));
+    EXPECT_FALSE(system->hasEntity(entity1));
+    EXPECT_FALSE(manager.getComponentStore<ComponentTest1a>().has(entity1));
+    EXPECT_FALSE(manager.getComponentStore<ComponentTest2>().has(entity1));
+    EXPECT_EQ(0U, manager.updateEntities(0.016667f)); // 16.667ms
+    EXPECT_THROW(manager.destroyEntity(entity1), std::runtime_error);
+
+    // The index of the destroyed Entity is reused, with the next generation
+    ecs::Entity entity2 = manager.createEntity();
+    EXPECT_NE(entity1, entity2);
+    EXPECT_EQ(ecs::getEntityIndex(entity1), ecs::getEntityIndex(entity2));
+    EXPECT_FALSE(manager.hasEntity(entity1));
+    EXPECT_TRUE(manager.hasEntity(entity2));
+    EXPECT_FALSE(manager.getComponentStore<ComponentTest1a>().has(entity2));
+
+    // Spawning and despawning never runs out of indexes, the generation wrapping around
+    for (ecs::Entity i = 0; i < (4 * (ecs::_maxEntityGeneration + 1)); ++i) {
+        manager.destroyEntity(entity2);
+        entity2 = manager.createEntity();
+        EXPECT_EQ(ecs::getEntityIndex(entity1), ecs::getEntityIndex(entity2));
+    }
+    EXPECT_EQ(ecs::getEntityIndex(entity1) + 1, ecs::getEntityIndex(manager.createEntity()));
+}
+
+// Migrating Entities between Managers
+TEST(Manager, migrateEntity) {
+    ecs::Manager manager1;
+    ecs::Manager manager2(2);
+    EXPECT_EQ(0U, manager1.getShardId());
+    EXPECT_EQ(2U, manager2.getShardId());
+    EXPECT_TRUE(manager1.createComponentStore<ComponentTest1a>());
+    EXPECT_TRUE(manager1.createComponentStore<ComponentTest2>());
+    EXPECT_TRUE(manager2.createComponentStore<ComponentTest1a>());
+    ecs::System::Ptr system1(new SystemTest1(manager1));
+    manager1.addSystem(system1);
+    ecs::System::Ptr system2(new SystemTest1(manager2));
+    manager2.addSystem(system2);
+
+    ecs::Entity entity1 = manager1.createEntity();
+    EXPECT_TRUE(manager1.addComponent(entity1, ComponentTest1a(1.0f)));
+    EXPECT_EQ(1U, manager1.registerEntity(entity1));
+
+    // The Entity moves with its Component, keeping its Id
+    EXPECT_EQ(1U, manager1.migrateEntity(entity1, manager2));
+    EXPECT_FALSE(manager1.hasEntity(entity1));
+    EXPECT_FALSE(system1->hasEntity(entity1));
+    EXPECT_FALSE(manager1.getComponentStore<ComponentTest1a>().has(entity1));
+    EXPECT_TRUE(manager2.hasEntity(entity1));
+    EXPECT_TRUE(system2->hasEntity(entity1));
+    EXPECT_FLOAT_EQ(1.0f, manager2.getComponentStore<ComponentTest1a>().get(entity1).mValue);
+    EXPECT_THROW(manager1.migrateEntity(entity1, manager2), std::runtime_error);
+
+    // Cannot migrate an Entity to a Manager missing one of its ComponentStore
+    ecs::Entity entity2 = manager1.createEntity();
+    EXPECT_TRUE(manager1.addComponent(entity2, ComponentTest2()));
+    EXPECT_THROW(manager1.migrateEntity(entity2, manager2), std::runtime_error);
+    EXPECT_TRUE(manager1.hasEntity(entity2));
+    EXPECT_TRUE(manager1.getComponentStore<ComponentTest2>().has(entity2));
+}
+
+// Reserving Entities concurrently from multiple threads, and reading Components concurrently
+TEST(Manager, reserveEntity) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    ecs::Entity entity1 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a(1.0f)));
+
+    const size_t nbThreads = 4;
+    const size_t nbEntitiesPerThread = 1000;
+    std::vector<std::vector<ecs::Entity> > reservedEntities(nbThreads);
+    std::vector<float> readValues(nbThreads, 0.0f);
+    std::vector<std::thread> threads;
+    const ecs::Manager& constManager = manager;
+    for (size_t i = 0; i < nbThreads; ++i) {
+        std::vector<ecs::Entity>* pEntities = &reservedEntities[i];
+        float* pValue = &readValues[i];
+        threads.push_back(std::thread([=, &manager, &constManager]() {
+            for (size_t j = 0; j < nbEntitiesPerThread; ++j) {
+                pEntities->push_back(manager.reserveEntity());
+                *pValue += constManager.getComponentStore<ComponentTest1a>().get(entity1).mValue;
+            }
+        }));
+    }
+    for (size_t i = 0; i < nbThreads; ++i) {
+        threads[i].join();
+    }
+
+    // Reserved Entities do not exist until the sync point
+    EXPECT_FALSE(manager.hasEntity(reservedEntities[0][0]));
+    EXPECT_EQ(nbThreads * nbEntitiesPerThread, manager.createReservedEntities());
+    EXPECT_EQ(0U, manager.createReservedEntities());
+
+    // All reserved Entities are unique, and now exist
+    std::vector<ecs::Entity> allEntities;
+    for (size_t i = 0; i < nbThreads; ++i) {
+        EXPECT_FLOAT_EQ(static_cast<float>(nbEntitiesPerThread), readValues[i]);
+        allEntities.insert(allEntities.end(), reservedEntities[i].begin(), reservedEntities[i].end());
+    }
+    std::sort(allEntities.begin(), allEntities.end());
+    EXPECT_EQ(allEntities.end(), std::unique(allEntities.begin(), allEntities.end()));
+    for (size_t i = 0; i < allEntities.size(); ++i) {
+        EXPECT_TRUE(manager.hasEntity(allEntities[i]));
+    }
+    EXPECT_EQ((ecs::Entity)(nbThreads * nbEntitiesPerThread + 2), manager.createEntity());
+}
+
+// Observing batches of changes of Components at sync points
+TEST(Manager, observers) {
+    ecs::Manager manager;
+    std::shared_ptr<ObserverTest> observer(new ObserverTest());
+    EXPECT_THROW(manager.addObserver(ComponentTest1a::_mType, observer), std::runtime_error);
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    manager.addObserver(ComponentTest1a::_mType, observer);
+    EXPECT_EQ(0U, manager.notifyObservers());
+
+    ecs::Entity entity1 = manager.createEntity();
+    ecs::Entity entity2 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a()));
+    // Nothing is delivered before the sync point
+    EXPECT_TRUE(observer->mAdded.empty());
+    EXPECT_EQ(1U, manager.notifyObservers());
+    ASSERT_EQ(2U, observer->mAdded.size());
+    EXPECT_EQ(entity1, observer->mAdded[0]);
+    EXPECT_EQ(entity2, observer->mAdded[1]);
+
+    // Changes are delivered at the end of a frame, sorted without duplicates
+    ecs::System::Ptr system(new SystemTest1(manager));
+    manager.addSystem(system);
+    EXPECT_EQ(1U, manager.registerEntity(entity2));
+    manager.getComponentStore<ComponentTest1a>().modify(entity2).mValue = 1.0f;
+    manager.getComponentStore<ComponentTest1a>().markChanged(entity1);
+    manager.getComponentStore<ComponentTest1a>().markChanged(entity2);
+    EXPECT_EQ(1U, manager.updateFrame(0.016667f)); // 16.667ms
+    ASSERT_EQ(2U, observer->mChanged.size());
+    EXPECT_EQ(entity1, observer->mChanged[0]);
+    EXPECT_EQ(entity2, observer->mChanged[1]);
+
+    // Destroyed Entities are delivered as removed
+    manager.destroyEntity(entity1);
+    EXPECT_EQ(1U, manager.notifyObservers());
+    ASSERT_EQ(1U, observer->mRemoved.size());
+    EXPECT_EQ(entity1, observer->mRemoved[0]);
+    EXPECT_EQ(0U, manager.notifyObservers());
+}
+
+// Setting and getting unique Resources
+TEST(Manager, resources) {
+    ecs::Manager manager;
+    EXPECT_FALSE(manager.hasResource<ComponentTest2>());
+    EXPECT_THROW(manager.getResource<ComponentTest2>(), std::runtime_error);
+    EXPECT_TRUE(manager.setResource(ComponentTest2(1.0f, 2.0f)));
+    EXPECT_TRUE(manager.hasResource<ComponentTest2>());
+    EXPECT_FALSE(manager.hasResource<ComponentTest1a>());
+    ComponentTest2& resource = manager.getResource<ComponentTest2>();
+    EXPECT_FLOAT_EQ(1.0f, resource.mValue1);
+    EXPECT_FLOAT_EQ(2.0f, resource.mValue2);
+
+    // Replacing a Resource keeps references valid
+    EXPECT_FALSE(manager.setResource(ComponentTest2(3.0f, 4.0f)));
+    EXPECT_EQ(&resource, &manager.getResource<ComponentTest2>());
+    EXPECT_FLOAT_EQ(3.0f, resource.mValue1);
+    resource.mValue2 = 5.0f;
+    const ecs::Manager& constManager = manager;
+    EXPECT_FLOAT_EQ(5.0f, constManager.getResource<ComponentTest2>().mValue2);
+
+    // A Resource is independent from the ComponentStore of the same type
+    EXPECT_THROW(manager.getComponentStore<ComponentTest2>(), std::runtime_error);
+    EXPECT_TRUE(manager.setResource(ComponentTest1a(6.0f)));
+    EXPECT_FLOAT_EQ(6.0f, manager.getResource<ComponentTest1a>().mValue);
+}
+
+// Adding and removing Tags, stored only in the Signature of Entities
+TEST(Manager, tags) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    manager.addSystem(ecs::System::Ptr(new SystemTest4(manager)));
+
+    const ecs::Entity entity1 = manager.createEntity();
+    const ecs::Entity entity2 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a(1.0f)));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a(2.0f)));
+    EXPECT_EQ(2U, manager.registerEntity(entity1) + manager.registerEntity(entity2));
+    EXPECT_EQ(2U, manager.updateEntities(1.0f));
+
+    // A tagged Entity is immediately unregistered from the System excluding the Tag
+    EXPECT_FALSE(manager.hasTag<TagTest4>(entity1));
+    EXPECT_TRUE(manager.addTag<TagTest4>(entity1));
+    EXPECT_FALSE(manager.addTag<TagTest4>(entity1));
+    EXPECT_TRUE(manager.hasTag<TagTest4>(entity1));
+    EXPECT_TRUE(manager.hasTag<ComponentTest1a>(entity1));
+    EXPECT_TRUE(manager.getSignature(entity1).test(TagTest4::_mType));
+    EXPECT_EQ(1U, manager.updateEntities(1.0f));
+    EXPECT_FLOAT_EQ(2.0f, manager.getComponentStore<ComponentTest1a>().get(entity1).mValue);
+    EXPECT_FLOAT_EQ(4.0f, manager.getComponentStore<ComponentTest1a>().get(entity2).mValue);
+
+    // Bulk operations
+    std::vector<ecs::Entity> entities;
+    entities.push_back(entity1);
+    entities.push_back(entity2);
+    EXPECT_EQ(1U, manager.addTag<TagTest4>(entities));
+    EXPECT_EQ(0U, manager.updateEntities(1.0f));
+    EXPECT_EQ(2U, manager.removeTag<TagTest4>(entities));
+    EXPECT_EQ(2U, manager.updateEntities(1.0f));
+    EXPECT_FALSE(manager.removeTag<TagTest4>(entity2));
+
+    // Tags have no ComponentStore
+    EXPECT_THROW(manager.getComponentStore<TagTest4>(), std::runtime_error);
+    EXPECT_THROW(manager.addTag<TagTest4>(ecs::_invalidEntity), std::runtime_error);
+    EXPECT_THROW(manager.hasTag<TagTest4>(ecs::_invalidEntity), std::runtime_error);
+
+    // An unregistered Entity is only registered by registerEntity()
+    const ecs::Entity entity3 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity3, ComponentTest1a(3.0f)));
+    EXPECT_TRUE(manager.addTag<TagTest4>(entity3));
+    EXPECT_TRUE(manager.removeTag<TagTest4>(entity3));
+    EXPECT_EQ(2U, manager.updateEntities(1.0f));
+    EXPECT_EQ(1U, manager.registerEntity(entity3));
+    EXPECT_EQ(3U, manager.updateEntities(1.0f));
+    EXPECT_TRUE(manager.addTag<TagTest4>(entity3));
+    manager.destroyEntity(entity3);
+    EXPECT_EQ(2U, manager.updateEntities(1.0f));
+}
+
+// Destroying Entities with their descendants in the Hierarchy
+TEST(Manager, destroySubtree) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    const ecs::Entity entity1 = manager.createEntity();
+    const ecs::Entity entity2 = manager.createEntity();
+    const ecs::Entity entity3 = manager.createEntity();
+    const ecs::Entity entity4 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a(2.0f)));
+    manager.getHierarchy().attach(entity2, entity1);
+    manager.getHierarchy().attach(entity3, entity2);
+    manager.getHierarchy().attach(entity4, entity1);
+
+    // An Entity of the Hierarchy cannot migrate
+    ecs::Manager target(1);
+    EXPECT_THROW(manager.migrateEntity(entity4, target), std::runtime_error);
+
+    // Destroying an Entity makes its children roots
+    manager.destroyEntity(entity1);
+    EXPECT_FALSE(manager.getHierarchy().has(entity1));
+    EXPECT_EQ(ecs::_invalidEntity, manager.getHierarchy().getParent(entity2));
+
+    EXPECT_EQ(2U, manager.destroySubtree(entity2));
+    EXPECT_FALSE(manager.hasEntity(entity2));
+    EXPECT_FALSE(manager.hasEntity(entity3));
+    EXPECT_FALSE(manager.getComponentStore<ComponentTest1a>().has(entity2));
+    EXPECT_TRUE(manager.hasEntity(entity4));
+    EXPECT_EQ(1U, manager.destroySubtree(entity4));
+    EXPECT_THROW(manager.destroySubtree(entity4), std::runtime_error);
+}
+
+// Instantiating a prefab
+TEST(Manager, instantiate) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest2>());
+    manager.addSystem(ecs::System::Ptr(new SystemTest1(manager)));
+    manager.addSystem(ecs::System::Ptr(new SystemTest4(manager)));
+
+    // The prefab is not registered to the Systems
+    const ecs::Entity prefab = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(prefab, ComponentTest1a(1.0f)));
+    EXPECT_TRUE(manager.addComponent(prefab, ComponentTest2(2.0f, 3.0f)));
+    EXPECT_TRUE(manager.addTag<TagTest4>(prefab));
+    std::vector<ecs::Entity> instances;
+    EXPECT_THROW(manager.instantiate(ecs::_invalidEntity, 1, instances), std::runtime_error);
+    EXPECT_EQ(1U, manager.instantiate(prefab, 100, instances)); // SystemTest1 only
+    ASSERT_EQ(100U, instances.size());
+    EXPECT_EQ(101U, manager.getComponentStore<ComponentTest2>().size());
+    EXPECT_TRUE(manager.hasTag<TagTest4>(instances[99]));
+    EXPECT_FLOAT_EQ(3.0f, manager.getComponentStore<ComponentTest2>().get(instances[42]).mValue2);
+    EXPECT_EQ(100U, manager.updateEntities(1.0f));
+    EXPECT_FLOAT_EQ(2.0f, manager.getComponentStore<ComponentTest1a>().get(instances[0]).mValue);
+    EXPECT_FLOAT_EQ(1.0f, manager.getComponentStore<ComponentTest1a>().get(prefab).mValue);
+
+    // Instances are registered: removing the Tag registers them to SystemTest4
+    EXPECT_EQ(100U, manager.removeTag<TagTest4>(instances));
+    EXPECT_EQ(200U, manager.updateEntities(1.0f));
+    EXPECT_EQ(0U, manager.instantiate(prefab, 0, instances));
+    EXPECT_EQ(100U, instances.size());
+
+    // A prefab with a move-only Component cannot be instantiated, and nothing is created
+    EXPECT_TRUE(manager.createComponentStore<ComponentTestMoveOnly>());
+    EXPECT_FALSE(manager.getComponentStore<ComponentTestMoveOnly>().isCopyable());
+    EXPECT_TRUE(manager.getComponentStore<ComponentTest2>().isCopyable());
+    EXPECT_TRUE(manager.addComponent(prefab, ComponentTestMoveOnly(4)));
+    const ecs::Entity next = manager.createEntity();
+    EXPECT_THROW(manager.instantiate(prefab, 10, instances), std::runtime_error);
+    EXPECT_EQ(100U, instances.size());
+    EXPECT_EQ(101U, manager.getComponentStore<ComponentTest2>().size());
+    EXPECT_EQ(1U, manager.getComponentStore<ComponentTestMoveOnly>().size());
+    EXPECT_EQ(next + 1, manager.createEntity());
+}
+
+// Named Queries kept up to date incrementally
+TEST(Manager, queries) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest2>());
+    const ecs::Entity entity1 = manager.createEntity();
+    const ecs::Entity entity2 = manager.createEntity();
+    const ecs::Entity entity3 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest2()));
+    EXPECT_TRUE(manager.addComponent(entity3, ComponentTest1a()));
+    manager.registerEntity(entity1);
+    manager.registerEntity(entity2);
+
+    // A new Query is filled with the registered Entities
+    ecs::ComponentTypeSet requiredComponents;
+    requiredComponents.insert(ComponentTest1a::_mType);
+    ecs::ComponentTypeSet excludedComponents;
+    excludedComponents.insert(TagTest4::_mType);
+    const ecs::Query& query = manager.createQuery("test", ecs::ComponentFilter(std::move(requiredComponents),
+                                                                               std::move(excludedComponents)));
+    EXPECT_EQ("test", query.getName());
+    EXPECT_EQ(&query, &manager.getQuery("test"));
+    EXPECT_THROW(manager.createQuery("test", ecs::ComponentFilter()), std::runtime_error);
+    EXPECT_THROW(manager.getQuery("unknown"), std::runtime_error);
+    EXPECT_EQ(2U, query.size());
+    EXPECT_TRUE(query.hasEntity(entity2));
+    EXPECT_FALSE(query.hasEntity(entity3));
+
+    // Kept up to date by registration, Tags, destruction, and instantiation
+    manager.registerEntity(entity3);
+    EXPECT_EQ(3U, query.size());
+    EXPECT_TRUE(manager.addTag<TagTest4>(entity1));
+    EXPECT_EQ(2U, query.size());
+    EXPECT_FALSE(query.hasEntity(entity1));
+    manager.destroyEntity(entity2);
+    ASSERT_EQ(1U, query.size());
+    EXPECT_EQ(entity3, query.getEntities()[0]);
+    std::vector<ecs::Entity> instances;
+    manager.instantiate(entity3, 10, instances);
+    EXPECT_EQ(11U, query.size());
+    EXPECT_TRUE(manager.removeTag<TagTest4>(entity1));
+    EXPECT_EQ(12U, query.size());
+
+    EXPECT_TRUE(manager.removeQuery("test"));
+    EXPECT_FALSE(manager.removeQuery("test"));
+}
+
+// Putting idle Entities to sleep
+TEST(Manager, sleepEntities) {
+    ecs::Manager manager;
+    EXPECT_TRUE(manager.createComponentStore<ComponentTest1a>());
+    manager.addSystem(ecs::System::Ptr(new SystemTest1(manager)));
+    manager.addSystem(ecs::System::Ptr(new SystemTestSleep(manager)));
+    const ecs::Entity entity1 = manager.createEntity();
+    const ecs::Entity entity2 = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentTest1a()));
+    EXPECT_TRUE(manager.addComponent(entity2, ComponentTest1a()));
+    EXPECT_EQ(2U, manager.registerEntity(entity1));
+    EXPECT_EQ(2U, manager.registerEntity(entity2));
+
+    // Manually
+    EXPECT_EQ(2U, manager.sleepEntity(entity1));
+    EXPECT_EQ(2U, manager.updateEntities(1.0f));
+    EXPECT_EQ(2U, manager.wakeEntity(entity1));
+    EXPECT_EQ(0U, manager.wakeEntity(entity1));
+    EXPECT_THROW(manager.sleepEntity(ecs::_invalidEntity), std::runtime_error);
+
+    // By the sleep policy of the second System, only changed Entities staying active
+    ecs::ComponentStore<ComponentTest1a>& store = manager.getComponentStore<ComponentTest1a>();
+    EXPECT_EQ(4U, manager.updateFrame(0.0f));
+    EXPECT_TRUE(store.isTrackingChanges());
+    EXPECT_EQ(4U, manager.updateFrame(0.0f));
+    store.modify(entity2).mValue = 1.0f;
+    EXPECT_EQ(4U, manager.updateFrame(0.0f)); // entity1 goes to sleep
+    EXPECT_EQ(3U, manager.updateFrame(0.0f));
+    EXPECT_EQ(3U, manager.updateFrame(0.0f)); // entity2 goes to sleep
+    EXPECT_EQ(2U, manager.updateFrame(0.0f));
+    EXPECT_TRUE(store.getChangedEntities().empty());
+    store.modify(entity1).mValue = 1.0f;
+    EXPECT_EQ(2U, manager.updateFrame(0.0f)); // entity1 wakes up at the end of the frame
+    EXPECT_EQ(3U, manager.updateFrame(0.0f));
+}
@@ -0,0 +1,120 @@
+/**
+ * @file    MappedComponentStore_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the memory-mapped store of trivially copyable Components.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/MappedComponentStore.h>
+#include <ecs/Manager.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+
+// A trivially copyable Component
+struct ComponentMapped : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    float   mX;
+    int     mY;
+};
+const ecs::ComponentType ComponentMapped::_mType = 7;
+
+static ComponentMapped makeComponentMapped(float aX, int aY) {
+    ComponentMapped component;
+    component.mX = aX;
+    component.mY = aY;
+    return component;
+}
+
+// Add, remove and grow a store, then reopen its file
+TEST(MappedComponentStore, reopen) {
+    const char* path = "MappedComponentStore_test.bin";
+    std::remove(path);
+    {
+        ecs::MappedComponentStore<ComponentMapped> store(path, 4);
+        EXPECT_EQ(0U, store.size());
+        EXPECT_EQ(4U, store.getCapacity());
+        for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+            EXPECT_TRUE(store.add(entity, makeComponentMapped(static_cast<float>(entity), static_cast<int>(entity))));
+        }
+        EXPECT_FALSE(store.add(5, makeComponentMapped(0.0f, 0)));
+        EXPECT_EQ(10U, store.size());
+        EXPECT_LE(10U, store.getCapacity());
+        EXPECT_TRUE(store.remove(3));
+        EXPECT_FALSE(store.remove(3));
+        EXPECT_FALSE(store.isSortedByEntity());
+        store.get(4).mY = 40;
+        store.flush();
+    }
+    {
+        ecs::MappedComponentStore<ComponentMapped> store(path);
+        EXPECT_EQ(9U, store.size());
+        EXPECT_FALSE(store.has(3));
+        EXPECT_EQ(40, store.get(4).mY);
+        EXPECT_FLOAT_EQ(10.0f, store.get(10).mX);
+        store.sortByEntity();
+        EXPECT_TRUE(store.isSortedByEntity());
+        EXPECT_EQ(1U, store.getEntities()[0]);
+        EXPECT_EQ(10U, store.getEntities()[8]);
+        EXPECT_EQ(10, store.getAt(8).mY);
+        EXPECT_EQ(7, store.get(7).mY);
+    }
+    std::remove(path);
+}
+
+// Reopen a world: the Entities of the Components found in the file are created
+TEST(MappedComponentStore, manager) {
+    const char* path = "MappedComponentStore_manager.bin";
+    std::remove(path);
+    ecs::Entity entity;
+    {
+        ecs::Manager manager;
+        EXPECT_EQ(0U, manager.createMappedComponentStore<ComponentMapped>(path));
+        EXPECT_THROW(manager.createMappedComponentStore<ComponentMapped>(path), std::runtime_error);
+        manager.createEntity();
+        entity = manager.createEntity();
+        EXPECT_TRUE(manager.addMappedComponent(entity, makeComponentMapped(1.0f, 2)));
+        EXPECT_TRUE(manager.getSignature(entity).test(ComponentMapped::_mType));
+        manager.getMappedComponentStore<ComponentMapped>().flush();
+        // The typed API does not apply to a MappedComponentStore
+        EXPECT_THROW(manager.getComponentStore<ComponentMapped>(), std::runtime_error);
+        EXPECT_THROW(manager.addComponent(entity, makeComponentMapped(3.0f, 4)), std::runtime_error);
+        EXPECT_THROW(manager.enableSnapshot<ComponentMapped>(), std::runtime_error);
+    }
+    {
+        ecs::Manager manager;
+        EXPECT_EQ(1U, manager.createMappedComponentStore<ComponentMapped>(path));
+        EXPECT_TRUE(manager.hasEntity(entity));
+        EXPECT_TRUE(manager.getSignature(entity).test(ComponentMapped::_mType));
+        EXPECT_EQ(2, manager.getMappedComponentStore<ComponentMapped>().get(entity).mY);
+        EXPECT_LT(entity, manager.createEntity());
+    }
+    std::remove(path);
+}
+
+// Reopen a world whose last Entity has the last Id of the shard: no new Entity can be created
+TEST(MappedComponentStore, lastEntityId) {
+    const char* path = "MappedComponentStore_last.bin";
+    std::remove(path);
+    {
+        ecs::MappedComponentStore<ComponentMapped> store(path);
+        EXPECT_TRUE(store.add(ecs::_maxEntityIndex, makeComponentMapped(1.0f, 2)));
+        store.flush();
+    }
+    {
+        ecs::Manager manager;
+        EXPECT_EQ(1U, manager.createMappedComponentStore<ComponentMapped>(path));
+        EXPECT_TRUE(manager.hasEntity(ecs::_maxEntityIndex));
+        EXPECT_THROW(manager.reserveEntity(), std::runtime_error);
+        EXPECT_THROW(manager.createEntity(), std::runtime_error);
+    }
+    // The Id of a shard shall fit in its bits
+    EXPECT_THROW(ecs::Manager(1U << ecs::_entityShardBits), std::runtime_error);
+    std::remove(path);
+}
@@ -0,0 +1,153 @@
+/**
+ * @file    Rollback_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the ring buffer of saved states of a Manager.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Rollback.h>
+#include <ecs/Manager.h>
+
+#include "../src/Utils.h" // defines the "override" identifier if needed (gcc < 4.7)
+
+#include <gtest/gtest.h>
+
+// A Component modified at each tick
+struct ComponentRollbackMoving : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentRollbackMoving(float aPosition = 0.0f) : mPosition(aPosition) {
+    }
+
+    float mPosition;
+};
+const ecs::ComponentType ComponentRollbackMoving::_mType = 11;
+
+// A Component never modified
+struct ComponentRollbackStatic : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentRollbackStatic(int aValue = 0) : mValue(aValue) {
+    }
+
+    int mValue;
+};
+const ecs::ComponentType ComponentRollbackStatic::_mType = 12;
+
+// A System moving Entities
+class SystemRollbackMove : public ecs::System {
+public:
+    explicit SystemRollbackMove(ecs::Manager& aManager) :
+        ecs::System(aManager) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentRollbackMoving::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        mManager.getComponentStore<ComponentRollbackMoving>().get(aEntity).mPosition += aElapsedTime;
+    }
+};
+
+// Save each tick, then restore an older one, with its Entities, Components and registrations
+TEST(Rollback, saveRestore) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentRollbackMoving>();
+    manager.createComponentStore<ComponentRollbackStatic>();
+    const ecs::System::Ptr systemPtr(new SystemRollbackMove(manager));
+    manager.addSystem(systemPtr);
+    const ecs::System& system = *systemPtr;
+    for (int i = 0; i < 10; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentRollbackMoving());
+        manager.addComponent(entity, ComponentRollbackStatic(i));
+        manager.registerEntity(entity);
+    }
+
+    ecs::Rollback rollback(manager, 4);
+    EXPECT_EQ(4U, rollback.getNbSlots());
+    EXPECT_FALSE(rollback.has(0));
+    EXPECT_FALSE(rollback.restore(0));
+
+    // The static store is only copied by the first save
+    rollback.save(0);
+    EXPECT_EQ(2U, rollback.getNbCopiedStores());
+    manager.updateEntities(1.0f);
+    rollback.save(1);
+    EXPECT_EQ(1U, rollback.getNbCopiedStores());
+    EXPECT_THROW(rollback.save(1), std::runtime_error);
+
+    // Destroy an Entity, and create a new one
+    manager.destroyEntity(3);
+    const ecs::Entity created = manager.createEntity();
+    manager.addComponent(created, ComponentRollbackMoving(100.0f));
+    manager.registerEntity(created);
+    manager.updateEntities(1.0f);
+    rollback.save(2);
+    EXPECT_EQ(2U, rollback.getNbCopiedStores());
+    EXPECT_EQ(10U, system.getNbEntities());
+    EXPECT_FALSE(manager.hasEntity(3));
+
+    // Restore the tick 1, forgetting the tick 2
+    EXPECT_TRUE(rollback.restore(1));
+    EXPECT_EQ(2U, rollback.getNbCopiedStores());
+    EXPECT_FALSE(rollback.has(2));
+    EXPECT_TRUE(rollback.has(0));
+    EXPECT_TRUE(manager.hasEntity(3));
+    EXPECT_FALSE(manager.hasEntity(created));
+    EXPECT_EQ(10U, system.getNbEntities());
+    EXPECT_TRUE(system.hasEntity(3));
+    EXPECT_FALSE(system.hasEntity(created));
+    EXPECT_EQ(2, manager.getComponentStore<ComponentRollbackStatic>().get(3).mValue);
+    for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+        EXPECT_EQ(1.0f, manager.getComponentStore<ComponentRollbackMoving>().get(entity).mPosition);
+    }
+
+    // Simulating the tick again creates the same Entity (reusing the index of the destroyed one), with the same result
+    manager.destroyEntity(3);
+    EXPECT_EQ(created, manager.createEntity());
+    manager.destroyEntity(created);
+    manager.updateEntities(1.0f);
+    EXPECT_EQ(2.0f, manager.getComponentStore<ComponentRollbackMoving>().get(5).mPosition);
+
+    // Restoring a tick again, without change since, does not copy anything
+    EXPECT_TRUE(rollback.restore(0));
+    EXPECT_TRUE(rollback.restore(0));
+    EXPECT_EQ(0U, rollback.getNbCopiedStores());
+    EXPECT_EQ(0.0f, manager.getComponentStore<ComponentRollbackMoving>().getAt(0).mPosition);
+}
+
+// Overwrite the oldest slots of the ring buffer, keeping the content of unchanged stores referenced by others
+TEST(Rollback, ringBuffer) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentRollbackMoving>();
+    manager.createComponentStore<ComponentRollbackStatic>();
+    manager.addSystem(ecs::System::Ptr(new SystemRollbackMove(manager)));
+    for (int i = 0; i < 3; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentRollbackMoving());
+        manager.addComponent(entity, ComponentRollbackStatic(i));
+        manager.registerEntity(entity);
+    }
+
+    ecs::Rollback rollback(manager, 3);
+    for (uint64_t tick = 0; tick < 10; ++tick) {
+        rollback.save(tick);
+        manager.updateEntities(1.0f);
+    }
+    EXPECT_FALSE(rollback.has(6));
+    EXPECT_TRUE(rollback.has(7));
+    EXPECT_TRUE(rollback.has(9));
+
+    // The static store saved by the tick 0 has been handed over from slot to slot
+    EXPECT_TRUE(rollback.restore(7));
+    EXPECT_EQ(7.0f, manager.getComponentStore<ComponentRollbackMoving>().get(2).mPosition);
+    manager.getComponentStore<ComponentRollbackStatic>().get(2).mValue = -1;
+    EXPECT_TRUE(rollback.restore(7));
+    EXPECT_EQ(1, manager.getComponentStore<ComponentRollbackStatic>().get(2).mValue);
+}
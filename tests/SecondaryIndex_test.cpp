@@ -0,0 +1,152 @@
+/**
+ * @file    SecondaryIndex_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the secondary indexes of a ComponentStore.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/SecondaryIndex.h>
+#include <ecs/ComponentStore.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+// A Component with a unique network id, and a team shared by many Entities
+struct ComponentNetworked : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    ComponentNetworked(unsigned int aNetworkId, int aTeam) : mNetworkId(aNetworkId), mTeam(aTeam) {
+    }
+
+    unsigned int    mNetworkId;
+    int             mTeam;
+};
+const ecs::ComponentType ComponentNetworked::_mType = 15;
+
+// Finding Entities by network id, kept up to date on add, remove, change and non-const access
+TEST(SecondaryIndex, hash) {
+    ecs::ComponentStore<ComponentNetworked> store;
+    EXPECT_TRUE(store.add(1, ComponentNetworked(100, 1)));
+    EXPECT_TRUE(store.add(2, ComponentNetworked(200, 2)));
+
+    // Built from the existing Components
+    ecs::HashIndex<ComponentNetworked, unsigned int>& byNetworkId =
+        store.addHashIndex<unsigned int>([](const ComponentNetworked& aComponent) {
+            return aComponent.mNetworkId;
+        });
+    EXPECT_EQ(1U, byNetworkId.findFirst(100));
+    EXPECT_EQ(2U, byNetworkId.findFirst(200));
+    EXPECT_EQ(ecs::_invalidEntity, byNetworkId.findFirst(300));
+
+    // Added, changed and removed Components
+    EXPECT_TRUE(store.add(3, ComponentNetworked(300, 1)));
+    EXPECT_EQ(3U, byNetworkId.findFirst(300));
+    store.modify(1).mNetworkId = 101;
+    EXPECT_EQ(ecs::_invalidEntity, byNetworkId.findFirst(100));
+    EXPECT_EQ(1U, byNetworkId.findFirst(101));
+    store.get(2).mNetworkId = 201;
+    EXPECT_EQ(2U, byNetworkId.findFirst(201));
+    store.find(2)->mNetworkId = 202;
+    EXPECT_EQ(2U, byNetworkId.findFirst(202));
+    store.getAt(0).mNetworkId = 102;
+    EXPECT_EQ(1U, byNetworkId.findFirst(102));
+    EXPECT_EQ(0U, byNetworkId.count(101));
+    store.get(2).mNetworkId = 201;
+    store.markChanged(2);
+    EXPECT_EQ(2U, byNetworkId.findFirst(201));
+    EXPECT_TRUE(store.remove(3));
+    EXPECT_EQ(0U, byNetworkId.count(300));
+    EXPECT_EQ(2, store.extract(2).mTeam);
+    EXPECT_EQ(0U, byNetworkId.count(201));
+
+    // Many Entities per key: all the Entities of a team
+    ecs::HashIndex<ComponentNetworked, int>& byTeam = store.addHashIndex<int>([](const ComponentNetworked& aComponent) {
+        return aComponent.mTeam;
+    });
+    for (ecs::Entity entity = 10; entity < 20; ++entity) {
+        EXPECT_TRUE(store.add(entity, ComponentNetworked(entity, static_cast<int>(entity % 2))));
+    }
+    EXPECT_EQ(6U, byTeam.count(1));
+    EXPECT_EQ(5U, byTeam.count(0));
+    store.modify(12).mTeam = 1;
+    EXPECT_TRUE(store.remove(11));
+    EXPECT_EQ(6U, byTeam.count(1));
+    EXPECT_EQ(4U, byTeam.count(0));
+    const std::vector<ecs::Entity>& team0 = byTeam.find(0);
+    for (auto entity  = team0.begin();
+              entity != team0.end();
+            ++entity) {
+        EXPECT_EQ(0, store.get(*entity).mTeam);
+    }
+    EXPECT_EQ(15U, byNetworkId.findFirst(15));
+    EXPECT_EQ(ecs::_invalidEntity, byNetworkId.findFirst(11));
+}
+
+// Finding Entities by ranges of network ids, rebuilt when the content of the store is restored
+TEST(SecondaryIndex, sorted) {
+    ecs::ComponentStore<ComponentNetworked> store;
+    ecs::SortedIndex<ComponentNetworked, unsigned int>& byNetworkId =
+        store.addSortedIndex<unsigned int>([](const ComponentNetworked& aComponent) {
+            return aComponent.mNetworkId;
+        });
+    for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+        EXPECT_TRUE(store.add(entity, ComponentNetworked(1000 - entity * 10, 0)));
+    }
+
+    std::vector<ecs::Entity> entities;
+    EXPECT_EQ(4U, byNetworkId.findRange(950, 980, entities));
+    ASSERT_EQ(4U, entities.size());
+    EXPECT_EQ(5U, entities[0]); // in increasing order of keys
+    EXPECT_EQ(4U, entities[1]);
+    EXPECT_EQ(3U, entities[2]);
+    EXPECT_EQ(2U, entities[3]);
+
+    ecs::IComponentStore::State::Ptr state = store.createState();
+    store.saveState(*state);
+
+    store.modify(4).mNetworkId = 10;
+    EXPECT_TRUE(store.remove(5));
+    entities.clear();
+    EXPECT_EQ(2U, byNetworkId.findRange(950, 980, entities));
+    EXPECT_EQ(3U, entities[0]);
+    EXPECT_EQ(2U, entities[1]);
+    entities.clear();
+    EXPECT_EQ(1U, byNetworkId.find(10, entities));
+    EXPECT_EQ(4U, entities[0]);
+
+    store.restoreState(*state);
+    entities.clear();
+    EXPECT_EQ(4U, byNetworkId.findRange(950, 980, entities));
+    entities.clear();
+    EXPECT_EQ(0U, byNetworkId.find(10, entities));
+}
+
+// Many changes between two lookups rebuild the index, instead of recording each of them
+TEST(SecondaryIndex, manyChanges) {
+    ecs::ComponentStore<ComponentNetworked> store;
+    EXPECT_TRUE(store.add(1, ComponentNetworked(100, 1)));
+    EXPECT_TRUE(store.add(2, ComponentNetworked(200, 2)));
+    ecs::HashIndex<ComponentNetworked, unsigned int>& byNetworkId =
+        store.addHashIndex<unsigned int>([](const ComponentNetworked& aComponent) {
+            return aComponent.mNetworkId;
+        });
+    EXPECT_EQ(1U, byNetworkId.findFirst(100));
+
+    for (unsigned int networkId = 101; networkId <= 1000; ++networkId) {
+        store.modify(1).mNetworkId = networkId;
+        EXPECT_TRUE(store.add(3, ComponentNetworked(networkId + 1000, 3)));
+        EXPECT_TRUE(store.remove(3));
+    }
+    store.modify(2).mNetworkId = 201;
+    EXPECT_EQ(ecs::_invalidEntity, byNetworkId.findFirst(100));
+    EXPECT_EQ(1U, byNetworkId.findFirst(1000));
+    EXPECT_EQ(2U, byNetworkId.findFirst(201));
+    EXPECT_EQ(0U, byNetworkId.count(200));
+    EXPECT_EQ(0U, byNetworkId.count(2000));
+    EXPECT_EQ(1U, byNetworkId.count(1000));
+}
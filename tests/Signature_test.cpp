@@ -0,0 +1,69 @@
+/**
+ * @file    Signature_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of a Signature.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Signature.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+// Setting, testing and iterating the bits of a Signature
+TEST(Signature, bits) {
+    ecs::Signature signature;
+    EXPECT_TRUE(signature.empty());
+    EXPECT_FALSE(signature.test(1));
+    signature.set(1);
+    signature.set(63);
+    signature.set(64);
+    signature.set(ecs::_maxComponentTypes - 1);
+    EXPECT_FALSE(signature.empty());
+    EXPECT_TRUE(signature.test(63));
+    EXPECT_TRUE(signature.test(64));
+    EXPECT_FALSE(signature.test(65));
+    EXPECT_FALSE(signature.test(ecs::_maxComponentTypes));
+    EXPECT_THROW(signature.set(ecs::_maxComponentTypes), std::out_of_range);
+
+    std::vector<ecs::ComponentType> componentTypes;
+    signature.forEach([&](ecs::ComponentType aComponentType) {
+        componentTypes.push_back(aComponentType);
+    });
+    ASSERT_EQ(4U, componentTypes.size());
+    EXPECT_EQ(1U, componentTypes[0]);
+    EXPECT_EQ(63U, componentTypes[1]);
+    EXPECT_EQ(64U, componentTypes[2]);
+    EXPECT_EQ(ecs::_maxComponentTypes - 1, componentTypes[3]);
+
+    signature.reset(63);
+    EXPECT_FALSE(signature.test(63));
+    EXPECT_TRUE(signature.test(64));
+}
+
+// Comparing Signatures
+TEST(Signature, compare) {
+    ecs::ComponentTypeSet componentTypes;
+    componentTypes.insert(1);
+    componentTypes.insert(70);
+    const ecs::Signature signature170(componentTypes);
+    ecs::Signature signature70;
+    signature70.set(70);
+    ecs::Signature signature2;
+    signature2.set(2);
+
+    EXPECT_TRUE(signature170.includes(signature70));
+    EXPECT_TRUE(signature170.includes(ecs::Signature()));
+    EXPECT_FALSE(signature70.includes(signature170));
+    EXPECT_TRUE(signature70.intersects(signature170));
+    EXPECT_FALSE(signature2.intersects(signature170));
+    EXPECT_FALSE(signature170 == signature70);
+    signature70.set(1);
+    EXPECT_TRUE(signature170 == signature70);
+    EXPECT_TRUE(signature170 != signature2);
+}
@@ -0,0 +1,110 @@
+/**
+ * @file    Snapshot_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the immutable views of ComponentStores published by the Manager.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/Manager.h>
+#include <ecs/Snapshot.h>
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+// A trivially copyable Component
+struct ComponentSnapshotTest : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentSnapshotTest(int aValue = 0) : mValue(aValue) {
+    }
+
+    int mValue;
+};
+const ecs::ComponentType ComponentSnapshotTest::_mType = 10;
+
+// Publish Snapshots, sharing unchanged chunks, while older Snapshots stay unchanged
+TEST(Snapshot, publish) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentSnapshotTest>();
+    manager.enableSnapshot<ComponentSnapshotTest>();
+    EXPECT_EQ(nullptr, manager.getSnapshot());
+
+    const size_t nbEntities = 3 * ecs::ComponentSnapshot<ComponentSnapshotTest>::_mChunkSize;
+    for (size_t i = 0; i < nbEntities; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        manager.addComponent(entity, ComponentSnapshotTest(static_cast<int>(entity)));
+    }
+    manager.updateEntities(0.1f);
+    const ecs::Snapshot::Ptr first = manager.getSnapshot();
+    ASSERT_NE(nullptr, first);
+    EXPECT_EQ(1U, first->getNumber());
+    EXPECT_TRUE(first->has<ComponentSnapshotTest>());
+    const ecs::ComponentSnapshot<ComponentSnapshotTest>& view1 = first->get<ComponentSnapshotTest>();
+    EXPECT_EQ(nbEntities, view1.size());
+    EXPECT_EQ(3U, view1.getNbChunks());
+    EXPECT_EQ(0U, view1.getNbSharedChunks());
+    ASSERT_NE(nullptr, view1.find(42));
+    EXPECT_EQ(42, view1.find(42)->mValue);
+
+    // An unchanged store shares its whole view
+    manager.updateEntities(0.1f);
+    const ecs::Snapshot::Ptr unchanged = manager.getSnapshot();
+    EXPECT_EQ(2U, unchanged->getNumber());
+    EXPECT_EQ(&view1, &unchanged->get<ComponentSnapshotTest>());
+
+    // Only the chunk of the modified Component is copied
+    manager.getComponentStore<ComponentSnapshotTest>().get(42).mValue = -1;
+    manager.updateEntities(0.1f);
+    const ecs::Snapshot::Ptr second = manager.getSnapshot();
+    EXPECT_EQ(3U, second->getNumber());
+    const ecs::ComponentSnapshot<ComponentSnapshotTest>& view2 = second->get<ComponentSnapshotTest>();
+    EXPECT_EQ(2U, view2.getNbSharedChunks());
+    EXPECT_EQ(-1, view2.find(42)->mValue);
+    EXPECT_EQ(42, view1.find(42)->mValue);
+    EXPECT_EQ(&view1.getChunk(2), &view2.getChunk(2));
+
+    // Removing a Component moves the last one, changing two chunks
+    manager.destroyEntity(1);
+    manager.updateEntities(0.1f);
+    const ecs::ComponentSnapshot<ComponentSnapshotTest>& view3 = manager.getSnapshot()->get<ComponentSnapshotTest>();
+    EXPECT_EQ(nbEntities - 1, view3.size());
+    EXPECT_EQ(1U, view3.getNbSharedChunks());
+    EXPECT_EQ(nullptr, view3.find(1));
+    size_t nbComponents = 0;
+    view3.forEach([&](ecs::Entity aEntity, const ComponentSnapshotTest& aComponent) {
+        EXPECT_EQ((42 == aEntity) ? -1 : static_cast<int>(aEntity), aComponent.mValue);
+        ++nbComponents;
+    });
+    EXPECT_EQ(nbEntities - 1, nbComponents);
+}
+
+// A reader thread consumes Snapshots while the simulation publishes new ones
+TEST(Snapshot, concurrentReader) {
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentSnapshotTest>();
+    manager.enableSnapshot<ComponentSnapshotTest>();
+    const ecs::Entity entity = manager.createEntity();
+    manager.addComponent(entity, ComponentSnapshotTest(0));
+    manager.updateEntities(0.1f);
+
+    std::thread reader([&manager, entity]() {
+        int previous = 0;
+        for (int i = 0; i < 1000; ++i) {
+            const ecs::Snapshot::Ptr snapshot = manager.getSnapshot();
+            const int value = snapshot->get<ComponentSnapshotTest>().find(entity)->mValue;
+            EXPECT_LE(previous, value);
+            previous = value;
+        }
+    });
+    for (int i = 1; i <= 1000; ++i) {
+        manager.getComponentStore<ComponentSnapshotTest>().get(entity).mValue = i;
+        manager.updateEntities(0.1f);
+    }
+    reader.join();
+    EXPECT_EQ(1000, manager.getSnapshot()->get<ComponentSnapshotTest>().find(entity)->mValue);
+}
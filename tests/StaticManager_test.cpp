@@ -0,0 +1,103 @@
+/**
+ * @file    StaticManager_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the compile-time Entity-Component-System manager.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/StaticManager.h>
+
+#include <gtest/gtest.h>
+
+// A position Component
+struct ComponentStaticPosition : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentStaticPosition(float aX = 0.0f) : mX(aX) {
+    }
+
+    float mX;
+};
+const ecs::ComponentType ComponentStaticPosition::_mType = 1;
+// A speed Component
+struct ComponentStaticSpeed : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentStaticSpeed(float aSpeed = 0.0f) : mSpeed(aSpeed) {
+    }
+
+    float mSpeed;
+};
+const ecs::ComponentType ComponentStaticSpeed::_mType = 2;
+// A third Component
+struct ComponentStaticHealth : public ecs::Component {
+    static const ecs::ComponentType _mType;
+};
+const ecs::ComponentType ComponentStaticHealth::_mType = 3;
+
+typedef ecs::StaticManager<ComponentStaticPosition, ComponentStaticSpeed, ComponentStaticHealth> StaticManagerTest;
+
+// Masks are computed at compile time
+static_assert(StaticManagerTest::Mask<ComponentStaticSpeed>::_mValue == 2, "Mask of the second type");
+static_assert(StaticManagerTest::Mask<ComponentStaticPosition, ComponentStaticHealth>::_mValue == 5, "Mask of types");
+
+// A typed System moving Entities, without virtual method
+class SystemStaticMove {
+public:
+    typedef ecs::ComponentList<ComponentStaticSpeed, ComponentStaticPosition> Components;
+
+    void updateEntity(float aElapsedTime, ecs::Entity,
+                      ComponentStaticSpeed& aSpeed, ComponentStaticPosition& aPosition) {
+        aPosition.mX += aSpeed.mSpeed * aElapsedTime;
+    }
+};
+
+// Creating Entities, adding and removing Components
+TEST(StaticManager, entities) {
+    StaticManagerTest manager;
+    const ecs::Entity entity1 = manager.createEntity();
+    const ecs::Entity entity2 = manager.createEntity();
+    EXPECT_TRUE(manager.hasEntity(entity1));
+    EXPECT_FALSE(manager.hasEntity(ecs::_invalidEntity));
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentStaticPosition(1.0f)));
+    EXPECT_TRUE(manager.addComponent(entity1, ComponentStaticHealth()));
+    EXPECT_FALSE(manager.addComponent(entity1, ComponentStaticHealth()));
+    EXPECT_EQ(5U, manager.getMask(entity1));
+    EXPECT_TRUE((manager.hasComponents<ComponentStaticPosition, ComponentStaticHealth>(entity1)));
+    EXPECT_FALSE((manager.hasComponents<ComponentStaticPosition, ComponentStaticSpeed>(entity1)));
+    EXPECT_THROW(manager.addComponent(ecs::_invalidEntity, ComponentStaticHealth()), std::runtime_error);
+
+    EXPECT_TRUE(manager.removeComponent<ComponentStaticHealth>(entity1));
+    EXPECT_FALSE(manager.removeComponent<ComponentStaticHealth>(entity1));
+    EXPECT_EQ(1U, manager.getMask(entity1));
+    EXPECT_EQ(0U, manager.getMask(entity2));
+
+    manager.destroyEntity(entity1);
+    EXPECT_FALSE(manager.hasEntity(entity1));
+    EXPECT_FALSE(manager.getComponentStore<ComponentStaticPosition>().has(entity1));
+    EXPECT_THROW(manager.destroyEntity(entity1), std::runtime_error);
+}
+
+// Updating a typed System
+TEST(StaticManager, updateSystem) {
+    StaticManagerTest manager;
+    for (int i = 0; i < 10; ++i) {
+        const ecs::Entity entity = manager.createEntity();
+        EXPECT_TRUE(manager.addComponent(entity, ComponentStaticPosition(static_cast<float>(i))));
+        if (0 == (i % 2)) {
+            EXPECT_TRUE(manager.addComponent(entity, ComponentStaticSpeed(2.0f)));
+        }
+    }
+    const ecs::Entity alone = manager.createEntity();
+    EXPECT_TRUE(manager.addComponent(alone, ComponentStaticSpeed(2.0f)));
+
+    SystemStaticMove system;
+    EXPECT_EQ(5U, manager.updateSystem(system, 0.5f));
+    EXPECT_FLOAT_EQ(1.0f, manager.getComponentStore<ComponentStaticPosition>().get(1).mX);
+    EXPECT_FLOAT_EQ(1.0f, manager.getComponentStore<ComponentStaticPosition>().get(2).mX);
+    EXPECT_FLOAT_EQ(3.0f, manager.getComponentStore<ComponentStaticPosition>().get(3).mX);
+}
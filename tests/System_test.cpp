@@ -17,6 +17,8 @@
 
 #include <gtest/gtest.h>
 
+#include <map>
+
 
 // A test System
 class SystemTest1 : public ecs::System {
@@ -30,6 +32,22 @@ public:
     }
 };
 
+// A test System summing the elapsed time
+class SystemTestElapsed : public ecs::System {
+public:
+    explicit SystemTestElapsed(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mElapsedTime(0.0f) {
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity) override {
+        mElapsedTime += aElapsedTime;
+    }
+
+    float mElapsedTime; // Sum of the elapsed time given to updateEntity()
+};
+
 // Adding/removing/testing for presence
 TEST(System, hasHadRemove) {
     ecs::Manager manager;
@@ -78,3 +96,239 @@ TEST(System, hasHadRemove) {
     EXPECT_FALSE(system.hasEntity(entity1));
     EXPECT_FALSE(system.hasEntity(entity2));
 }
+
+// Limiting the tick rate of a System
+TEST(System, tickRate) {
+    ecs::Manager manager;
+    SystemTestElapsed system(manager);
+    EXPECT_TRUE(system.registerEntity(1));
+    EXPECT_EQ(ecs::System::eUpdate, system.getPhase());
+
+    // By default, a System is run at each tick
+    EXPECT_EQ(1U, system.tick(0.1f));
+    EXPECT_EQ(1U, system.tick(0.1f));
+    EXPECT_FLOAT_EQ(0.2f, system.mElapsedTime);
+
+    // Run at 10Hz with a 60Hz tick: only every 6 ticks, with the time elapsed since last run
+    system.mElapsedTime = 0.0f;
+    system.setTickRate(10.0f);
+    EXPECT_FLOAT_EQ(0.1f, system.getTickPeriod());
+    size_t nbUpdatedEntities = 0;
+    for (size_t i = 0; i < 60; ++i) {
+        nbUpdatedEntities += system.tick(1.0f / 64);
+    }
+    EXPECT_EQ(9U, nbUpdatedEntities);
+    EXPECT_NEAR(9 * 0.1f, system.mElapsedTime, 0.02f);
+
+    // With a stagger of half the period, the first run occurs after half the period
+    system.setTickRate(8.0f, 0.5f);
+    EXPECT_EQ(0U, system.tick(0.03125f));
+    EXPECT_EQ(1U, system.tick(0.03125f));
+    EXPECT_EQ(0U, system.tick(0.03125f));
+    EXPECT_EQ(0U, system.tick(0.03125f));
+    EXPECT_EQ(0U, system.tick(0.03125f));
+    EXPECT_EQ(1U, system.tick(0.03125f));
+}
+
+// Putting Entities to sleep and waking them up
+TEST(System, sleepWake) {
+    ecs::Manager manager;
+    SystemTestElapsed system(manager);
+    for (ecs::Entity entity = 1; entity <= 4; ++entity) {
+        EXPECT_TRUE(system.registerEntity(entity));
+    }
+    EXPECT_EQ(4U, system.getNbActiveEntities());
+
+    EXPECT_TRUE(system.sleepEntity(2));
+    EXPECT_FALSE(system.sleepEntity(2));
+    EXPECT_FALSE(system.sleepEntity(5));
+    EXPECT_TRUE(system.sleepEntity(4));
+    EXPECT_FALSE(system.isEntityActive(2));
+    EXPECT_TRUE(system.isEntityActive(3));
+    EXPECT_TRUE(system.hasEntity(2));
+    EXPECT_EQ(2U, system.getNbActiveEntities());
+    EXPECT_EQ(4U, system.getNbEntities());
+    EXPECT_EQ(2U, system.updateEntities(1.0f));
+
+    // Unregistering keeps active and sleeping Entities apart
+    EXPECT_EQ(1U, system.unregisterEntity(1));
+    EXPECT_EQ(1U, system.unregisterEntity(4));
+    EXPECT_EQ(1U, system.getNbActiveEntities());
+    EXPECT_EQ(3U, system.getEntities()[0]);
+    EXPECT_EQ(2U, system.getEntities()[1]);
+    EXPECT_TRUE(system.registerEntity(5));
+    EXPECT_EQ(2U, system.getNbActiveEntities());
+
+    EXPECT_TRUE(system.wakeEntity(2));
+    EXPECT_FALSE(system.wakeEntity(2));
+    EXPECT_EQ(3U, system.updateEntities(1.0f));
+    EXPECT_FLOAT_EQ(5.0f, system.mElapsedTime);
+
+    // Sleep policy: after 2 frames without any change
+    system.setSleepPolicy(1, 2);
+    EXPECT_EQ(1U, system.getSleepComponentType());
+    std::vector<ecs::Entity> changedEntities;
+    EXPECT_EQ(0U, system.applySleepPolicy(changedEntities));
+    changedEntities.push_back(3);
+    EXPECT_EQ(0U, system.applySleepPolicy(changedEntities));
+    EXPECT_EQ(2U, system.applySleepPolicy(changedEntities)); // all but 3
+    EXPECT_EQ(1U, system.getNbActiveEntities());
+    EXPECT_TRUE(system.isEntityActive(3));
+    changedEntities.push_back(5);
+    EXPECT_EQ(0U, system.applySleepPolicy(changedEntities));
+    EXPECT_TRUE(system.isEntityActive(5));
+    system.setSleepPolicy(1, 0);
+    EXPECT_EQ(ecs::_invalidComponentType, system.getSleepComponentType());
+}
+
+// A test System counting the updates of each Entity, where the update of the last Entity puts others to sleep
+class SystemTestSleepOthers : public ecs::System {
+public:
+    explicit SystemTestSleepOthers(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mNbUpdates() {
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float, ecs::Entity aEntity) override {
+        ++mNbUpdates[aEntity];
+        if (6 == aEntity) {
+            for (ecs::Entity entity = 3; entity <= 5; ++entity) {
+                sleepEntity(entity);
+            }
+        }
+    }
+
+    std::map<ecs::Entity, size_t>   mNbUpdates;     // Number of updates of each Entity
+};
+
+// Putting several other Entities to sleep from updateEntity()
+TEST(System, sleepFromUpdate) {
+    ecs::Manager manager;
+    SystemTestSleepOthers system(manager);
+    for (ecs::Entity entity = 1; entity <= 6; ++entity) {
+        EXPECT_TRUE(system.registerEntity(entity));
+    }
+
+    // Entity 6 is updated first, and puts the next 3 ones to sleep before their update
+    system.updateEntities(1.0f);
+    EXPECT_EQ(3U, system.getNbActiveEntities());
+    for (ecs::Entity entity = 3; entity <= 5; ++entity) {
+        EXPECT_FALSE(system.isEntityActive(entity));
+        EXPECT_EQ(0U, system.mNbUpdates[entity]);
+    }
+    EXPECT_EQ(1U, system.mNbUpdates[1]);
+    EXPECT_EQ(1U, system.mNbUpdates[2]);
+    EXPECT_EQ(1U, system.mNbUpdates[6]);
+
+    // Only active Entities are updated by the next frames
+    system.mNbUpdates.clear();
+    EXPECT_EQ(3U, system.updateEntities(1.0f));
+    EXPECT_EQ(1U, system.mNbUpdates[1]);
+    EXPECT_EQ(1U, system.mNbUpdates[2]);
+    EXPECT_EQ(1U, system.mNbUpdates[6]);
+    EXPECT_EQ(0U, system.mNbUpdates[5]);
+}
+
+// A test System counting the updates of each Entity
+class SystemTestSweep : public ecs::System {
+public:
+    explicit SystemTestSweep(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mNbUpdates(),
+        mElapsedTime(0.0f) {
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        ++mNbUpdates[aEntity];
+        mElapsedTime += aElapsedTime;
+    }
+
+    std::map<ecs::Entity, size_t>   mNbUpdates;     // Number of updates of each Entity
+    float                           mElapsedTime;   // Sum of the elapsed time given to updateEntity()
+};
+
+// Spreading the updates over multiple frames, with a budget per frame
+TEST(System, timeSlice) {
+    ecs::Manager manager;
+    SystemTestSweep system(manager);
+    for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+        EXPECT_TRUE(system.registerEntity(entity));
+    }
+    EXPECT_FALSE(system.isTimeSliced());
+    EXPECT_EQ(10U, system.updateEntities(0.1f));
+
+    // At most 3 Entities per frame: a sweep takes 4 frames, each Entity being updated exactly once
+    system.setTimeSlice(3);
+    EXPECT_TRUE(system.isTimeSliced());
+    EXPECT_EQ(10U, system.getNbPendingEntities());
+    EXPECT_EQ(0U, system.getNbFramesPerSweep());
+    system.mNbUpdates.clear();
+    system.mElapsedTime = 0.0f;
+    EXPECT_EQ(3U, system.updateEntities(0.1f));
+    EXPECT_EQ(3U, system.updateEntities(0.1f));
+    EXPECT_EQ(3U, system.updateEntities(0.1f));
+    EXPECT_EQ(1U, system.updateEntities(0.1f));
+    EXPECT_EQ(4U, system.getNbFramesPerSweep());
+    EXPECT_EQ(10U, system.getNbPendingEntities());
+    EXPECT_EQ(10U, system.mNbUpdates.size());
+    for (auto nbUpdates  = system.mNbUpdates.begin();
+              nbUpdates != system.mNbUpdates.end();
+            ++nbUpdates) {
+        EXPECT_EQ(1U, nbUpdates->second);
+    }
+    EXPECT_NEAR(3 * 0.1f + 3 * 0.2f + 3 * 0.3f + 0.4f, system.mElapsedTime, 0.001f);
+
+    // Each Entity is given the time elapsed since its own previous update
+    system.mElapsedTime = 0.0f;
+    for (size_t frame = 0; frame < 4; ++frame) {
+        system.updateEntities(0.1f);
+    }
+    EXPECT_NEAR(10 * 0.4f, system.mElapsedTime, 0.001f);
+
+    // Registering, unregistering and sleeping in the middle of a sweep
+    system.mNbUpdates.clear();
+    EXPECT_EQ(3U, system.updateEntities(0.1f));
+    const ecs::Entity updated = system.mNbUpdates.begin()->first;
+    ecs::Entity pending = 0;
+    for (ecs::Entity entity = 1; entity <= 10; ++entity) {
+        if (system.mNbUpdates.end() == system.mNbUpdates.find(entity)) {
+            pending = entity;
+        }
+    }
+    EXPECT_EQ(1U, system.unregisterEntity(updated));
+    EXPECT_EQ(1U, system.unregisterEntity(pending));
+    EXPECT_TRUE(system.registerEntity(11));
+    EXPECT_TRUE(system.registerEntity(12));
+    EXPECT_TRUE(system.sleepEntity(12));
+    EXPECT_EQ(7U, system.getNbPendingEntities());
+    size_t nbFrames = 1;
+    while (system.getNbPendingEntities() < 9) {
+        system.updateEntities(0.1f);
+        ASSERT_LT(++nbFrames, 10U);
+    }
+    EXPECT_EQ(4U, system.getNbFramesPerSweep());
+    EXPECT_EQ(10U, system.mNbUpdates.size()); // including the one unregistered after its update
+    for (auto nbUpdates  = system.mNbUpdates.begin();
+              nbUpdates != system.mNbUpdates.end();
+            ++nbUpdates) {
+        EXPECT_EQ(1U, nbUpdates->second);
+    }
+    EXPECT_TRUE(system.mNbUpdates.end() == system.mNbUpdates.find(pending));
+    EXPECT_TRUE(system.mNbUpdates.end() == system.mNbUpdates.find(12));
+
+    // With a time budget, at least one Entity is updated per frame
+    system.setTimeSlice(0, 1e-9f);
+    EXPECT_LE(1U, system.updateEntities(0.1f));
+    nbFrames = 1;
+    while (0 == system.getNbFramesPerSweep()) {
+        EXPECT_LE(1U, system.updateEntities(0.1f));
+        ASSERT_LT(++nbFrames, 10U);
+    }
+
+    // Without budget, all the active Entities are updated again
+    system.setTimeSlice(0, 0.0f);
+    EXPECT_FALSE(system.isTimeSliced());
+    EXPECT_EQ(9U, system.updateEntities(0.1f));
+}
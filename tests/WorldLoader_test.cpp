@@ -0,0 +1,106 @@
+/**
+ * @file    WorldLoader_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of the streaming of chunked world files.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/WorldLoader.h>
+#include <ecs/WorldWriter.h>
+#include <ecs/Manager.h>
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+// A trivially copyable Component
+struct ComponentLoaded : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    int mValue;
+};
+const ecs::ComponentType ComponentLoaded::_mType = 8;
+// Another one
+struct ComponentLoadedOther : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    double mValue;
+};
+const ecs::ComponentType ComponentLoadedOther::_mType = 9;
+
+// Commit decoded chunks until the region is loaded
+static size_t commitAll(ecs::WorldLoader& aLoader, ecs::Manager& aManager, ecs::WorldLoader::RegionId aRegionId) {
+    size_t nbEntities = 0;
+    for (int retry = 0; (retry < 5000) && !aLoader.isLoaded(aRegionId); ++retry) {
+        nbEntities += aLoader.commit(aManager, 0.001f);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nbEntities;
+}
+
+// Write a world file of 3 chunks, stream it into a Manager, then unload it
+TEST(WorldLoader, loadUnload) {
+    const char* path = "WorldLoader_test.bin";
+    ecs::WorldWriter writer;
+    for (int chunk = 0; chunk < 3; ++chunk) {
+        ComponentLoaded components[10];
+        ComponentLoadedOther others[10];
+        for (int i = 0; i < 10; ++i) {
+            components[i].mValue = (chunk * 10) + i;
+            others[i].mValue = 0.5;
+        }
+        writer.beginChunk(10);
+        writer.addColumn(components);
+        if (1 == chunk) {
+            writer.addColumn(others);
+        }
+    }
+    EXPECT_EQ(3U, writer.getNbChunks());
+    writer.write(path);
+
+    ecs::Manager manager;
+    manager.createComponentStore<ComponentLoaded>();
+    manager.createComponentStore<ComponentLoadedOther>();
+    ecs::WorldLoader loader(2);
+    loader.registerComponent<ComponentLoaded>();
+    loader.registerComponent<ComponentLoadedOther>();
+    const ecs::WorldLoader::RegionId regionId = loader.load(path);
+    EXPECT_THROW(loader.registerComponent<ComponentLoaded>(), std::runtime_error);
+
+    EXPECT_EQ(30U, commitAll(loader, manager, regionId));
+    EXPECT_TRUE(loader.isLoaded(regionId));
+    EXPECT_EQ(0U, loader.getNbPendingChunks());
+    EXPECT_EQ(30U, manager.getComponentStore<ComponentLoaded>().size());
+    EXPECT_EQ(10U, manager.getComponentStore<ComponentLoadedOther>().size());
+    EXPECT_EQ(30U, loader.getEntities(regionId).size());
+
+    EXPECT_EQ(30U, loader.unload(regionId, manager));
+    EXPECT_FALSE(loader.isLoaded(regionId));
+    EXPECT_EQ(0U, manager.getComponentStore<ComponentLoaded>().size());
+    std::remove(path);
+}
+
+// Errors are reported by commit()
+TEST(WorldLoader, missingFile) {
+    ecs::Manager manager;
+    ecs::WorldLoader loader;
+    const ecs::WorldLoader::RegionId regionId = loader.load("WorldLoader_missing.bin");
+    bool bThrown = false;
+    for (int retry = 0; (retry < 5000) && !bThrown; ++retry) {
+        try {
+            loader.commit(manager, 0.001f);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        } catch (const std::runtime_error&) {
+            bThrown = true;
+        }
+    }
+    EXPECT_TRUE(bThrown);
+    EXPECT_EQ(0U, loader.getNbPendingChunks());
+    EXPECT_EQ(0U, loader.unload(regionId, manager));
+}
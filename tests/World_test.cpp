@@ -0,0 +1,203 @@
+/**
+ * @file    World_test.cpp
+ * @ingroup ecs_test
+ * @brief   Test of a World of multiple Manager shards.
+ *
+ * Copyright (c) 2014 Sebastien Rombauts (sebastien.rombauts@gmail.com)
+ *
+ * Distributed under the MIT License (MIT) (See accompanying file LICENSE.txt
+ * or copy at http://opensource.org/licenses/MIT)
+ */
+
+#include <ecs/World.h>
+
+#include "../src/Utils.h" // defines the "override" identifier if needed (gcc < 4.7)
+
+#include <gtest/gtest.h>
+
+// A test Component, storing a 1d position
+struct ComponentPosition : public ecs::Component {
+    static const ecs::ComponentType _mType;
+
+    explicit ComponentPosition(float aX = 0.0f) : mX(aX) {
+    }
+
+    float mX;
+};
+const ecs::ComponentType ComponentPosition::_mType = 1;
+
+// Another test Component, only created in some shards
+struct ComponentLocal : public ecs::Component {
+    static const ecs::ComponentType _mType;
+};
+const ecs::ComponentType ComponentLocal::_mType = 2;
+
+// A test System, moving Entities to the right, and requesting their migration when crossing the border of a shard
+class SystemMoveRight : public ecs::System {
+public:
+    SystemMoveRight(ecs::World& aWorld, size_t aShard) :
+        ecs::System(aWorld.getShard(aShard)),
+        mWorld(aWorld),
+        mShard(aShard) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentPosition::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        ComponentPosition& position = mManager.getComponentStore<ComponentPosition>().get(aEntity);
+        position.mX += aElapsedTime;
+        // Each shard is one unit wide
+        const size_t shard = static_cast<size_t>(position.mX);
+        if ((shard != mShard) && (shard < mWorld.getNbShards())) {
+            mWorld.requestMigration(mShard, aEntity, shard);
+        }
+    }
+
+private:
+    ecs::World& mWorld;
+    size_t      mShard;
+};
+
+// A test System, throwing from the update of its first Entity only
+class SystemThrowOnce : public ecs::System {
+public:
+    explicit SystemThrowOnce(ecs::Manager& aManager) :
+        ecs::System(aManager),
+        mbThrown(false) {
+        ecs::ComponentTypeSet requiredComponents;
+        requiredComponents.insert(ComponentPosition::_mType);
+        setRequiredComponents(std::move(requiredComponents));
+    }
+
+    // Update function - for a given matching Entity - specialized.
+    virtual void updateEntity(float aElapsedTime, ecs::Entity aEntity) override {
+        (void)aElapsedTime;
+        (void)aEntity;
+        if (!mbThrown) {
+            mbThrown = true;
+            throw std::runtime_error("SystemThrowOnce");
+        }
+    }
+
+private:
+    bool mbThrown;
+};
+
+// Globally unique Entity Ids
+TEST(World, createEntity) {
+    EXPECT_THROW(ecs::World(0), std::runtime_error);
+    ecs::World world(3);
+    EXPECT_EQ(3U, world.getNbShards());
+    EXPECT_THROW(world.getShard(3), std::out_of_range);
+    for (size_t shard = 0; shard < world.getNbShards(); ++shard) {
+        EXPECT_EQ(shard, world.getShard(shard).getShardId());
+        const ecs::Entity entity = world.getShard(shard).createEntity();
+        EXPECT_EQ(ecs::getShardBaseEntity(static_cast<unsigned int>(shard)) + 1, entity);
+        EXPECT_EQ(shard, ecs::getEntityShard(entity));
+        EXPECT_EQ(shard, world.findShard(entity));
+    }
+}
+
+// Updating shards in parallel and migrating Entities between them
+TEST(World, updateAndMigrate) {
+    ecs::World world(2);
+    for (size_t shard = 0; shard < world.getNbShards(); ++shard) {
+        EXPECT_TRUE(world.getShard(shard).createComponentStore<ComponentPosition>());
+        world.getShard(shard).addSystem(ecs::System::Ptr(new SystemMoveRight(world, shard)));
+    }
+    ecs::Manager& shard0 = world.getShard(0);
+    ecs::Manager& shard1 = world.getShard(1);
+    ecs::Entity entity0 = shard0.createEntity();
+    EXPECT_TRUE(shard0.addComponent(entity0, ComponentPosition(0.5f)));
+    EXPECT_EQ(1U, shard0.registerEntity(entity0));
+    ecs::Entity entity1 = shard1.createEntity();
+    EXPECT_TRUE(shard1.addComponent(entity1, ComponentPosition(1.5f)));
+    EXPECT_EQ(1U, shard1.registerEntity(entity1));
+
+    // Both shards are updated, and entity0 crosses the border, migrating to shard1 at the sync point
+    EXPECT_EQ(2U, world.updateEntities(0.75f));
+    EXPECT_FALSE(shard0.hasEntity(entity0));
+    EXPECT_TRUE(shard1.hasEntity(entity0));
+    EXPECT_EQ(1U, world.findShard(entity0));
+    EXPECT_FALSE(shard0.getComponentStore<ComponentPosition>().has(entity0));
+    EXPECT_FLOAT_EQ(1.25f, shard1.getComponentStore<ComponentPosition>().get(entity0).mX);
+    EXPECT_FLOAT_EQ(2.25f, shard1.getComponentStore<ComponentPosition>().get(entity1).mX);
+
+    // Both Entities are now updated by shard1
+    EXPECT_EQ(2U, world.updateFrame(0.25f));
+    EXPECT_FLOAT_EQ(1.5f, shard1.getComponentStore<ComponentPosition>().get(entity0).mX);
+    EXPECT_FLOAT_EQ(2.5f, shard1.getComponentStore<ComponentPosition>().get(entity1).mX);
+
+    // Migrate back to the shard that created it
+    world.requestMigration(1, entity0, 0);
+    EXPECT_EQ(1U, world.migrateEntities());
+    EXPECT_TRUE(shard0.hasEntity(entity0));
+    EXPECT_EQ(0U, world.findShard(entity0));
+    EXPECT_THROW(world.requestMigration(1, entity1, 2), std::runtime_error);
+
+    // Destroying a migrated Entity forgets its location, and gives its index back to the shard that created it
+    EXPECT_THROW(shard0.releaseEntity(entity0), std::runtime_error);
+    world.requestMigration(0, entity0, 1);
+    EXPECT_EQ(1U, world.migrateEntities());
+    EXPECT_EQ(1U, world.findShard(entity0));
+    world.destroyEntity(entity0);
+    EXPECT_FALSE(shard1.hasEntity(entity0));
+    EXPECT_EQ(0U, world.findShard(entity0));
+    EXPECT_THROW(world.destroyEntity(entity0), std::runtime_error);
+    EXPECT_EQ(ecs::getNextGenerationEntity(entity0), shard0.createEntity());
+    world.destroyEntity(entity1);
+    EXPECT_FALSE(shard1.hasEntity(entity1));
+    EXPECT_THROW(shard0.releaseEntity(entity1), std::runtime_error);
+}
+
+// The worker threads of the shards are reused frame after frame, even after an exception
+TEST(World, exception) {
+    ecs::World world(3);
+    for (size_t shard = 0; shard < world.getNbShards(); ++shard) {
+        ecs::Manager& manager = world.getShard(shard);
+        EXPECT_TRUE(manager.createComponentStore<ComponentPosition>());
+        manager.addSystem(ecs::System::Ptr(new SystemThrowOnce(manager)));
+        ecs::Entity entity = manager.createEntity();
+        EXPECT_TRUE(manager.addComponent(entity, ComponentPosition(0.0f)));
+        EXPECT_EQ(1U, manager.registerEntity(entity));
+    }
+
+    // The exception of a shard is rethrown by the calling thread, once all shards are done
+    EXPECT_THROW(world.updateEntities(0.1f), std::runtime_error);
+    for (int frame = 0; frame < 100; ++frame) {
+        EXPECT_EQ(3U, world.updateFrame(0.1f));
+    }
+}
+
+// A failed migration is dropped, and requests for destroyed Entities are skipped
+TEST(World, migrationFailure) {
+    ecs::World world(2);
+    ecs::Manager& shard0 = world.getShard(0);
+    ecs::Manager& shard1 = world.getShard(1);
+    EXPECT_TRUE(shard0.createComponentStore<ComponentPosition>());
+    EXPECT_TRUE(shard0.createComponentStore<ComponentLocal>());
+    EXPECT_TRUE(shard1.createComponentStore<ComponentPosition>());
+    ecs::Entity destroyed = shard0.createEntity();
+    ecs::Entity local = shard0.createEntity();
+    EXPECT_TRUE(shard0.addComponent(local, ComponentLocal()));
+    ecs::Entity entity = shard0.createEntity();
+    EXPECT_TRUE(shard0.addComponent(entity, ComponentPosition(0.5f)));
+    world.requestMigration(0, destroyed, 1);
+    world.requestMigration(0, local, 1);
+    world.requestMigration(0, entity, 1);
+    shard0.destroyEntity(destroyed);
+
+    // The ComponentStore of local does not exist in shard1
+    EXPECT_THROW(world.migrateEntities(), std::runtime_error);
+    EXPECT_TRUE(shard0.hasEntity(local));
+    EXPECT_FALSE(shard1.hasEntity(destroyed));
+    EXPECT_TRUE(shard0.hasEntity(entity));
+
+    // Only the following request is applied by the next call
+    EXPECT_EQ(1U, world.migrateEntities());
+    EXPECT_TRUE(shard1.hasEntity(entity));
+    EXPECT_EQ(1U, world.findShard(entity));
+    EXPECT_EQ(0U, world.migrateEntities());
+}